@@ -6,20 +6,317 @@
 #include "../src/PortfolioMetrics.h"
 #include "../src/RiskMetrics.h"
 #include "../src/DataCache.h"
+#include "../src/UniverseCache.h"
 #include "../src/Statistics.h"
 #include "../src/BacktestEngine.h"
+#include "../src/CVaROptimizer.h"
+#include "../src/MonteCarloEngine.h"
+#include "../src/StressEngine.h"
+#include "../src/PortfolioCache.h"
+#include "../src/PortfolioQP.h"
+#include "../src/ThreadPool.h"
 #include "../src/data/MarketDataService.h"
+#include "../src/ingest/IngestService.h"
 
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
 #include <iostream>
+#include <numeric>
+#include <random>
 
 using json = nlohmann::json;
 
+// Universe for the optional "symbols", "start" and "end" request fields;
+// the whole dataset when none are given.
+static UniversePtr universeFor(const json& body) {
+    return UniverseCache::instance().get(
+        DataCache::instance().snapshot(),
+        body.value("symbols", std::vector<std::string>{}),
+        body.value("start", std::string()),
+        body.value("end", std::string()));
+}
+
+// Factor model for "risk_model": "factor" (optional "factors", default 10);
+// nullptr selects the dense sample covariance.
+static std::shared_ptr<const FactorModel>
+factorModelFor(const json& body, const UniversePtr& universe) {
+    std::string kind = body.value("risk_model", std::string("dense"));
+    if (kind == "dense") return nullptr;
+    if (kind != "factor")
+        throw std::invalid_argument("risk_model must be \"dense\" or \"factor\"");
+    int factors = body.value("factors", 10);
+    if (factors < 1)
+        throw std::invalid_argument("factors must be positive");
+    return universe->factorModel(static_cast<size_t>(factors));
+}
+
+// Memory and latency of the risk model used for a response
+static json riskModelInfo(const std::shared_ptr<const FactorModel>& model,
+                          size_t assets,
+                          std::chrono::steady_clock::time_point started) {
+    double ms = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - started).count();
+    size_t denseBytes = assets * assets * sizeof(double);
+
+    json info;
+    info["type"] = model ? "factor" : "dense";
+    if (model) info["factors"] = model->factors();
+    info["bytes"] = model ? model->bytes() : denseBytes;
+    info["dense_bytes"] = denseBytes;
+    info["elapsed_ms"] = ms;
+    return info;
+}
+
+// Analytic frontier state for the request's risk model
+static std::shared_ptr<const FrontierState>
+frontierFor(const std::shared_ptr<const FactorModel>& model, const UniversePtr& universe) {
+    if (model) return std::make_shared<FrontierState>(universe->mean(), *model);
+    return universe->frontier();
+}
+
+// Constraints from an optional "constraints" object:
+//   long_only, max_weight, lower / upper (per asset, in universe order),
+//   groups: [{name, symbols, min, max}], previous_weights, max_turnover.
+// Returns false when the request has none, keeping the closed-form paths.
+static bool constraintsFor(const json& body, const UniversePtr& universe,
+                           PortfolioConstraints& out) {
+    if (!body.contains("constraints")) return false;
+    const json& c = body["constraints"];
+
+    out.longOnly = c.value("long_only", true);
+    out.maxWeight = c.value("max_weight", 1.0);
+    out.lower = c.value("lower", std::vector<double>{});
+    out.upper = c.value("upper", std::vector<double>{});
+    out.previous = c.value("previous_weights", std::vector<double>{});
+    out.maxTurnover = c.value("max_turnover", -1.0);
+
+    const auto& symbols = universe->symbols();
+    for (const json& g : c.value("groups", json::array())) {
+        AssetGroup group;
+        group.name = g.value("name", std::string("group"));
+        group.minWeight = g.value("min", 0.0);
+        group.maxWeight = g.value("max", 1.0);
+        for (const auto& sym : g.value("symbols", std::vector<std::string>{})) {
+            auto it = std::find(symbols.begin(), symbols.end(), sym);
+            if (it == symbols.end())
+                throw std::invalid_argument("group " + group.name + ": unknown symbol " + sym);
+            group.members.push_back(static_cast<size_t>(it - symbols.begin()));
+        }
+        out.groups.push_back(std::move(group));
+    }
+    return true;
+}
+
+// "budgets": array in universe order, or {symbol: budget} with unnamed
+// assets at 1; equal risk contributions when absent
+static std::vector<double> budgetsFor(const json& body, const UniversePtr& universe) {
+    const auto& symbols = universe->symbols();
+    std::vector<double> budgets(symbols.size(), 1.0);
+    if (!body.contains("budgets")) return budgets;
+
+    const json& b = body["budgets"];
+    if (b.is_array()) {
+        budgets = b.get<std::vector<double>>();
+    } else if (b.is_object()) {
+        for (const auto& [sym, value] : b.items()) {
+            auto it = std::find(symbols.begin(), symbols.end(), sym);
+            if (it == symbols.end())
+                throw std::invalid_argument("unknown symbol in budgets: " + sym);
+            budgets[it - symbols.begin()] = value.get<double>();
+        }
+    } else {
+        throw std::invalid_argument("budgets must be an array or an object");
+    }
+    return budgets;
+}
+
+// One /api/batch item:
+//   {"type": "tangency" | "target_return" | "min_variance" | "risk_parity",
+//    "risk_free_rate", "target_return", "max_weight", "budgets", "constraints"}
+static BatchProblem batchProblemFor(const json& item, const UniversePtr& universe) {
+    BatchProblem p;
+    std::string type = item.value("type", std::string("tangency"));
+    if (type == "tangency") p.kind = BatchProblem::Kind::Tangency;
+    else if (type == "target_return") p.kind = BatchProblem::Kind::TargetReturn;
+    else if (type == "min_variance") p.kind = BatchProblem::Kind::MinVariance;
+    else if (type == "risk_parity") p.kind = BatchProblem::Kind::RiskParity;
+    else throw std::invalid_argument("unknown problem type: " + type);
+
+    p.rf = item.value("risk_free_rate", 0.0);
+    if (p.kind == BatchProblem::Kind::TargetReturn) {
+        if (!item.contains("target_return"))
+            throw std::invalid_argument("target_return problem needs \"target_return\"");
+        p.targetReturn = item["target_return"].get<double>();
+    }
+    if (p.kind == BatchProblem::Kind::RiskParity) p.budgets = budgetsFor(item, universe);
+    p.constrained = constraintsFor(item, universe, p.constraints);
+
+    // A top-level cap is the min-variance bound; tangency and target-return
+    // items take it as constraints.max_weight and solve through PortfolioQP
+    if (item.contains("max_weight")) {
+        double cap = item["max_weight"].get<double>();
+        switch (p.kind) {
+        case BatchProblem::Kind::MinVariance:
+            p.maxWeight = cap;
+            break;
+        case BatchProblem::Kind::Tangency:
+        case BatchProblem::Kind::TargetReturn:
+            if (p.constrained && item["constraints"].contains("max_weight"))
+                throw std::invalid_argument("max_weight given both at top level and in constraints");
+            p.constraints.maxWeight = cap;
+            p.constrained = true;
+            break;
+        case BatchProblem::Kind::RiskParity:
+            throw std::invalid_argument("risk_parity problem does not take \"max_weight\"");
+        }
+    }
+    return p;
+}
+
+// Warm-start key: same assets, objective and constraints
+static std::string warmKey(const std::string& objective, const json& body,
+                           const UniversePtr& universe) {
+    std::string key = objective;
+    for (const auto& s : universe->symbols()) key += "|" + s;
+    return key + "|" + body["constraints"].dump();
+}
+
+static json solverInfo(const QPResult& qp, std::chrono::steady_clock::time_point started) {
+    json info;
+    info["type"] = "admm";
+    info["iterations"] = qp.iterations;
+    info["converged"] = qp.converged;
+    info["polished"] = qp.polished;
+    info["warm_started"] = qp.warmStarted;
+    info["primal_residual"] = qp.primalResidual;
+    info["dual_residual"] = qp.dualResidual;
+    info["solve_ms"] = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - started).count();
+    return info;
+}
+
+// Asset set and date range of a request, for cache keys
+static std::string universeKey(const json& body, const UniversePtr& universe) {
+    std::string key = body.value("start", std::string()) + "|" + body.value("end", std::string());
+    for (const auto& s : universe->symbols()) key += "|" + s;
+    return key;
+}
+
+// Max-Sharpe portfolio for the request through PortfolioCache. On a miss
+// it is solved (constrained QP when "constraints" is present) and, for
+// QP solves, *solver receives the solver report; on a hit *solver is
+// left untouched.
+static PortfolioPtr tangencyFor(const json& body, const UniversePtr& universe,
+                                const std::shared_ptr<const FactorModel>& model,
+                                double rf, json* solver) {
+    PortfolioKey key;
+    key.version = universe->version();
+    key.universe = universeKey(body, universe);
+    key.objective = model ? "tangency/factor-" + std::to_string(model->factors()) : "tangency";
+    key.rf = rf;
+    key.constraints = body.contains("constraints") ? body["constraints"].dump() : "";
+
+    return PortfolioCache::instance().getOrCompute(key, [&] {
+        auto started = std::chrono::steady_clock::now();
+        const auto& mu = universe->mean();
+        const auto& cov = universe->cov();
+
+        CachedPortfolio out;
+        out.symbols = universe->symbols();
+
+        PortfolioConstraints constraints;
+        if (constraintsFor(body, universe, constraints)) {
+            std::string wk = warmKey(key.objective, body, universe);
+            auto warm = QPWarmStarts::instance().get(wk);
+            auto solved = model
+                ? PortfolioQP::maxSharpe(mu, *model, rf, constraints, {}, warm.get())
+                : PortfolioQP::maxSharpe(mu, cov, rf, constraints, {}, warm.get());
+            if (solver) *solver = solverInfo(solved.qp, started);
+            if (solved.qp.converged) QPWarmStarts::instance().put(wk, solved.qp);
+            out.weights = std::move(solved.weights);
+            out.expectedReturn = solved.expectedReturn;
+            out.risk = solved.risk;
+        } else {
+            Optimizer opt;
+            auto tp = model ? opt.computeTangencyPortfolio(mu, *model, rf)
+                            : opt.computeTangencyPortfolio(mu, cov, *universe->frontier(), rf);
+            if (solver) *solver = json{{"type", "closed_form"}};
+            out.weights = std::move(tp.weights);
+            out.expectedReturn = tp.expectedReturn;
+            out.risk = tp.risk;
+        }
+        return out;
+    });
+}
+
+// Portfolio the risk endpoints evaluate, first match wins:
+//   "weights": array in universe order or {symbol: weight}, used as given;
+//   "portfolio_id": a result cached by an earlier request;
+//   otherwise the cached max-Sharpe portfolio at "risk_free_rate"
+//   (default 0.001), honouring "constraints" and "risk_model".
+static PortfolioPtr portfolioFor(const json& body, const UniversePtr& universe) {
+    const auto& symbols = universe->symbols();
+
+    if (body.contains("weights")) {
+        const json& w = body["weights"];
+        auto p = std::make_shared<CachedPortfolio>();
+        p->version = universe->version();
+        p->objective = "explicit";
+        p->symbols = symbols;
+        p->weights.assign(symbols.size(), 0.0);
+        if (w.is_array()) {
+            p->weights = w.get<std::vector<double>>();
+            if (p->weights.size() != symbols.size())
+                throw std::invalid_argument("weights need one value per asset");
+        } else if (w.is_object()) {
+            for (const auto& [sym, value] : w.items()) {
+                auto it = std::find(symbols.begin(), symbols.end(), sym);
+                if (it == symbols.end())
+                    throw std::invalid_argument("unknown symbol in weights: " + sym);
+                p->weights[it - symbols.begin()] = value.get<double>();
+            }
+        } else {
+            throw std::invalid_argument("weights must be an array or an object");
+        }
+        p->expectedReturn = PortfolioMetrics::portfolioReturn(p->weights, universe->mean());
+        p->risk = PortfolioMetrics::portfolioRisk(
+            PortfolioMetrics::portfolioVariance(p->weights, universe->cov()));
+        return p;
+    }
+
+    if (body.contains("portfolio_id")) {
+        std::string id = body["portfolio_id"].get<std::string>();
+        PortfolioPtr p = PortfolioCache::instance().find(id, universe->version());
+        if (!p)
+            throw std::invalid_argument("unknown or expired portfolio_id " + id);
+        if (p->symbols != symbols)
+            throw std::invalid_argument("portfolio_id " + id + " was built for other symbols");
+        return p;
+    }
+
+    return tangencyFor(body, universe, factorModelFor(body, universe),
+                       body.value("risk_free_rate", 0.001), nullptr);
+}
+
+// Response key of a percentile level: 0.05 -> "p5", 0.025 -> "p2.5"
+static std::string percentileKey(double level) {
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "p%g", level * 100.0);
+    return buf;
+}
+
+static json parseBody(const httplib::Request& req) {
+    return req.body.empty() ? json::object() : json::parse(req.body);
+}
+
 void Server::start(int port) {
 
     // ===============================
     // Load data ONCE (IMPORTANT)
     // ===============================
     DataCache::instance().loadIfNeeded();
+    DataCache::instance().startWatching(std::chrono::seconds(2));
 
     httplib::Server svr;
 
@@ -48,32 +345,171 @@ void Server::start(int port) {
         res.set_content(j.dump(), "application/json");
     });
 
+    // ===============================
+    // POST /api/admin/reload
+    // ===============================
+    svr.Post("/api/admin/reload", [&](const httplib::Request&, httplib::Response& res) {
+        uint64_t version = DataCache::instance().reload();
+        SnapshotPtr data = DataCache::instance().snapshot();
+
+        json response;
+        response["version"] = version;
+        response["assets"] = data->symbols();
+        response["observations"] = data->returns().rows();
+
+        res.set_content(response.dump(), "application/json");
+        res.status = 200;
+    });
+
+    // ===============================
+    // GET /api/cache/stats
+    // ===============================
+    svr.Get("/api/cache/stats", [&](const httplib::Request&, httplib::Response& res) {
+        UniverseCacheStats st = UniverseCache::instance().stats();
+
+        json response;
+        response["universe"] = {
+            {"hits", st.hits},
+            {"misses", st.misses},
+            {"evictions", st.evictions},
+            {"entries", st.entries},
+            {"resident_bytes", st.residentBytes},
+            {"budget_bytes", st.budgetBytes}
+        };
+
+        PortfolioCacheStats pc = PortfolioCache::instance().stats();
+        response["portfolio"] = {
+            {"hits", pc.hits},
+            {"misses", pc.misses},
+            {"evictions", pc.evictions},
+            {"entries", pc.entries},
+            {"capacity", pc.capacity}
+        };
+
+        res.set_content(response.dump(), "application/json");
+        res.status = 200;
+    });
+
+    // ===============================
+    // POST /api/ingest/start
+    // ===============================
+    svr.Post("/api/ingest/start", [&](const httplib::Request& req, httplib::Response& res) {
+
+        try {
+            json body = parseBody(req);
+
+            IngestOptions options;
+            options.barMs = static_cast<int64_t>(body.value("bar_seconds", 86400.0) * 1000.0);
+
+            if (body.contains("replay")) {
+                const json& r = body["replay"];
+                ReplayOptions replay;
+                replay.ticks = r.value("ticks", replay.ticks);
+                replay.ticksPerBar = r.value("ticks_per_bar", replay.ticksPerBar);
+                replay.ticksPerSecond = r.value("rate", replay.ticksPerSecond);
+                replay.seed = r.value("seed", replay.seed);
+                IngestService::instance().startReplay(replay, options);
+            } else {
+                if (!body.contains("source"))
+                    throw std::invalid_argument("expected \"source\" or \"replay\"");
+                IngestService::instance().startFile(body["source"].get<std::string>(),
+                                                    body.value("from_start", true),
+                                                    options);
+            }
+
+            res.set_content(json{{"running", true}}.dump(), "application/json");
+            res.status = 200;
+        }
+        catch (const std::exception& e) {
+            res.status = 400;
+            res.set_content(json{{"error", e.what()}}.dump(), "application/json");
+        }
+    });
+
+    // ===============================
+    // POST /api/ingest/stop
+    // ===============================
+    svr.Post("/api/ingest/stop", [&](const httplib::Request&, httplib::Response& res) {
+        IngestService::instance().stop();
+        res.set_content(json{{"running", false}}.dump(), "application/json");
+        res.status = 200;
+    });
+
+    // ===============================
+    // GET /api/ingest/stats
+    // ===============================
+    svr.Get("/api/ingest/stats", [&](const httplib::Request&, httplib::Response& res) {
+        IngestStats st = IngestService::instance().stats();
+
+        json response;
+        response["running"] = st.running;
+        response["source"] = st.source;
+        response["ticks"] = {
+            {"received", st.received},
+            {"consumed", st.consumed},
+            {"rejected", st.rejected},
+            {"late", st.late},
+            {"per_second", st.ticksPerSecond},
+            {"recent_per_second", st.recentTicksPerSecond}
+        };
+        response["queue"] = {
+            {"depth", st.queueDepth},
+            {"capacity", st.queueCapacity},
+            {"producer_stalls", st.stalls}
+        };
+        response["latency_us"] = {
+            {"mean", st.latencyMeanUs},
+            {"p50", st.latencyP50Us},
+            {"p99", st.latencyP99Us},
+            {"max", st.latencyMaxUs}
+        };
+        response["bars"] = {
+            {"appended", st.bars},
+            {"stale", st.staleBars},
+            {"open_bar_ticks", st.openBarTicks},
+            {"last", st.lastBar}
+        };
+        response["data_version"] = DataCache::instance().version();
+        if (!st.lastError.empty()) response["last_error"] = st.lastError;
+
+        res.set_content(response.dump(), "application/json");
+        res.status = 200;
+    });
+
     // ===============================
     // POST /api/tangency
     // ===============================
     svr.Post("/api/tangency", [&](const httplib::Request& req, httplib::Response& res) {
 
         try {
-            json body = json::parse(req.body);
+            json body = parseBody(req);
             double rf = body.value("risk_free_rate", 0.0);
 
-            auto &mu  = DataCache::instance().mean();
-            auto &cov = DataCache::instance().cov();
+            UniversePtr universe = universeFor(body);
+            auto &mu  = universe->mean();
 
-            Optimizer opt;
-            auto tp = opt.computeTangencyPortfolio(mu, cov, rf);
+            auto started = std::chrono::steady_clock::now();
+            auto model = factorModelFor(body, universe);
 
             json response;
-            response["expected_return"] = tp.expectedReturn;
-            response["risk"] = tp.risk;
+            json solver;
+            PortfolioPtr tp = tangencyFor(body, universe, model, rf, &solver);
+            response["portfolio_id"] = tp->id;
+            response["cached"] = solver.is_null();
+            if (!solver.is_null()) response["solver"] = std::move(solver);
+
+            response["risk_model"] = riskModelInfo(model, mu.size(), started);
+            response["expected_return"] = tp->expectedReturn;
+            response["risk"] = tp->risk;
             response["sharpe_ratio"] =
-                PortfolioMetrics::sharpeRatio(tp.expectedReturn, tp.risk, rf);
+                PortfolioMetrics::sharpeRatio(tp->expectedReturn, tp->risk, rf);
 
             response["weights"] = json::array();
-            for (size_t i = 0; i < tp.weights.size(); i++) {
+            for (size_t i = 0; i < tp->weights.size(); i++) {
                 response["weights"].push_back({
                     {"asset", static_cast<int>(i)},
-                    {"weight", tp.weights[i]}
+                    {"symbol", universe->symbols()[i]},
+                    {"weight", tp->weights[i]}
                 });
             }
 
@@ -92,16 +528,45 @@ void Server::start(int port) {
     svr.Post("/api/efficientFrontier", [&](const httplib::Request& req, httplib::Response& res) {
 
         try {
-            json body = json::parse(req.body);
+            json body = parseBody(req);
             int points = body.value("points", 30);
 
-            auto &mu  = DataCache::instance().mean();
-            auto &cov = DataCache::instance().cov();
+            UniversePtr universe = universeFor(body);
+            auto &mu  = universe->mean();
 
-            Optimizer opt;
-            auto frontier = opt.computeEfficientFrontier(mu, cov, points);
+            auto started = std::chrono::steady_clock::now();
+            auto model = factorModelFor(body, universe);
 
             json response;
+            std::vector<std::pair<double, double>> frontier;
+            PortfolioConstraints constraints;
+            if (constraintsFor(body, universe, constraints)) {
+                if (points < 2 || points > 500)
+                    throw std::invalid_argument("points must be between 2 and 500");
+                auto solved = model
+                    ? PortfolioQP::frontier(mu, *model, points, constraints)
+                    : PortfolioQP::frontier(mu, universe->cov(), points, constraints);
+
+                int iterations = 0;
+                for (const auto& p : solved) {
+                    frontier.push_back({ p.risk, p.expectedReturn });
+                    iterations += p.qp.iterations;
+                }
+                response["solver"] = {
+                    {"type", "admm"},
+                    {"points_requested", points},
+                    {"points_solved", solved.size()},
+                    {"iterations", iterations},
+                    {"solve_ms", std::chrono::duration<double, std::milli>(
+                        std::chrono::steady_clock::now() - started).count()}
+                };
+            } else {
+                Optimizer opt;
+                frontier = model ? opt.computeEfficientFrontier(mu, *model, points)
+                                 : opt.computeEfficientFrontier(*universe->frontier(), points);
+            }
+
+            response["risk_model"] = riskModelInfo(model, mu.size(), started);
             response["efficient_frontier"] = json::array();
 
             for (const auto &pt : frontier) {
@@ -123,26 +588,368 @@ void Server::start(int port) {
     });
 
     // ===============================
-    // POST /api/risk-parity
+    // POST /api/frontier/dense
     // ===============================
-    svr.Post("/api/risk-parity", [&](const httplib::Request&, httplib::Response& res) {
+    svr.Post("/api/frontier/dense", [&](const httplib::Request& req, httplib::Response& res) {
 
         try {
-            auto &mu  = DataCache::instance().mean();
-            auto &cov = DataCache::instance().cov();
+            json body = parseBody(req);
+            UniversePtr universe = universeFor(body);
 
-            Optimizer opt;
-            auto rp = opt.computeRiskParityPortfolio(mu, cov);
+            auto started = std::chrono::steady_clock::now();
+            auto model = factorModelFor(body, universe);
+            auto state = frontierFor(model, universe);
+
+            size_t points = body.value("points", 10000);
+            if (points < 2 || points > 1000000)
+                throw std::invalid_argument("points must be between 2 and 1000000");
+            double rmin = body.value("min_return", state->minimumVariance().expectedReturn);
+            double rmax = body.value("max_return", state->maxReturn());
+
+            auto frontier = state->frontier(rmin, rmax, points);
+
+            std::vector<double> risk(points), ret(points);
+            for (size_t i = 0; i < points; i++) {
+                risk[i] = frontier[i].risk;
+                ret[i] = frontier[i].expectedReturn;
+            }
+
+            CMLPoint gmv = state->minimumVariance();
+            json response;
+            response["risk_model"] = riskModelInfo(model, state->assets(), started);
+            response["minimum_variance"] = { {"risk", gmv.risk}, {"return", gmv.expectedReturn} };
+            response["risk"] = std::move(risk);
+            response["return"] = std::move(ret);
+
+            res.set_content(response.dump(), "application/json");
+            res.status = 200;
+        }
+        catch (const std::exception& e) {
+            res.status = 400;
+            res.set_content(json{{"error", e.what()}}.dump(), "application/json");
+        }
+    });
+
+    // ===============================
+    // POST /api/frontier/rf-sweep
+    // ===============================
+    svr.Post("/api/frontier/rf-sweep", [&](const httplib::Request& req, httplib::Response& res) {
+
+        try {
+            json body = parseBody(req);
+            UniversePtr universe = universeFor(body);
+
+            auto started = std::chrono::steady_clock::now();
+            auto model = factorModelFor(body, universe);
+            auto state = frontierFor(model, universe);
+
+            size_t steps = body.value("steps", 100);
+            bool withWeights = body.value("include_weights", false);
+            if (steps < 1 || steps > (withWeights ? 1000u : 1000000u))
+                throw std::invalid_argument("steps out of range");
+
+            // Default sweep: 0 up to just below the GMV return, where the
+            // tangency leaves the efficient branch
+            double rfMin = body.value("rf_min", 0.0);
+            double rfMax = body.value("rf_max", 0.99 * state->minimumVariance().expectedReturn);
+
+            json rfs = json::array(), rets = json::array(), risks = json::array();
+            json sharpes = json::array(), efficient = json::array(), weights = json::array();
+
+            for (size_t i = 0; i < steps; i++) {
+                double rf = steps > 1 ? rfMin + (rfMax - rfMin) * i / (steps - 1) : rfMin;
+                CMLPoint p = state->tangencyPoint(rf);
+                rfs.push_back(rf);
+                rets.push_back(p.expectedReturn);
+                risks.push_back(p.risk);
+                sharpes.push_back(state->maxSharpe(rf));
+                efficient.push_back(state->efficient(rf));
+                if (withWeights) weights.push_back(state->tangencyWeights(rf));
+            }
+
+            json response;
+            response["risk_model"] = riskModelInfo(model, state->assets(), started);
+            response["rf"] = std::move(rfs);
+            response["return"] = std::move(rets);
+            response["risk"] = std::move(risks);
+            response["sharpe"] = std::move(sharpes);
+            response["efficient"] = std::move(efficient);
+            if (withWeights) {
+                response["symbols"] = universe->symbols();
+                response["weights"] = std::move(weights);
+            }
+
+            res.set_content(response.dump(), "application/json");
+            res.status = 200;
+        }
+        catch (const std::exception& e) {
+            res.status = 400;
+            res.set_content(json{{"error", e.what()}}.dump(), "application/json");
+        }
+    });
+
+    // ===============================
+    // POST /api/min-variance
+    // ===============================
+    svr.Post("/api/min-variance", [&](const httplib::Request& req, httplib::Response& res) {
+
+        try {
+            json body = parseBody(req);
+            double maxWeight = body.value("max_weight", 0.3);
+            int maxIter = body.value("max_iter", 5000);
+            double tol = body.value("tol", 1e-9);
+            if (maxIter < 1 || !(tol > 0.0))
+                throw std::invalid_argument("max_iter and tol must be positive");
+
+            UniversePtr universe = universeFor(body);
+            auto &mu  = universe->mean();
+            auto &cov = universe->cov();
+
+            auto started = std::chrono::steady_clock::now();
+            auto mv = Optimizer::minimizeVariance(cov, maxWeight, maxIter, tol);
+            double ms = std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - started).count();
+
+            json response;
+            response["expected_return"] = PortfolioMetrics::portfolioReturn(mv.weights, mu);
+            response["risk"] = mv.risk;
+            response["solver"] = {
+                {"type", "fista"},
+                {"iterations", mv.iterations},
+                {"duality_gap", mv.dualityGap},
+                {"converged", mv.converged},
+                {"solve_ms", ms}
+            };
+
+            response["weights"] = json::array();
+            for (size_t i = 0; i < mv.weights.size(); i++) {
+                response["weights"].push_back({
+                    {"asset", static_cast<int>(i)},
+                    {"symbol", universe->symbols()[i]},
+                    {"weight", mv.weights[i]}
+                });
+            }
+
+            res.set_content(response.dump(), "application/json");
+            res.status = 200;
+        }
+        catch (const std::exception& e) {
+            res.status = 400;
+            res.set_content(json{{"error", e.what()}}.dump(), "application/json");
+        }
+    });
+
+    // ===============================
+    // POST /api/cvar
+    // ===============================
+    svr.Post("/api/cvar", [&](const httplib::Request& req, httplib::Response& res) {
+
+        try {
+            json body = parseBody(req);
+            CVaRSettings settings;
+            settings.alpha = body.value("alpha", settings.alpha);
+            settings.maxWeight = body.value("max_weight", settings.maxWeight);
+            settings.maxIter = body.value("max_iter", settings.maxIter);
+            settings.tol = body.value("tol", settings.tol);
+            if (settings.maxIter < 1 || !(settings.tol > 0.0))
+                throw std::invalid_argument("max_iter and tol must be positive");
+            std::string source = body.value("source", std::string("historical"));
+
+            UniversePtr universe = universeFor(body);
+            size_t N = universe->symbols().size();
+
+            // Scenario rows: the universe's return history, or draws from
+            // N(mean, cov) through its Cholesky factor
+            auto started = std::chrono::steady_clock::now();
+            Matrix owned;
+            MatrixView scenarios;
+            if (source == "historical") {
+                scenarios = universe->returns();
+                if (scenarios.cols() != N) {
+                    owned = universe->subsetReturns();
+                    scenarios = owned.view();
+                }
+            } else if (source == "simulated") {
+                int count = body.value("num_scenarios", 10000);
+                if (count < 1 || static_cast<double>(count) * N > 2e7)
+                    throw std::invalid_argument("num_scenarios must be positive and at most 2e7 / assets");
+                owned = CVaROptimizer::simulateScenarios(
+                    universe->mean(), *universe->cholesky(),
+                    static_cast<size_t>(count), body.value("seed", uint64_t{42}),
+                    ThreadPool::shared());
+                scenarios = owned.view();
+            } else {
+                throw std::invalid_argument("source must be \"historical\" or \"simulated\"");
+            }
+            double scenarioMs = std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - started).count();
+
+            started = std::chrono::steady_clock::now();
+            auto cv = CVaROptimizer::minimize(scenarios, settings, ThreadPool::shared());
+            double ms = std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - started).count();
+
+            json response;
+            response["alpha"] = settings.alpha;
+            response["cvar"] = cv.cvar;
+            response["var"] = cv.var;
+            response["expected_return"] = cv.expectedReturn;
+            response["risk"] = PortfolioMetrics::portfolioRisk(
+                PortfolioMetrics::portfolioVariance(cv.weights, universe->cov()));
+            response["scenarios"] = {
+                {"source", source},
+                {"count", scenarios.rows()},
+                {"build_ms", scenarioMs}
+            };
+            response["solver"] = {
+                {"type", "smoothed-fista"},
+                {"iterations", cv.iterations},
+                {"rounds", cv.rounds},
+                {"working_set", cv.workingSet},
+                {"converged", cv.converged},
+                {"solve_ms", ms}
+            };
+
+            response["weights"] = json::array();
+            for (size_t i = 0; i < cv.weights.size(); i++) {
+                response["weights"].push_back({
+                    {"asset", static_cast<int>(i)},
+                    {"symbol", universe->symbols()[i]},
+                    {"weight", cv.weights[i]}
+                });
+            }
+
+            res.set_content(response.dump(), "application/json");
+            res.status = 200;
+        }
+        catch (const std::exception& e) {
+            res.status = 400;
+            res.set_content(json{{"error", e.what()}}.dump(), "application/json");
+        }
+    });
+
+    // ===============================
+    // POST /api/batch
+    // ===============================
+    svr.Post("/api/batch", [&](const httplib::Request& req, httplib::Response& res) {
+
+        try {
+            json body = parseBody(req);
+            if (!body.contains("problems") || !body["problems"].is_array())
+                throw std::invalid_argument("expected a \"problems\" array");
+            const json& items = body["problems"];
+            if (items.size() > 10000)
+                throw std::invalid_argument("at most 10000 problems per batch");
+            bool includeWeights = body.value("include_weights", true);
+
+            UniversePtr universe = universeFor(body);
+            auto &mu  = universe->mean();
+
+            // Malformed items fail on their own; the rest still run
+            std::vector<BatchProblem> problems;
+            std::vector<size_t> slot;
+            std::vector<std::string> parseErrors(items.size());
+            for (size_t i = 0; i < items.size(); i++) {
+                try {
+                    problems.push_back(batchProblemFor(items[i], universe));
+                    slot.push_back(i);
+                }
+                catch (const std::exception& e) {
+                    parseErrors[i] = e.what();
+                }
+            }
+
+            auto started = std::chrono::steady_clock::now();
+            ThreadPool& pool = ThreadPool::shared();
+            auto solved = Optimizer::solveBatch(mu, universe->cov(), *universe->frontier(),
+                                                problems, pool);
+            double ms = std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - started).count();
+
+            std::vector<json> results(items.size());
+            for (size_t i = 0; i < items.size(); i++)
+                if (!parseErrors[i].empty())
+                    results[i] = {{"index", i}, {"ok", false}, {"error", parseErrors[i]}};
+
+            for (size_t k = 0; k < solved.size(); k++) {
+                const BatchResult& r = solved[k];
+                json out;
+                out["index"] = slot[k];
+                out["ok"] = r.ok();
+                out["elapsed_ms"] = r.elapsedMs;
+                if (!r.ok()) {
+                    out["error"] = r.error;
+                } else {
+                    double rf = items[slot[k]].value("risk_free_rate", 0.0);
+                    out["expected_return"] = r.expectedReturn;
+                    out["risk"] = r.risk;
+                    out["sharpe_ratio"] =
+                        PortfolioMetrics::sharpeRatio(r.expectedReturn, r.risk, rf);
+                    out["iterations"] = r.iterations;
+                    out["converged"] = r.converged;
+                    if (includeWeights) out["weights"] = r.weights;
+                }
+                results[slot[k]] = std::move(out);
+            }
+
+            json response;
+            response["symbols"] = universe->symbols();
+            response["results"] = std::move(results);
+            response["problems"] = items.size();
+            response["threads"] = pool.concurrency();
+            response["total_ms"] = ms;
+            response["problems_per_second"] = ms > 0.0 ? solved.size() * 1000.0 / ms : 0.0;
+
+            res.set_content(response.dump(), "application/json");
+            res.status = 200;
+        }
+        catch (const std::exception& e) {
+            res.status = 400;
+            res.set_content(json{{"error", e.what()}}.dump(), "application/json");
+        }
+    });
+
+    // ===============================
+    // POST /api/risk-parity
+    // ===============================
+    svr.Post("/api/risk-parity", [&](const httplib::Request& req, httplib::Response& res) {
+
+        try {
+            json body = parseBody(req);
+            UniversePtr universe = universeFor(body);
+            auto &mu  = universe->mean();
+            auto &cov = universe->cov();
+            const auto& symbols = universe->symbols();
+            std::vector<double> budgets = budgetsFor(body, universe);
+
+            auto started = std::chrono::steady_clock::now();
+            auto rp = Optimizer::computeRiskBudgetPortfolio(
+                mu, cov, budgets,
+                body.value("max_sweeps", 500),
+                body.value("tol", 1e-8));
+            double ms = std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - started).count();
 
             json response;
             response["expected_return"] = rp.expectedReturn;
             response["risk"] = rp.risk;
+            response["solver"] = {
+                {"type", "coordinate_descent"},
+                {"sweeps", rp.sweeps},
+                {"max_deviation", rp.maxDeviation},
+                {"converged", rp.converged},
+                {"solve_ms", ms}
+            };
 
+            double totalBudget = std::accumulate(budgets.begin(), budgets.end(), 0.0);
             response["weights"] = json::array();
             for (size_t i = 0; i < rp.weights.size(); i++) {
                 response["weights"].push_back({
                     {"asset", static_cast<int>(i)},
-                    {"weight", rp.weights[i]}
+                    {"symbol", symbols[i]},
+                    {"weight", rp.weights[i]},
+                    {"risk_contribution", rp.riskContributions[i]},
+                    {"budget", budgets[i] / totalBudget}
                 });
             }
 
@@ -161,28 +968,84 @@ void Server::start(int port) {
     svr.Post("/api/var", [&](const httplib::Request& req, httplib::Response& res) {
 
         try {
-            json body = json::parse(req.body);
+            json body = parseBody(req);
             double confidence = body.value("confidence", 0.95);
 
-            auto &returns = DataCache::instance().returns();
-            auto &mu      = DataCache::instance().mean();
-            auto &cov     = DataCache::instance().cov();
+            UniversePtr universe = universeFor(body);
+            MatrixView returns = universe->returns();
 
-            Optimizer opt;
-            auto tp = opt.computeTangencyPortfolio(mu, cov, 0.001);
+            PortfolioPtr tp = portfolioFor(body, universe);
 
             auto portReturns =
                 PortfolioMetrics::portfolioReturnSeries(
                     returns,
-                    tp.weights
+                    universe->expandWeights(tp->weights)
                 );
 
             double var =
                 RiskMetrics::historicalVaR(portReturns, confidence);
+            double es =
+                RiskMetrics::historicalES(portReturns, confidence);
 
             json response;
+            if (!tp->id.empty()) response["portfolio_id"] = tp->id;
             response["confidence"] = confidence;
             response["historical_var"] = var;
+            response["historical_es"] = es;
+
+            res.set_content(response.dump(), "application/json");
+            res.status = 200;
+        }
+        catch (const std::exception& e) {
+            res.status = 400;
+            res.set_content(json{{"error", e.what()}}.dump(), "application/json");
+        }
+    });
+
+    // ===============================
+    // POST /api/var/rolling
+    // ===============================
+    svr.Post("/api/var/rolling", [&](const httplib::Request& req, httplib::Response& res) {
+
+        try {
+            json body = parseBody(req);
+            std::vector<int> windows = body.value("windows", std::vector<int>{ 250 });
+            std::vector<double> confidences =
+                body.value("confidences", std::vector<double>{ 0.95, 0.99 });
+            if (windows.empty() || confidences.empty())
+                throw std::invalid_argument("windows and confidences must not be empty");
+
+            UniversePtr universe = universeFor(body);
+            PortfolioPtr tp = portfolioFor(body, universe);
+            auto portReturns =
+                PortfolioMetrics::portfolioReturnSeries(
+                    universe->returns(),
+                    universe->expandWeights(tp->weights)
+                );
+
+            // Series for every level of a window come from one pass;
+            // point t covers returns [t, t + window)
+            json response;
+            if (!tp->id.empty()) response["portfolio_id"] = tp->id;
+            response["observations"] = portReturns.size();
+            response["series"] = json::array();
+            for (int window : windows) {
+                if (window < 1)
+                    throw std::invalid_argument("windows must be positive");
+                RollingTailRisk tail = RiskMetrics::rollingTailRisk(
+                    portReturns, static_cast<size_t>(window), confidences);
+                for (size_t k = 0; k < confidences.size(); k++) {
+                    const double* var = tail.var.rowPtr(k);
+                    const double* es = tail.es.rowPtr(k);
+                    response["series"].push_back({
+                        {"window", window},
+                        {"confidence", confidences[k]},
+                        {"first_end", window - 1},
+                        {"var", std::vector<double>(var, var + tail.var.cols())},
+                        {"es", std::vector<double>(es, es + tail.es.cols())}
+                    });
+                }
+            }
 
             res.set_content(response.dump(), "application/json");
             res.status = 200;
@@ -199,33 +1062,34 @@ void Server::start(int port) {
     svr.Post("/api/stress", [&](const httplib::Request& req, httplib::Response& res) {
 
         try {
-            json body = json::parse(req.body);
+            json body = parseBody(req);
 
             double crash   = body.value("market_crash", 0.30);
             int asset      = body.value("asset_index", 0);
             double shock   = body.value("asset_shock", 0.50);
             double volMult = body.value("vol_multiplier", 2.0);
 
-            auto &mu  = DataCache::instance().mean();
-            auto &cov = DataCache::instance().cov();
+            UniversePtr universe = universeFor(body);
+            auto &mu  = universe->mean();
+            auto &cov = universe->cov();
 
-            Optimizer opt;
-            auto tp = opt.computeTangencyPortfolio(mu, cov, 0.001);
+            PortfolioPtr tp = portfolioFor(body, universe);
 
             auto crashRes =
-                RiskMetrics::marketCrash(tp.weights, mu, cov, crash);
+                RiskMetrics::marketCrash(tp->weights, mu, cov, crash);
 
             auto shockRes =
                 RiskMetrics::singleAssetShock(
-                    tp.weights, mu, cov, asset, shock
+                    tp->weights, mu, cov, asset, shock
                 );
 
             auto volRes =
                 RiskMetrics::volatilitySpike(
-                    tp.weights, mu, cov, volMult
+                    tp->weights, mu, cov, volMult
                 );
 
             json response;
+            if (!tp->id.empty()) response["portfolio_id"] = tp->id;
             response["market_crash_return"] = crashRes.stressedReturn;
             response["single_asset_shock_return"] = shockRes.stressedReturn;
             response["volatility_spike_risk"] = volRes.stressedRisk;
@@ -239,59 +1103,300 @@ void Server::start(int port) {
         }
     });
 
+    // ===============================
+    // POST /api/stress/grid
+    // ===============================
+    svr.Post("/api/stress/grid", [&](const httplib::Request& req, httplib::Response& res) {
+
+        try {
+            json body = parseBody(req);
+            double confidence = body.value("confidence", 0.95);
+
+            UniversePtr universe = universeFor(body);
+            PortfolioPtr tp = portfolioFor(body, universe);
+            const auto& symbols = universe->symbols();
+
+            // {"SYM": value, ...} -> (asset, value) pairs
+            auto perAsset = [&](const json& spec) {
+                std::vector<std::pair<size_t, double>> out;
+                for (const auto& [sym, value] : spec.items()) {
+                    auto it = std::find(symbols.begin(), symbols.end(), sym);
+                    if (it == symbols.end())
+                        throw std::invalid_argument("unknown symbol in stress grid: " + sym);
+                    out.emplace_back(it - symbols.begin(), value.get<double>());
+                }
+                return out;
+            };
+
+            // Plain numbers are the market shock, the all-asset volatility
+            // multiplier and the blend toward perfect correlation
+            StressGrid grid;
+            if (body.contains("return_shocks")) {
+                grid.returns.clear();
+                for (const json& item : body["return_shocks"]) {
+                    ReturnShock shock;
+                    if (item.is_number()) {
+                        shock.market = item.get<double>();
+                    } else {
+                        shock.market = item.value("market", 0.0);
+                        if (item.contains("assets")) shock.assets = perAsset(item["assets"]);
+                    }
+                    grid.returns.push_back(std::move(shock));
+                }
+            }
+            if (body.contains("vol_multipliers")) {
+                grid.vols.clear();
+                for (const json& item : body["vol_multipliers"]) {
+                    VolShock vol;
+                    if (item.is_number()) {
+                        vol.all = item.get<double>();
+                    } else {
+                        vol.all = item.value("all", 1.0);
+                        if (item.contains("assets")) vol.assets = perAsset(item["assets"]);
+                    }
+                    grid.vols.push_back(std::move(vol));
+                }
+            }
+            if (body.contains("correlation_blends")) {
+                grid.correlations.clear();
+                for (const json& item : body["correlation_blends"]) {
+                    CorrelationShock corr;
+                    if (item.is_number()) {
+                        corr.blend = item.get<double>();
+                    } else {
+                        corr.blend = item.value("blend", 0.0);
+                        corr.correlation = item.value("correlation", 1.0);
+                    }
+                    grid.correlations.push_back(corr);
+                }
+            }
+            size_t R = grid.returns.size(), V = grid.vols.size(), C = grid.correlations.size();
+            if (R == 0 || V == 0 || C == 0 || static_cast<double>(R) * V * C > 1e6)
+                throw std::invalid_argument("stress grid must have between 1 and 1e6 scenarios");
+
+            auto started = std::chrono::steady_clock::now();
+            StressEngine engine(tp->weights, universe->mean(), universe->cov());
+            StressGridResult out = engine.grid(grid, confidence, ThreadPool::shared());
+            double ms = std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - started).count();
+
+            json response;
+            if (!tp->id.empty()) response["portfolio_id"] = tp->id;
+            response["confidence"] = confidence;
+            response["base"] = {
+                {"return", engine.baseReturn()},
+                {"risk", engine.baseRisk()}
+            };
+            // Scenario (r, v, c) is entry (r * vols + v) * correlations + c
+            response["shape"] = {
+                {"return_shocks", R},
+                {"vol_multipliers", V},
+                {"correlation_blends", C}
+            };
+            response["stressed_return"] = out.stressedReturn;
+            response["stressed_risk"] = out.stressedRisk;
+            response["parametric_var"] = out.parametricVaR;
+            response["evaluate_ms"] = ms;
+
+            // Historical replay: explicit windows, or every window of a length
+            std::vector<std::pair<size_t, size_t>> windows;
+            if (body.contains("replay_windows")) {
+                for (const json& item : body["replay_windows"])
+                    windows.emplace_back(item.at("start").get<size_t>(), item.at("length").get<size_t>());
+            } else if (body.contains("replay_length")) {
+                size_t length = body["replay_length"].get<size_t>();
+                size_t rows = universe->returns().rows();
+                for (size_t start = 0; length > 0 && start + length <= rows; start++)
+                    windows.emplace_back(start, length);
+                if (windows.empty())
+                    throw std::invalid_argument("replay_length must be between 1 and the number of returns");
+            }
+            if (!windows.empty()) {
+                auto portReturns =
+                    PortfolioMetrics::portfolioReturnSeries(
+                        universe->returns(),
+                        universe->expandWeights(tp->weights)
+                    );
+                ReplayResult replay = StressEngine::replay(portReturns, windows);
+                json starts = json::array(), lengths = json::array();
+                for (const auto& [start, length] : windows) {
+                    starts.push_back(start);
+                    lengths.push_back(length);
+                }
+                response["replay"] = {
+                    {"start", starts},
+                    {"length", lengths},
+                    {"mean_return", replay.meanReturn},
+                    {"risk", replay.risk},
+                    {"cumulative_return", replay.cumulativeReturn}
+                };
+            }
+
+            res.set_content(response.dump(), "application/json");
+            res.status = 200;
+        }
+        catch (const std::exception& e) {
+            res.status = 400;
+            res.set_content(json{{"error", e.what()}}.dump(), "application/json");
+        }
+    });
+
     // POST -- /api/montecarlo
     svr.Post("/api/montecarlo",
     [&](const httplib::Request& req, httplib::Response& res) {
 
         try {
-            json body = json::parse(req.body);
+            json body = parseBody(req);
             int numSim = body.value("num_simulations", 1000);
             int horizon = body.value("horizon", 252);
 
-            DataCache::instance().loadIfNeeded();
-            auto& mu = DataCache::instance().mean();
-            auto& cov = DataCache::instance().cov();
+            // Paths are a pure function of the seed; without one, draw a
+            // 32-bit seed (exact in a JS number) and report it for replay
+            uint64_t seed = body.contains("seed")
+                ? body["seed"].get<uint64_t>()
+                : uint64_t(std::random_device{}());
 
-            Optimizer opt;
-            auto tp = opt.computeTangencyPortfolio(mu, cov, 0.001);
+            UniversePtr universe = universeFor(body);
+            auto &mu  = universe->mean();
+            auto &cov = universe->cov();
+
+            PortfolioPtr tp = portfolioFor(body, universe);
 
             double mu_p =
-                PortfolioMetrics::portfolioReturn(tp.weights, mu);
+                PortfolioMetrics::portfolioReturn(tp->weights, mu);
 
             double sigma_p =
                 PortfolioMetrics::portfolioRisk(
-                    PortfolioMetrics::portfolioVariance(tp.weights, cov)
+                    PortfolioMetrics::portfolioVariance(tp->weights, cov)
                 );
 
-            auto paths =
-                RiskMetrics::monteCarloPortfolioPaths(
-                    mu_p, sigma_p, numSim, horizon
-                );
+            // Bands, means and the terminal histogram are aggregated per
+            // step; full paths only for an explicit "sample_paths"
+            MonteCarloOptions options;
+            options.paths = numSim;
+            options.horizon = horizon;
+            options.seed = seed;
+            if (body.contains("percentiles"))
+                options.percentiles = body["percentiles"].get<std::vector<double>>();
+            options.histogramBins = body.value("histogram_bins", options.histogramBins);
+            options.samplePaths = body.value("sample_paths", 0);
+
+            // Variance reduction, and batches until a standard error
+            std::string sampling = body.value("sampling", std::string("pseudo"));
+            if (sampling == "pseudo") options.sampling = Sampling::Pseudo;
+            else if (sampling == "antithetic") options.sampling = Sampling::Antithetic;
+            else if (sampling == "sobol") options.sampling = Sampling::Sobol;
+            else throw std::invalid_argument("sampling must be \"pseudo\", \"antithetic\" or \"sobol\"");
+            options.controlVariate = body.value("control_variate", false);
+            options.targetStdError = body.value("target_std_error", 0.0);
+            options.maxPaths = body.value("max_simulations", options.maxPaths);
+
+            MonteCarloSummary summary =
+                RiskMetrics::monteCarloSummary(mu_p, sigma_p, options);
+
+            json percentiles = json::object();
+            for (size_t k = 0; k < options.percentiles.size(); k++) {
+                const double* row = summary.bands.rowPtr(k);
+                percentiles[percentileKey(options.percentiles[k])] =
+                    std::vector<double>(row, row + horizon);
+            }
 
-            // ---- Percentiles ----
-            json p5 = json::array();
-            json p50 = json::array();
-            json p95 = json::array();
+            json response;
+            if (!tp->id.empty()) response["portfolio_id"] = tp->id;
+            response["seed"] = seed;
+            response["num_simulations"] = numSim;
+            response["sampling"] = sampling;
+            response["control_variate"] = options.controlVariate;
+            response["paths_used"] = summary.pathsUsed;
+            response["batches"] = summary.batches;
+            response["std_error"] = summary.stdError;
+            response["percentile_levels"] = options.percentiles;
+            response["percentiles"] = percentiles;
+            response["mean"] = summary.mean;
+            response["terminal_histogram"] = {
+                {"edges", summary.histogramEdges},
+                {"counts", summary.histogramCounts}
+            };
+            if (options.samplePaths > 0)
+                response["paths"] = summary.samplePaths.toRows();
 
-            for (int t = 0; t < horizon; t++) {
-                std::vector<double> slice;
-                for (auto& p : paths)
-                    slice.push_back(p[t]);
+            res.set_content(response.dump(), "application/json");
+            res.status = 200;
+        }
+        catch (const std::exception& e) {
+            res.status = 400;
+            res.set_content(json{{"error", e.what()}}.dump(),
+                            "application/json");
+        }
+    });
 
-                std::sort(slice.begin(), slice.end());
+    // ===============================
+    // POST /api/montecarlo/assets
+    // ===============================
+    svr.Post("/api/montecarlo/assets",
+    [&](const httplib::Request& req, httplib::Response& res) {
 
-                p5.push_back(slice[int(0.05 * numSim)]);
-                p50.push_back(slice[int(0.50 * numSim)]);
-                p95.push_back(slice[int(0.95 * numSim)]);
-            }
+        try {
+            json body = parseBody(req);
+            UniversePtr universe = universeFor(body);
+            PortfolioPtr tp = portfolioFor(body, universe);
+            size_t N = universe->symbols().size();
+
+            AssetSimulationOptions options;
+            options.paths = body.value("num_simulations", options.paths);
+            options.horizon = body.value("horizon", options.horizon);
+            options.seed = body.contains("seed")
+                ? body["seed"].get<uint64_t>()
+                : uint64_t(std::random_device{}());
+            options.rebalanceEvery = body.value("rebalance_every", options.rebalanceEvery);
+            if (body.contains("percentiles"))
+                options.percentiles = body["percentiles"].get<std::vector<double>>();
+            // Terminal values are kept per asset and path
+            if (options.paths < 1 || static_cast<double>(options.paths) * N > 2e7)
+                throw std::invalid_argument("num_simulations must be positive and at most 2e7 / assets");
+
+            auto started = std::chrono::steady_clock::now();
+            AssetSimulationResult sim = MonteCarloEngine::simulateAssets(
+                universe->mean(), *universe->cholesky(), tp->weights, options,
+                ThreadPool::shared());
+            double ms = std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - started).count();
+
+            auto levelsOf = [&](const double* values) {
+                json out = json::object();
+                for (size_t k = 0; k < options.percentiles.size(); k++)
+                    out[percentileKey(options.percentiles[k])] = values[k];
+                return out;
+            };
 
             json response;
-            response["paths"] = paths;
-            response["percentiles"] = {
-                {"p5", p5},
-                {"p50", p50},
-                {"p95", p95}
+            if (!tp->id.empty()) response["portfolio_id"] = tp->id;
+            response["seed"] = options.seed;
+            response["num_simulations"] = options.paths;
+            response["horizon"] = options.horizon;
+            response["rebalance_every"] = options.rebalanceEvery;
+            response["percentile_levels"] = options.percentiles;
+            response["portfolio"] = {
+                {"mean", sim.portfolioMean},
+                {"stdev", sim.portfolioStdev},
+                {"loss_probability", sim.portfolioLossProbability},
+                {"percentiles", levelsOf(sim.portfolioPercentiles.data())}
             };
+            response["assets"] = json::array();
+            for (size_t i = 0; i < N; i++) {
+                response["assets"].push_back({
+                    {"asset", static_cast<int>(i)},
+                    {"symbol", universe->symbols()[i]},
+                    {"weight", tp->weights[i]},
+                    {"mean", sim.assetMean[i]},
+                    {"stdev", sim.assetStdev[i]},
+                    {"loss_probability", sim.assetLossProbability[i]},
+                    {"percentiles", levelsOf(sim.assetPercentiles.rowPtr(i))}
+                });
+            }
+            response["simulate_ms"] = ms;
+            response["asset_steps_per_sec"] =
+                static_cast<double>(options.paths) * options.horizon * N / (ms / 1000.0);
 
             res.set_content(response.dump(), "application/json");
             res.status = 200;
@@ -307,22 +1412,20 @@ void Server::start(int port) {
     svr.Post("/api/backtest",
 [&](const httplib::Request& req, httplib::Response& res) {
         try {
-            DataCache::instance().loadIfNeeded();
+            json body = parseBody(req);
+            UniversePtr universe = universeFor(body);
+            MatrixView returns = universe->returns();
 
-            auto returns = DataCache::instance().returns();
-            auto &mu = DataCache::instance().mean();
-            auto &cov = DataCache::instance().cov();
-
-            Optimizer opt;
-            auto tp = opt.computeTangencyPortfolio(mu, cov, 0.001);
+            PortfolioPtr tp = portfolioFor(body, universe);
 
             auto bt =
                 BacktestEngine::run(
                     returns,
-                    tp.weights
+                    universe->expandWeights(tp->weights)
                 );
 
             json response;
+            if (!tp->id.empty()) response["portfolio_id"] = tp->id;
             response["equity_curve"] = bt.equityCurve;
             response["drawdown"] = bt.drawdown;
             response["cagr"] = bt.cagr;
@@ -0,0 +1,72 @@
+// Batch throughput (problems per second) against pool size, all solves
+// sharing one Cholesky-backed frontier state.
+//
+// usage: BatchBench [assets] [problems]
+
+#include "BenchUtil.h"
+#include "Cholesky.h"
+#include "FrontierState.h"
+#include "Optimizer.h"
+#include "Statistics.h"
+#include "ThreadPool.h"
+
+#include <iostream>
+#include <random>
+#include <thread>
+
+int main(int argc, char** argv) {
+    size_t N = bench::argOr(argc, argv, 1, 200);
+    size_t count = bench::argOr(argc, argv, 2, 400);
+    size_t T = 1000;
+
+    std::mt19937 gen(21);
+    std::normal_distribution<double> z(0.0, 1.0);
+    Matrix returns(T, N);
+    for (size_t t = 0; t < T; t++) {
+        double f = z(gen);
+        for (size_t i = 0; i < N; i++)
+            returns(t, i) = 0.0002 + 0.0004 * i / N + 0.01 * z(gen) + 0.006 * f;
+    }
+    auto mean = Statistics::computeReturnsMean(returns);
+    Matrix cov = Statistics::computeCovariance(returns, mean);
+    FrontierState state(mean, CholeskyFactor::factor(cov));
+
+    // The desk mix: rf sweeps, target returns, capped min-variance, parity
+    std::vector<BatchProblem> problems(count);
+    for (size_t i = 0; i < count; i++) {
+        BatchProblem& p = problems[i];
+        switch (i % 4) {
+        case 0:
+            p.kind = BatchProblem::Kind::Tangency;
+            p.rf = 0.0001 * (i % 10) / 10.0;
+            break;
+        case 1:
+            p.kind = BatchProblem::Kind::TargetReturn;
+            p.targetReturn = state.minReturn() + 0.0001 * (i % 17);
+            break;
+        case 2:
+            p.kind = BatchProblem::Kind::MinVariance;
+            p.maxWeight = 0.02 + 0.01 * (i % 5);
+            break;
+        case 3:
+            p.kind = BatchProblem::Kind::RiskParity;
+            break;
+        }
+    }
+
+    std::cout << "N=" << N << " problems=" << count << "\n";
+    double single = 0.0, sink = 0.0;
+    size_t hw = std::max(1u, std::thread::hardware_concurrency());
+    for (size_t threads = 1; threads <= hw; threads *= 2) {
+        ThreadPool pool(threads - 1);  // the caller is the last thread
+        double ms = bench::timeMs([&] {
+            auto results = Optimizer::solveBatch(mean, cov, state, problems, pool);
+            sink += results.back().risk;
+        }, 2);
+        double rate = count * 1000.0 / ms;
+        if (threads == 1) single = rate;
+        std::cout << "threads " << threads << " : " << ms << " ms, "
+                  << rate << " problems/s, speedup " << rate / single << "\n";
+    }
+    bench::consume(sink);
+}
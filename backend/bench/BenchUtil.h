@@ -0,0 +1,34 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+// Best-of-n wall time of f() in milliseconds.
+template <class F>
+double timeMs(F&& f, int reps = 3) {
+    double best = 1e300;
+    for (int r = 0; r < reps; r++) {
+        auto t0 = std::chrono::steady_clock::now();
+        f();
+        auto t1 = std::chrono::steady_clock::now();
+        best = std::min(best,
+            std::chrono::duration<double, std::milli>(t1 - t0).count());
+    }
+    return best;
+}
+
+inline long argOr(int argc, char** argv, int i, long fallback) {
+    return argc > i ? std::atol(argv[i]) : fallback;
+}
+
+// Keeps the optimizer from discarding benchmarked results.
+inline void consume(double v) {
+    [[maybe_unused]] static volatile double sink;
+    sink = v;
+}
+
+}
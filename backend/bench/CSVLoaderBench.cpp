@@ -0,0 +1,90 @@
+// Throughput of CSVLoader against the previous getline/stringstream/stod
+// reader that Statistics::readCSV used.
+//
+// usage: CSVLoaderBench [rows] [symbols]
+
+#include "BenchUtil.h"
+#include "data/CSVLoader.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+
+static std::vector<std::vector<double>>
+legacyReadCSV(const std::string& filePath) {
+    std::ifstream file(filePath);
+    std::vector<std::vector<double>> prices;
+    std::string line;
+    if (!std::getline(file, line)) return {};
+
+    while (std::getline(file, line)) {
+        std::stringstream ss(line);
+        std::string token;
+        std::vector<double> row;
+        bool skipFirst = true;
+        while (std::getline(ss, token, ',')) {
+            if (skipFirst) { skipFirst = false; continue; }
+            row.push_back(std::stod(token));
+        }
+        if (!row.empty()) prices.push_back(row);
+    }
+    return prices;
+}
+
+int main(int argc, char** argv) {
+    long rows = bench::argOr(argc, argv, 1, 20000);
+    long cols = bench::argOr(argc, argv, 2, 500);
+    std::string path = "csv_loader_bench.csv";
+
+    {
+        std::ofstream out(path);
+        std::mt19937 gen(7);
+        std::uniform_real_distribution<double> px(10.0, 500.0);
+        out << "Date";
+        for (long c = 0; c < cols; c++) out << ",S" << c;
+        out << "\n";
+        char buf[32];
+        for (long r = 0; r < rows; r++) {
+            out << "2000-01-" << (r % 28 + 1);
+            for (long c = 0; c < cols; c++) {
+                std::snprintf(buf, sizeof buf, ",%.4f", px(gen));
+                out << buf;
+            }
+            out << "\n";
+        }
+    }
+
+    double mb = 0;
+    {
+        std::ifstream f(path, std::ios::binary | std::ios::ate);
+        mb = static_cast<double>(f.tellg()) / (1024.0 * 1024.0);
+    }
+
+    double legacyMs = bench::timeMs([&] {
+        bench::consume(legacyReadCSV(path).size());
+    }, 1);
+
+    double loaderMs = bench::timeMs([&] {
+        auto t = CSVLoader::load(path);
+        bench::consume(t.values.empty() ? 0 : t.values.back());
+    });
+
+    double singleMs = bench::timeMs([&] {
+        auto t = CSVLoader::load(path, 1);
+        bench::consume(t.values.empty() ? 0 : t.values.back());
+    });
+
+    std::cout << "file: " << rows << " rows x " << cols << " symbols, "
+              << mb << " MB\n";
+    std::cout << "legacy readCSV      : " << legacyMs << " ms, "
+              << mb / (legacyMs / 1000.0) << " MB/s\n";
+    std::cout << "CSVLoader (1 thread): " << singleMs << " ms, "
+              << mb / (singleMs / 1000.0) << " MB/s\n";
+    std::cout << "CSVLoader (pool)    : " << loaderMs << " ms, "
+              << mb / (loaderMs / 1000.0) << " MB/s\n";
+
+    std::remove(path.c_str());
+    return 0;
+}
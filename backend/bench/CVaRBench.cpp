@@ -0,0 +1,64 @@
+// Minimum-CVaR solve time over scenario count and pool size, on
+// synthetic one-factor returns with occasional market-wide jumps.
+//
+// usage: CVaRBench [scenarios] [assets] [alpha]
+
+#include "BenchUtil.h"
+#include "CVaROptimizer.h"
+#include "ThreadPool.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <thread>
+
+int main(int argc, char** argv) {
+    size_t S = bench::argOr(argc, argv, 1, 100000);
+    size_t N = bench::argOr(argc, argv, 2, 500);
+    double alpha = argc > 3 ? std::atof(argv[3]) : 0.95;
+
+    std::mt19937 gen(19);
+    std::normal_distribution<double> z(0.0, 1.0);
+    std::uniform_real_distribution<double> u(0.0, 1.0);
+    std::vector<double> beta(N), vol(N);
+    for (size_t i = 0; i < N; i++) {
+        beta[i] = 0.5 + u(gen);
+        vol[i] = 0.008 + 0.015 * u(gen);
+    }
+    Matrix scenarios(S, N);
+    for (size_t s = 0; s < S; s++) {
+        double f = 0.01 * z(gen) - (u(gen) < 0.02 ? 0.04 : 0.0);
+        for (size_t i = 0; i < N; i++)
+            scenarios(s, i) = 0.0003 + beta[i] * f + vol[i] * z(gen);
+    }
+
+    CVaRSettings settings;
+    settings.alpha = alpha;
+    std::cout << "S=" << S << " N=" << N << " alpha=" << alpha << "\n";
+
+    // Growing scenario counts on the shared pool
+    for (size_t rows = S / 8; rows <= S; rows *= 2) {
+        CVaRResult r;
+        double ms = bench::timeMs([&] {
+            r = CVaROptimizer::minimize(scenarios.view().rowRange(0, rows), settings,
+                                        ThreadPool::shared());
+        }, 2);
+        std::cout << "scenarios " << rows << " : " << ms << " ms, cvar " << r.cvar
+                  << ", iterations " << r.iterations << ", rounds " << r.rounds
+                  << ", working set " << r.workingSet << "\n";
+    }
+
+    // Full problem against pool size
+    double single = 0.0, sink = 0.0;
+    size_t hw = std::max(1u, std::thread::hardware_concurrency());
+    for (size_t threads = 1; threads <= hw; threads *= 2) {
+        ThreadPool pool(threads - 1);  // the caller is the last thread
+        double ms = bench::timeMs([&] {
+            sink += CVaROptimizer::minimize(scenarios.view(), settings, pool).cvar;
+        }, 2);
+        if (threads == 1) single = ms;
+        std::cout << "threads " << threads << " : " << ms << " ms, speedup "
+                  << single / ms << "\n";
+    }
+    bench::consume(sink);
+}
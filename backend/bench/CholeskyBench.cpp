@@ -0,0 +1,85 @@
+// Cholesky factor + triangular solves against the Gauss-Jordan inverse the
+// optimizer used to build per request, and a rank-1 update against
+// refactoring after one new observation.
+//
+// usage: CholeskyBench [assets] [observations]
+
+#include "BenchUtil.h"
+#include "Cholesky.h"
+#include "Statistics.h"
+
+#include <cmath>
+#include <iostream>
+#include <random>
+
+static Matrix gaussJordanInverse(MatrixView cov) {
+    size_t n = cov.rows();
+    Matrix A(cov);
+    Matrix I = Matrix::identity(n);
+    for (size_t i = 0; i < n; i++) {
+        double p = A(i, i);
+        for (size_t j = 0; j < n; j++) {
+            A(i, j) /= p;
+            I(i, j) /= p;
+        }
+        for (size_t k = 0; k < n; k++) {
+            if (k == i) continue;
+            double f = A(k, i);
+            for (size_t j = 0; j < n; j++) {
+                A(k, j) -= f * A(i, j);
+                I(k, j) -= f * I(i, j);
+            }
+        }
+    }
+    return I;
+}
+
+int main(int argc, char** argv) {
+    size_t N = bench::argOr(argc, argv, 1, 500);
+    size_t T = bench::argOr(argc, argv, 2, 2520);
+
+    std::mt19937 gen(9);
+    std::normal_distribution<double> noise(0.0003, 0.012);
+    Matrix returns(T, N);
+    for (size_t i = 0; i < returns.size(); i++) returns.data()[i] = noise(gen);
+    auto mean = Statistics::computeReturnsMean(returns);
+    Matrix cov = Statistics::computeCovariance(returns, mean);
+    std::vector<double> b(mean);
+
+    double sink = 0.0;
+    double invMs = bench::timeMs([&] {
+        Matrix inv = gaussJordanInverse(cov);
+        for (size_t j = 0; j < N; j++) sink += inv(0, j) * b[j];
+    }, 1);
+
+    CholeskyFactor f;
+    double factorMs = bench::timeMs([&] { f = CholeskyFactor::factor(cov); });
+    double solveMs = bench::timeMs([&] { sink += f.solve(b)[0]; }, 5);
+
+    std::vector<double> x(N);
+    for (auto& v : x) v = noise(gen);
+    std::vector<double> d(N);
+    for (size_t i = 0; i < N; i++) d[i] = (x[i] - mean[i]) / std::sqrt(T + 1.0);
+
+    double updateMs = bench::timeMs([&] {
+        CholeskyFactor g = f;
+        g.scale((T - 1.0) / T);
+        g.update(d);
+        sink += g.upper()(0, 0);
+    }, 5);
+    double refactorMs = bench::timeMs([&] {
+        std::vector<double> m = mean;
+        Matrix c = cov;
+        Statistics::appendObservation(x.data(), T, m, c);
+        sink += CholeskyFactor::factor(c).upper()(0, 0);
+    });
+    bench::consume(sink);
+
+    std::cout << "N=" << N << " T=" << T << "\n";
+    std::cout << "gauss-jordan inverse : " << invMs << " ms\n";
+    std::cout << "cholesky factor      : " << factorMs << " ms\n";
+    std::cout << "solve (2 triangular) : " << solveMs << " ms\n";
+    std::cout << "rank-1 update        : " << updateMs << " ms\n";
+    std::cout << "append + refactor    : " << refactorMs << " ms\n";
+    return 0;
+}
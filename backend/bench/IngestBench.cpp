@@ -0,0 +1,93 @@
+// Tick ingestion throughput: line parsing, the SPSC ring between two
+// threads, and parse -> ring -> bar aggregation end to end.
+//
+// usage: IngestBench [ticks] [symbols]
+
+#include "BenchUtil.h"
+#include "ingest/BarAggregator.h"
+#include "ingest/RingBuffer.h"
+#include "ingest/Tick.h"
+
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+
+int main(int argc, char** argv) {
+    size_t ticks = bench::argOr(argc, argv, 1, 5000000);
+    size_t N = bench::argOr(argc, argv, 2, 500);
+
+    SymbolIndex symbols;
+    std::vector<std::string> names;
+    for (size_t i = 0; i < N; i++) {
+        names.push_back("SYM" + std::to_string(i));
+        symbols[names.back()] = static_cast<uint32_t>(i);
+    }
+
+    std::mt19937 gen(5);
+    std::uniform_real_distribution<double> px(10.0, 500.0);
+    std::string text;
+    for (size_t i = 0; i < ticks; i++) {
+        text += std::to_string(1704067200000LL + static_cast<long long>(i));
+        text += ',';
+        text += names[i % N];
+        text += ',';
+        text += std::to_string(px(gen));
+        text += '\n';
+    }
+
+    // ---- parse ----
+    std::vector<Tick> parsed;
+    parsed.reserve(ticks);
+    uint64_t rejected = 0;
+    double parseMs = bench::timeMs([&] {
+        parsed.clear();
+        parseTicks(text.data(), text.size(), symbols, steadyNowNs(), parsed, rejected);
+    });
+
+    // ---- ring, producer and consumer threads ----
+    SpscRing<Tick> ring(1 << 16);
+    auto pump = [&](auto&& onBatch) {
+        std::thread producer([&] {
+            size_t done = 0;
+            while (done < parsed.size()) {
+                size_t n = std::min<size_t>(4096, parsed.size() - done);
+                size_t pushed = ring.pushBatch(parsed.data() + done, n);
+                done += pushed;
+                if (pushed < n) std::this_thread::yield();
+            }
+        });
+        std::vector<Tick> batch(4096);
+        size_t got = 0;
+        while (got < parsed.size()) {
+            size_t n = ring.popBatch(batch.data(), batch.size());
+            if (n == 0) { std::this_thread::yield(); continue; }
+            onBatch(batch.data(), n);
+            got += n;
+        }
+        producer.join();
+    };
+
+    double sum = 0.0;
+    double ringMs = bench::timeMs([&] {
+        pump([&](const Tick* t, size_t n) { for (size_t i = 0; i < n; i++) sum += t[i].price; });
+    });
+
+    uint64_t bars = 0;
+    double pipeMs = bench::timeMs([&] {
+        BarAggregator agg(std::vector<double>(N, 1.0), "", 60000,
+                          [&](const std::vector<double>&, const std::string&) { bars++; });
+        pump([&](const Tick* t, size_t n) { for (size_t i = 0; i < n; i++) agg.add(t[i]); });
+    });
+    bench::consume(sum);
+
+    auto rate = [&](double ms) { return ticks / ms / 1000.0; };
+    std::cout << "ticks=" << ticks << " symbols=" << N
+              << " (" << text.size() / (1 << 20) << " MiB of text)\n";
+    std::cout << "parse          : " << parseMs << " ms  " << rate(parseMs) << " M ticks/s\n";
+    std::cout << "ring (2 thr)   : " << ringMs << " ms  " << rate(ringMs) << " M ticks/s\n";
+    std::cout << "ring + bars    : " << pipeMs << " ms  " << rate(pipeMs) << " M ticks/s  ("
+              << bars / 3 << " bars)\n";
+    std::cout << "parse+ring+bars: " << rate(parseMs + pipeMs) << " M ticks/s\n";
+    return 0;
+}
@@ -0,0 +1,97 @@
+// vector<vector<double>> kernels (as they were before Matrix) against the
+// Matrix-based Statistics / PortfolioMetrics / BacktestEngine paths.
+//
+// usage: MatrixBench [assets] [observations]
+
+#include "BenchUtil.h"
+#include "BacktestEngine.h"
+#include "PortfolioMetrics.h"
+#include "Statistics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+
+using Rows = std::vector<std::vector<double>>;
+
+static Rows legacyCovariance(const Rows& returns, const std::vector<double>& means) {
+    size_t T = returns.size(), N = returns[0].size();
+    Rows cov(N, std::vector<double>(N, 0.0));
+    for (size_t i = 0; i < N; i++)
+        for (size_t j = 0; j < N; j++) {
+            for (size_t t = 0; t < T; t++)
+                cov[i][j] += (returns[t][i] - means[i]) * (returns[t][j] - means[j]);
+            cov[i][j] /= (T - 1);
+        }
+    return cov;
+}
+
+static double legacyVariance(const std::vector<double>& w, const Rows& cov) {
+    double var = 0.0;
+    for (size_t i = 0; i < w.size(); i++)
+        for (size_t j = 0; j < w.size(); j++)
+            var += w[i] * cov[i][j] * w[j];
+    return var;
+}
+
+static double legacyBacktest(const Rows& returns, const std::vector<double>& w) {
+    std::vector<double> equityCurve(returns.size()), drawdown(returns.size());
+    double equity = 1.0, peak = 1.0;
+    for (size_t t = 0; t < returns.size(); t++) {
+        double r = 0.0;
+        for (size_t i = 0; i < w.size(); i++) r += w[i] * returns[t][i];
+        equity *= 1.0 + r;
+        peak = std::max(peak, equity);
+        equityCurve[t] = equity;
+        drawdown[t] = (equity - peak) / peak;
+    }
+    return *std::min_element(drawdown.begin(), drawdown.end());
+}
+
+int main(int argc, char** argv) {
+    size_t N = bench::argOr(argc, argv, 1, 500);
+    size_t T = bench::argOr(argc, argv, 2, 5000);
+
+    std::mt19937 gen(11);
+    std::normal_distribution<double> noise(0.0004, 0.015);
+
+    Matrix returns(T, N);
+    for (size_t i = 0; i < returns.size(); i++)
+        returns.data()[i] = noise(gen);
+    Rows legacyReturns = returns.toRows();
+
+    auto mean = Statistics::computeReturnsMean(returns);
+    std::vector<double> w(N, 1.0 / N);
+
+    Matrix cov;
+    Rows legacyCov;
+
+    double covOld = bench::timeMs([&] { legacyCov = legacyCovariance(legacyReturns, mean); }, 1);
+    double covNew = bench::timeMs([&] { cov = Statistics::computeCovariance(returns, mean); });
+
+    double maxDiff = 0.0;
+    for (size_t i = 0; i < N; i++)
+        for (size_t j = 0; j < N; j++)
+            maxDiff = std::max(maxDiff, std::abs(cov(i, j) - legacyCov[i][j]));
+
+    const int reps = 200;
+    double varOld = bench::timeMs([&] {
+        for (int r = 0; r < reps; r++) bench::consume(legacyVariance(w, legacyCov));
+    }) / reps;
+    double varNew = bench::timeMs([&] {
+        for (int r = 0; r < reps; r++) bench::consume(PortfolioMetrics::portfolioVariance(w, cov));
+    }) / reps;
+
+    double btOld = bench::timeMs([&] { bench::consume(legacyBacktest(legacyReturns, w)); });
+    double btNew = bench::timeMs([&] {
+        bench::consume(BacktestEngine::run(returns, w).maxDrawdown);
+    });
+
+    std::cout << "N=" << N << " T=" << T << "\n";
+    std::cout << "covariance : " << covOld << " ms -> " << covNew << " ms"
+              << "  (max |diff| " << maxDiff << ")\n";
+    std::cout << "variance   : " << varOld * 1000 << " us -> " << varNew * 1000 << " us\n";
+    std::cout << "backtest   : " << btOld << " ms -> " << btNew << " ms\n";
+    return 0;
+}
@@ -0,0 +1,106 @@
+// Portfolio path simulation against pool size, 1 to 64 threads, checking
+// that every thread count reproduces the single-thread paths bit for bit;
+// then streamed percentile bands against full paths plus per-step sorts;
+// then the paths each sampling mode needs to reach a band standard error.
+//
+// usage: MonteCarloBench [paths] [horizon]
+
+#include "BenchUtil.h"
+#include "RiskMetrics.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <random>
+
+int main(int argc, char** argv) {
+    int paths = static_cast<int>(bench::argOr(argc, argv, 1, 50000));
+    int horizon = static_cast<int>(bench::argOr(argc, argv, 2, 252));
+    const double mu = 0.0004, sigma = 0.012;
+    const uint64_t seed = 2024;
+
+    std::cout << "paths=" << paths << " horizon=" << horizon << "\n";
+
+    // The previous engine: one mt19937 stream, serial
+    double sink = 0.0;
+    double mt = bench::timeMs([&] {
+        std::mt19937 rng(42);
+        std::normal_distribution<double> dist(mu, sigma);
+        Matrix out(paths, horizon);
+        for (int i = 0; i < paths; i++) {
+            double value = 1.0;
+            for (int t = 0; t < horizon; t++) {
+                value *= 1.0 + dist(rng);
+                out(i, t) = value;
+            }
+        }
+        sink += out(paths - 1, horizon - 1);
+    }, 2);
+    std::cout << "mt19937 serial : " << mt << " ms\n";
+
+    Matrix reference;
+    double single = 0.0;
+    for (size_t threads = 1; threads <= 64; threads *= 2) {
+        ThreadPool pool(threads - 1);  // the caller is the last thread
+        Matrix out;
+        double ms = bench::timeMs([&] {
+            out = RiskMetrics::monteCarloPortfolioPaths(mu, sigma, paths, horizon, seed, pool);
+        }, 2);
+        if (threads == 1) {
+            single = ms;
+            reference = out;
+        }
+        bool identical = std::memcmp(out.data(), reference.data(),
+                                     out.size() * sizeof(double)) == 0;
+        std::cout << "threads " << threads << " : " << ms << " ms, speedup "
+                  << single / ms << ", " << paths * 1000.0 / ms << " paths/s, "
+                  << (identical ? "identical" : "DIFFERENT") << "\n";
+        sink += out(paths - 1, horizon - 1);
+    }
+
+    // p5/p50/p95 the old way: every path kept, one full sort per step
+    double sorted = bench::timeMs([&] {
+        Matrix out = RiskMetrics::monteCarloPortfolioPaths(mu, sigma, paths, horizon, seed);
+        std::vector<double> slice(paths);
+        for (int t = 0; t < horizon; t++) {
+            for (int i = 0; i < paths; i++) slice[i] = out(i, t);
+            std::sort(slice.begin(), slice.end());
+            sink += slice[paths / 2];
+        }
+    }, 2);
+    MonteCarloOptions options;
+    options.paths = paths;
+    options.horizon = horizon;
+    options.seed = seed;
+    double streamed = bench::timeMs([&] {
+        sink += RiskMetrics::monteCarloSummary(mu, sigma, options).bands(1, horizon - 1);
+    }, 2);
+    std::cout << "bands, paths + sort : " << sorted << " ms, "
+              << paths * double(horizon) * 8 / 1e6 << " MB of paths\n"
+              << "bands, streamed     : " << streamed << " ms, "
+              << paths * 16.0 * 8 / 1e6 << " MB per tile\n";
+
+    // Target mode: batches of 2048 until every band and mean is within
+    // 5e-4, or 2^18 paths
+    const char* names[] = { "pseudo", "antithetic", "sobol" };
+    for (bool cv : { false, true }) {
+        for (Sampling sampling : { Sampling::Pseudo, Sampling::Antithetic, Sampling::Sobol }) {
+            MonteCarloOptions target = options;
+            target.paths = 2048;
+            target.sampling = sampling;
+            target.controlVariate = cv;
+            target.targetStdError = 5e-4;
+            target.maxPaths = 1 << 18;
+            MonteCarloSummary s;
+            double ms = bench::timeMs([&] {
+                s = RiskMetrics::monteCarloSummary(mu, sigma, target);
+            }, 1);
+            std::cout << "target 5e-4, " << names[static_cast<int>(sampling)]
+                      << (cv ? " + control" : "") << " : " << s.pathsUsed << " paths, "
+                      << "error " << s.stdError << ", " << ms << " ms\n";
+            sink += s.bands(0, horizon - 1);
+        }
+    }
+    bench::consume(sink);
+}
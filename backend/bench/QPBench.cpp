@@ -0,0 +1,68 @@
+// Constrained max-Sharpe and minimum-variance solve time against N, cold
+// and warm-started from the previous day's solution after one new
+// observation.
+//
+// usage: QPBench [max_weight] [observations]
+
+#include "BenchUtil.h"
+#include "PortfolioQP.h"
+#include "Statistics.h"
+
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <random>
+
+int main(int argc, char** argv) {
+    double cap = bench::argOr(argc, argv, 1, 5) / 100.0;
+    size_t T = bench::argOr(argc, argv, 2, 1000);
+
+    PortfolioConstraints c;
+    c.maxWeight = cap;
+
+    std::cout << "max_weight=" << cap << " T=" << T << "\n";
+    std::cout << std::setw(6) << "N" << std::setw(14) << "objective"
+              << std::setw(12) << "cold ms" << std::setw(8) << "iters"
+              << std::setw(12) << "warm ms" << std::setw(8) << "iters" << "\n";
+
+    double sink = 0.0;
+    for (size_t N : { 50, 100, 200, 500 }) {
+        if (N * cap < 1.0) continue;
+
+        // One market factor plus noise, drift rising with the index
+        std::mt19937 gen(11);
+        std::normal_distribution<double> z(0.0, 1.0);
+        Matrix returns(T, N);
+        for (size_t t = 0; t < T; t++) {
+            double f = z(gen);
+            for (size_t i = 0; i < N; i++)
+                returns(t, i) = 0.0002 + 0.0004 * i / N + 0.01 * z(gen) + 0.006 * f;
+        }
+        auto mean = Statistics::computeReturnsMean(returns);
+        Matrix cov = Statistics::computeCovariance(returns, mean);
+
+        std::vector<double> next(N);
+        for (auto& v : next) v = 0.01 * z(gen);
+        auto mean2 = mean;
+        Matrix cov2 = cov;
+        Statistics::appendObservation(next.data(), T, mean2, cov2);
+
+        auto row = [&](const char* name, auto solve) {
+            ConstrainedPortfolio cold, warm;
+            double coldMs = bench::timeMs([&] { cold = solve(mean, cov, nullptr); });
+            double warmMs = bench::timeMs([&] { warm = solve(mean2, cov2, &cold.qp); });
+            sink += cold.risk + warm.risk;
+            std::cout << std::setw(6) << N << std::setw(14) << name
+                      << std::setw(12) << coldMs << std::setw(8) << cold.qp.iterations
+                      << std::setw(12) << warmMs << std::setw(8) << warm.qp.iterations << "\n";
+        };
+
+        row("min-variance", [&](const auto& mu, const Matrix& cv, const QPResult* w) {
+            return PortfolioQP::minVariance(mu, cv, c, {}, w);
+        });
+        row("max-sharpe", [&](const auto& mu, const Matrix& cv, const QPResult* w) {
+            return PortfolioQP::maxSharpe(mu, cv, 0.0, c, {}, w);
+        });
+    }
+    bench::consume(sink);
+}
@@ -0,0 +1,92 @@
+// Per-call latency of the fixed-size kernels against the generic paths
+// for small universes: portfolio variance and tangency weights.
+//
+// usage: SmallKernelBench [calls]
+
+#include "BenchUtil.h"
+#include "Cholesky.h"
+#include "FrontierState.h"
+#include "SmallKernels.h"
+#include "Statistics.h"
+
+#include <iomanip>
+#include <iostream>
+#include <random>
+
+// PortfolioMetrics::portfolioVariance without the small-size dispatch,
+// kept out of line like the library call it stands in for
+__attribute__((noinline))
+static double genericVariance(MatrixView cov, const std::vector<double>& w) {
+    double var = 0.0;
+    for (size_t i = 0; i < w.size(); i++)
+        var += w[i] * dotProduct(cov.rowPtr(i), w.data(), w.size());
+    return var;
+}
+
+int main(int argc, char** argv) {
+    long calls = bench::argOr(argc, argv, 1, 200000);
+
+    std::cout << std::setw(4) << "N"
+              << std::setw(16) << "var generic ns" << std::setw(14) << "var fixed ns"
+              << std::setw(16) << "tan generic ns" << std::setw(14) << "tan fixed ns" << "\n";
+
+    double sink = 0.0;
+    for (size_t N : { 2, 4, 8, 12, 16, 24, 32 }) {
+        std::mt19937 gen(3);
+        std::normal_distribution<double> z(0.0, 1.0);
+        size_t T = 500;
+        Matrix returns(T, N);
+        for (size_t t = 0; t < T; t++) {
+            double f = z(gen);
+            for (size_t i = 0; i < N; i++)
+                returns(t, i) = 0.0003 + 0.0002 * i / N + 0.01 * z(gen) + 0.005 * f;
+        }
+        auto mu = Statistics::computeReturnsMean(returns);
+        Matrix cov = Statistics::computeCovariance(returns, mu);
+        // A bank of distinct weight vectors so calls are independent
+        std::vector<std::vector<double>> bank(64, std::vector<double>(N, 1.0 / N));
+        for (size_t k = 0; k < bank.size(); k++) bank[k][k % N] += 1e-3 * k;
+        std::vector<double> out(N);
+
+        long tanCalls = std::max(1L, calls / 10);
+        auto perCall = [](double ms, long n) { return ms * 1e6 / n; };
+
+        double varGeneric = bench::timeMs([&] {
+            double acc = 0.0;
+            for (long k = 0; k < calls; k++) acc += genericVariance(cov, bank[k & 63]);
+            sink += acc;
+        });
+        double varFixed = bench::timeMs([&] {
+            double acc = 0.0;
+            for (long k = 0; k < calls; k++) {
+                double v = 0.0;
+                SmallKernels::quadraticForm(cov, bank[k & 63].data(), N, v);
+                acc += v;
+            }
+            sink += acc;
+        });
+        double tanGeneric = bench::timeMs([&] {
+            double acc = 0.0;
+            for (long k = 0; k < tanCalls; k++) {
+                FrontierState state(mu, CholeskyFactor::factor(cov));
+                acc += state.tangencyWeights(0.0001 * (k & 7))[0];
+            }
+            sink += acc;
+        });
+        double tanFixed = bench::timeMs([&] {
+            double acc = 0.0;
+            for (long k = 0; k < tanCalls; k++) {
+                SmallKernels::tangencyWeights(cov, mu.data(), N, 0.0001 * (k & 7), out.data());
+                acc += out[0];
+            }
+            sink += acc;
+        });
+
+        std::cout << std::setw(4) << N
+                  << std::setw(16) << perCall(varGeneric, calls)
+                  << std::setw(14) << perCall(varFixed, calls)
+                  << std::setw(16) << perCall(tanGeneric, tanCalls)
+                  << std::setw(14) << perCall(tanFixed, tanCalls) << "\n";
+    }
+    bench::consume(sink);
+}
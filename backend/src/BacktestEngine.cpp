@@ -4,12 +4,12 @@
 #include <algorithm>
 
 BacktestResult BacktestEngine::run(
-    const std::vector<std::vector<double>>& returns,
+    MatrixView returns,
     const std::vector<double>& weights
 ) {
     BacktestResult result;
 
-    int T = returns.size();
+    int T = returns.rows();
     if (T == 0) return result;
 
     result.equityCurve.resize(T);
@@ -18,12 +18,11 @@ BacktestResult BacktestEngine::run(
     double equity = 1.0;
     double peak = 1.0;
 
+    auto portReturns =
+        PortfolioMetrics::portfolioReturnSeries(returns, weights);
+
     for (int t = 0; t < T; t++) {
-        double r =
-            PortfolioMetrics::portfolioReturn(
-                weights,
-                returns[t]
-            );
+        double r = portReturns[t];
 
         equity *= (1.0 + r);
         peak = std::max(peak, equity);
@@ -3,6 +3,8 @@
 
 #include <vector>
 
+#include "Matrix.h"
+
 struct BacktestResult {
     std::vector<double> equityCurve;
     std::vector<double> drawdown;
@@ -13,7 +15,7 @@ struct BacktestResult {
 class BacktestEngine {
 public:
     static BacktestResult run(
-        const std::vector<std::vector<double>>& returns,
+        MatrixView returns,
         const std::vector<double>& weights
     );
 };
@@ -0,0 +1,309 @@
+#include "CVaROptimizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <numeric>
+#include <stdexcept>
+
+#include "Cholesky.h"
+#include "OptimizerUtils.h"
+#include "Philox.h"
+#include "RiskMetrics.h"
+#include "ThreadPool.h"
+
+namespace {
+
+// Scenarios per parallel chunk; large enough to amortize the task cost
+constexpr size_t kChunk = 2048;
+
+size_t tailCount(size_t scenarios, double alpha) {
+    double k = std::ceil((1.0 - alpha) * scenarios - 1e-9);
+    return std::clamp<size_t>(static_cast<size_t>(k), 1, scenarios);
+}
+
+// Losses -r_s'w for every scenario
+void allLosses(MatrixView R, const double* w, std::vector<double>& loss, ThreadPool& pool) {
+    size_t S = R.rows(), N = R.cols();
+    loss.resize(S);
+    size_t chunks = (S + kChunk - 1) / kChunk;
+    pool.parallelFor(chunks, [&](size_t c) {
+        size_t end = std::min(S, (c + 1) * kChunk);
+        for (size_t s = c * kChunk; s < end; s++)
+            loss[s] = -dotProduct(R.rowPtr(s), w, N);
+    });
+}
+
+// Huber-smoothed hinge and its derivative
+inline double huber(double x, double mu) {
+    if (x <= 0.0) return 0.0;
+    if (x >= mu) return x - 0.5 * mu;
+    return 0.5 * x * x / mu;
+}
+inline double huberSlope(double x, double mu) {
+    return std::clamp(x / mu, 0.0, 1.0);
+}
+
+// The z minimizing z + scale * sum h(l - z) for fixed losses: the root
+// of the decreasing scale * sum h'(l - z) = 1, bracketed by the tail-th
+// largest loss (minus mu) and the largest, and found by bisection over
+// the few losses above the bracket
+double bestZ(const std::vector<double>& l, double mu, double scale, size_t tail,
+             std::vector<double>& buf) {
+    buf = l;
+    std::nth_element(buf.begin(), buf.begin() + (tail - 1), buf.end(), std::greater<double>());
+    double lo = buf[tail - 1] - mu;
+    double hi = *std::max_element(buf.begin(), buf.begin() + tail);
+    size_t m = 0;
+    for (double v : l)
+        if (v > lo) buf[m++] = v;
+    for (int it = 0; it < 60 && hi - lo > 1e-14 * (std::abs(hi) + mu); it++) {
+        double z = 0.5 * (lo + hi), slope = 0.0;
+        for (size_t k = 0; k < m; k++) slope += huberSlope(buf[k] - z, mu);
+        (slope * scale > 1.0 ? lo : hi) = z;
+    }
+    return 0.5 * (lo + hi);
+}
+
+// Smoothed objective over a working set. Losses are kept per iterate
+// so the FISTA extrapolation point costs no product: l(y) is the same
+// combination of l(w_k) and l(w_{k-1}) as y is of the weights.
+class WorkingSetObjective {
+public:
+    WorkingSetObjective(MatrixView R, const std::vector<size_t>& rows, double scale,
+                        ThreadPool& pool)
+        : R(R), rows(rows), scale(scale), pool(pool) {
+        chunks = std::max<size_t>(1, (rows.size() + kChunk - 1) / kChunk);
+        partial.assign(chunks, std::vector<double>(R.cols() + 1, 0.0));
+    }
+
+    size_t size() const { return rows.size(); }
+
+    // out[k] = -r_k'w over the working set
+    void losses(const double* w, double* out) {
+        size_t N = R.cols();
+        pool.parallelFor(chunks, [&](size_t c) {
+            size_t end = std::min(rows.size(), (c + 1) * kChunk);
+            for (size_t k = c * kChunk; k < end; k++)
+                out[k] = -dotProduct(R.rowPtr(rows[k]), w, N);
+        });
+    }
+
+    double value(const std::vector<double>& l, double z, double mu) const {
+        double f = 0.0;
+        for (double v : l) f += huber(v - z, mu);
+        return z + scale * f;
+    }
+
+    // Gradient in w (the last entry, d/dz, is zero at bestZ); only
+    // scenarios past z contribute
+    void gradient(const std::vector<double>& l, double z, double mu, std::vector<double>& grad) {
+        size_t N = R.cols();
+        pool.parallelFor(chunks, [&](size_t c) {
+            std::vector<double>& g = partial[c];
+            std::fill(g.begin(), g.end(), 0.0);
+            size_t end = std::min(rows.size(), (c + 1) * kChunk);
+            for (size_t k = c * kChunk; k < end; k++) {
+                double x = l[k] - z;
+                if (x <= 0.0) continue;
+                double h = huberSlope(x, mu);
+                const double* r = R.rowPtr(rows[k]);
+                for (size_t i = 0; i < N; i++) g[i] -= h * r[i];
+                g[N] -= h;
+            }
+        });
+        grad.assign(N + 1, 0.0);
+        for (const auto& g : partial)
+            for (size_t i = 0; i <= N; i++) grad[i] += g[i];
+        for (double& v : grad) v *= scale;
+        grad[N] += 1.0;
+    }
+
+private:
+    MatrixView R;
+    const std::vector<size_t>& rows;
+    double scale;
+    ThreadPool& pool;
+    size_t chunks;
+    std::vector<std::vector<double>> partial;
+};
+
+}
+
+CVaRResult CVaROptimizer::minimize(MatrixView R, const CVaRSettings& st, ThreadPool& pool) {
+    const size_t S = R.rows(), N = R.cols();
+    if (S == 0 || N == 0)
+        throw std::invalid_argument("CVaR needs at least one scenario and one asset");
+    if (!R.rowsContiguous())
+        throw std::invalid_argument("CVaR scenarios must have contiguous rows");
+    if (!(st.alpha > 0.0 && st.alpha < 1.0))
+        throw std::invalid_argument("alpha must be in (0, 1)");
+    double cap = std::min(st.maxWeight, 1.0);
+    if (cap * N < 1.0 - 1e-12)
+        throw std::invalid_argument("max_weight too small for a fully invested portfolio");
+
+    const double scale = 1.0 / ((1.0 - st.alpha) * S);
+    const size_t tail = tailCount(S, st.alpha);
+    const size_t setSize = std::min(S, std::max<size_t>(
+        static_cast<size_t>(st.workingSetFactor * tail), tail + 256));
+
+    CVaRResult result;
+    std::vector<double> w(N, 1.0 / N);
+    std::vector<double> loss, scratch;
+    allLosses(R, w.data(), loss, pool);
+
+    // Smoothing widths are relative to the spread of equal-weight losses
+    double mean = std::accumulate(loss.begin(), loss.end(), 0.0) / S;
+    double spread = 0.0;
+    for (double l : loss) spread += (l - mean) * (l - mean);
+    spread = std::sqrt(spread / S);
+    if (!(spread > 0.0)) spread = 1e-8;
+    const double muFinal = 1e-3 * spread;
+
+    std::vector<size_t> rows(S), order;
+    std::vector<char> inSet(S, 0);
+    std::vector<double> gradY, gradW, wNext(N), wy(N), zbuf;
+    std::vector<std::pair<double, int>> breakpoints;
+    double L = 1.0;
+    int iterations = 0;
+
+    for (int round = 1; ; round++) {
+        result.rounds = round;
+
+        // ---- Working set: grows by the setSize largest losses ----
+        // Earlier rows stay, so two corners whose tails are each
+        // missing from the other's set cannot alternate forever
+        std::iota(rows.begin(), rows.end(), 0);
+        std::nth_element(rows.begin(), rows.begin() + (setSize - 1), rows.end(),
+                         [&](size_t a, size_t b) { return loss[a] > loss[b]; });
+        for (size_t k = 0; k < setSize; k++) inSet[rows[k]] = 1;
+        std::vector<size_t> set;
+        for (size_t s = 0; s < S; s++)  // scenario order for locality
+            if (inSet[s]) set.push_back(s);
+        WorkingSetObjective obj(R, set, scale, pool);
+
+        // ---- FISTA over w with z eliminated, continuation on mu ----
+        // z is re-solved exactly at every point, which removes the badly
+        // scaled z direction from the iteration
+        double mu = round == 1 ? 0.1 * spread : muFinal;
+        std::vector<double> lw(set.size()), ly(set.size()), lNext(set.size());
+        obj.losses(w.data(), lw.data());
+        ly = lw;
+        wy = w;
+        double z = bestZ(lw, mu, scale, tail, zbuf), zy = z;
+        double fPrev = obj.value(lw, z, mu);
+        double t = 1.0;
+
+        while (iterations < st.maxIter) {
+            iterations++;
+            double fy = obj.value(ly, zy, mu);
+            obj.gradient(ly, zy, mu, gradY);
+
+            // Backtracking: let L shrink a little, then grow until the
+            // quadratic upper bound holds
+            L *= 0.8;
+            double fNext = 0.0, zNext = 0.0;
+            for (int bt = 0; bt < 60; bt++) {
+                for (size_t i = 0; i < N; i++) wNext[i] = wy[i] - gradY[i] / L;
+                OptimizerUtils::projectCappedSimplex(wNext.data(), N, cap, breakpoints);
+
+                double lin = 0.0, sq = 0.0;
+                for (size_t i = 0; i < N; i++) {
+                    double d = wNext[i] - wy[i];
+                    lin += gradY[i] * d;
+                    sq += d * d;
+                }
+                obj.losses(wNext.data(), lNext.data());
+                zNext = bestZ(lNext, mu, scale, tail, zbuf);
+                fNext = obj.value(lNext, zNext, mu);
+                if (fNext <= fy + lin + 0.5 * L * sq + 1e-15 * std::abs(fy)) break;
+                L *= 2.0;
+            }
+
+            // Gradient restart when the objective goes up
+            if (fNext > fPrev) t = 1.0;
+            double tNext = 0.5 * (1.0 + std::sqrt(1.0 + 4.0 * t * t));
+            double beta = (t - 1.0) / tNext;
+            t = tNext;
+
+            for (size_t i = 0; i < N; i++) wy[i] = wNext[i] + beta * (wNext[i] - w[i]);
+            for (size_t k = 0; k < set.size(); k++) ly[k] = lNext[k] + beta * (lNext[k] - lw[k]);
+            w.swap(wNext);
+            lw.swap(lNext);
+            z = zNext;
+            zy = bestZ(ly, mu, scale, tail, zbuf);
+            fPrev = fNext;
+
+            // Frank-Wolfe gap at w; intermediate widths only need a rough solve
+            if (iterations % 10 != 0) continue;
+            obj.gradient(lw, z, mu, gradW);
+            double gap = OptimizerUtils::cappedSimplexGap(gradW.data(), w.data(), N, cap, order);
+            double stageTol = mu <= muFinal ? st.tol : 10.0 * st.tol;
+            if (gap > stageTol * (std::abs(fNext) + spread)) continue;
+
+            if (mu <= muFinal) break;
+            mu = std::max(mu * 0.2, muFinal);
+            L /= 0.2;  // curvature scales with 1 / mu
+            t = 1.0;
+            wy = w;
+            ly = lw;
+            z = zy = bestZ(lw, mu, scale, tail, zbuf);
+            fPrev = obj.value(lw, z, mu);
+        }
+
+        // ---- Full pass: is the exact tail inside the working set? ----
+        allLosses(R, w.data(), loss, pool);
+        scratch = loss;
+        RiskMetrics::lossTail(scratch, st.alpha, result.var, result.cvar);
+
+        bool covered = true;
+        for (size_t s = 0; s < S && covered; s++)
+            if (!inSet[s] && loss[s] > result.var) covered = false;
+
+        result.workingSet = set.size();
+        if (covered) {
+            result.converged = iterations < st.maxIter;
+            break;
+        }
+        if (iterations >= st.maxIter) break;
+    }
+
+    result.iterations = iterations;
+    double ret = 0.0;
+    for (double l : loss) ret -= l;
+    result.expectedReturn = ret / S;
+    result.weights = std::move(w);
+    return result;
+}
+
+Matrix CVaROptimizer::simulateScenarios(const std::vector<double>& mu,
+                                        const CholeskyFactor& factor,
+                                        size_t count, uint64_t seed,
+                                        ThreadPool& pool) {
+    const Matrix& U = factor.upper();
+    size_t N = mu.size();
+    if (U.rows() != N)
+        throw std::invalid_argument("factor and mean sizes differ");
+
+    Matrix out(count, N);
+    const Philox4x32 rng(seed);
+    const size_t zStride = 2 * ((N + 1) / 2);
+    size_t blocks = (count + kChunk - 1) / kChunk;
+    pool.parallelFor(blocks, [&](size_t b) {
+        std::vector<double> z(zStride);
+        std::vector<uint64_t> scratch(zStride);
+        size_t end = std::min(count, (b + 1) * kChunk);
+        for (size_t s = b * kChunk; s < end; s++) {
+            rng.normals(s, 0, N, z.data(), scratch.data());
+            // r = mu + U'z, accumulated over the rows of U
+            double* r = out.rowPtr(s);
+            std::copy(mu.begin(), mu.end(), r);
+            for (size_t k = 0; k < N; k++) {
+                const double* uk = U.rowPtr(k);
+                double zk = z[k];
+                for (size_t i = k; i < N; i++) r[i] += uk[i] * zk;
+            }
+        }
+    });
+    return out;
+}
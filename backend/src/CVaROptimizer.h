@@ -0,0 +1,60 @@
+#ifndef CVAR_OPTIMIZER_H
+#define CVAR_OPTIMIZER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Matrix.h"
+
+class CholeskyFactor;
+class ThreadPool;
+
+struct CVaRSettings {
+    double alpha = 0.95;         // tail probability level
+    double maxWeight = 1.0;      // long-only, w_i <= maxWeight, sum w = 1
+    int maxIter = 2000;          // FISTA iterations over all rounds
+    double tol = 1e-3;           // Frank-Wolfe gap relative to the objective
+    double workingSetFactor = 2; // working set = factor x tail scenarios
+};
+
+struct CVaRResult {
+    std::vector<double> weights;
+    double cvar = 0.0;           // expected loss beyond VaR, per scenario period
+    double var = 0.0;            // RiskMetrics::tailRank convention
+    double expectedReturn = 0.0; // mean scenario return of the portfolio
+    int iterations = 0;
+    int rounds = 0;              // full scenario passes to settle the tail
+    size_t workingSet = 0;
+    bool converged = false;
+};
+
+// Minimum-CVaR portfolio over scenario returns (rows = scenarios), by
+// the Rockafellar-Uryasev formulation
+//
+//   min_{w, z}  z + 1 / ((1 - alpha) S) * sum_s max(0, -r_s'w - z)
+//
+// with the hinge Huber-smoothed and solved by FISTA over w (backtracking
+// step, gradient restart) while the smoothing width shrinks; z is
+// minimized exactly at every point, a 1-D root on the tail losses.
+// Only scenarios in the loss tail carry gradient, so the inner solve
+// runs on a working set of the highest-loss scenarios; a full pass then
+// checks that the true tail is still inside it and otherwise grows it.
+// Memory beyond the scenario matrix is O(S) plus one gradient buffer per
+// 2048-scenario chunk of the working set; passes run chunked on the pool.
+class CVaROptimizer {
+public:
+    static CVaRResult minimize(MatrixView scenarios,
+                               const CVaRSettings& settings,
+                               ThreadPool& pool);
+
+    // count draws of mu + U'z, z ~ N(0, I), from the covariance factor;
+    // scenario s takes Philox normals keyed by (seed, s), so the output
+    // depends only on seed, not on the thread count or standard library
+    static Matrix simulateScenarios(const std::vector<double>& mu,
+                                    const CholeskyFactor& factor,
+                                    size_t count, uint64_t seed,
+                                    ThreadPool& pool);
+};
+
+#endif
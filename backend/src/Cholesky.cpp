@@ -0,0 +1,148 @@
+#include "Cholesky.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+
+// Right-looking factorization in place on the upper triangle of A.
+// Returns false on a non-positive pivot.
+bool factorUpper(Matrix& A) {
+    size_t n = A.rows();
+    for (size_t k = 0; k < n; k++) {
+        double* rk = A.rowPtr(k);
+        double pivot = rk[k];
+        if (!(pivot > 0.0)) return false;
+
+        double d = std::sqrt(pivot);
+        rk[k] = d;
+        double inv = 1.0 / d;
+        for (size_t j = k + 1; j < n; j++) rk[j] *= inv;
+
+        // Trailing update A(i, i:) -= U(k, i) * U(k, i:)
+        for (size_t i = k + 1; i < n; i++) {
+            double f = rk[i];
+            if (f == 0.0) continue;
+            double* ri = A.rowPtr(i);
+            for (size_t j = i; j < n; j++) ri[j] -= f * rk[j];
+        }
+    }
+
+    for (size_t i = 1; i < n; i++)
+        std::fill(A.rowPtr(i), A.rowPtr(i) + i, 0.0);
+    return true;
+}
+
+}
+
+CholeskyFactor CholeskyFactor::factor(MatrixView cov, double ridge) {
+    size_t n = cov.rows();
+    if (cov.cols() != n)
+        throw std::invalid_argument("Cholesky needs a square matrix");
+
+    double meanVar = 0.0;
+    for (size_t i = 0; i < n; i++) meanVar += cov(i, i);
+    meanVar = n ? std::abs(meanVar) / n : 0.0;
+    double step = std::max(meanVar * 1e-10, 1e-300);
+
+    CholeskyFactor f;
+    for (int attempt = 0; attempt < 12; attempt++) {
+        f.U = Matrix(n, n);
+        for (size_t i = 0; i < n; i++) {
+            double* row = f.U.rowPtr(i);
+            for (size_t j = i; j < n; j++) row[j] = cov(i, j);
+            row[i] += ridge;
+        }
+
+        if (factorUpper(f.U)) {
+            f.ridge_ = ridge;
+            return f;
+        }
+        ridge = std::max(ridge * 10.0, step);
+        step *= 10.0;
+    }
+    throw std::runtime_error("Covariance is not positive definite");
+}
+
+void CholeskyFactor::forwardSolve(double* b) const {
+    size_t n = U.rows();
+    for (size_t k = 0; k < n; k++) {
+        const double* rk = U.rowPtr(k);
+        double y = b[k] / rk[k];
+        b[k] = y;
+        for (size_t i = k + 1; i < n; i++) b[i] -= y * rk[i];
+    }
+}
+
+void CholeskyFactor::backSolve(double* y) const {
+    size_t n = U.rows();
+    for (size_t k = n; k-- > 0;) {
+        const double* rk = U.rowPtr(k);
+        double s = y[k] - dotProduct(rk + k + 1, y + k + 1, n - k - 1);
+        y[k] = s / rk[k];
+    }
+}
+
+std::vector<double> CholeskyFactor::solve(const std::vector<double>& b) const {
+    std::vector<double> x = b;
+    forwardSolve(x.data());
+    backSolve(x.data());
+    return x;
+}
+
+double CholeskyFactor::inverseQuadratic(const std::vector<double>& b) const {
+    std::vector<double> y = b;
+    forwardSolve(y.data());
+    return dotProduct(y.data(), y.data(), y.size());
+}
+
+double CholeskyFactor::logDeterminant() const {
+    double s = 0.0;
+    for (size_t i = 0; i < U.rows(); i++) s += std::log(U(i, i));
+    return 2.0 * s;
+}
+
+void CholeskyFactor::scale(double alpha) {
+    if (!(alpha > 0.0))
+        throw std::invalid_argument("Cholesky scale must be positive");
+    double r = std::sqrt(alpha);
+    for (size_t i = 0; i < U.size(); i++) U.data()[i] *= r;
+    ridge_ *= alpha;
+}
+
+void CholeskyFactor::update(std::vector<double> x) {
+    size_t n = U.rows();
+    for (size_t k = 0; k < n; k++) {
+        double* rk = U.rowPtr(k);
+        double r = std::hypot(rk[k], x[k]);
+        double c = r / rk[k];
+        double s = x[k] / rk[k];
+        rk[k] = r;
+        for (size_t i = k + 1; i < n; i++) {
+            rk[i] = (rk[i] + s * x[i]) / c;
+            x[i] = c * x[i] - s * rk[i];
+        }
+    }
+}
+
+bool CholeskyFactor::downdate(std::vector<double> x) {
+    // Feasible iff |U^{-T} x| < 1; check before touching the factor
+    std::vector<double> p = x;
+    forwardSolve(p.data());
+    if (dotProduct(p.data(), p.data(), p.size()) >= 1.0 - 1e-12) return false;
+
+    size_t n = U.rows();
+    for (size_t k = 0; k < n; k++) {
+        double* rk = U.rowPtr(k);
+        double r = std::sqrt((rk[k] - x[k]) * (rk[k] + x[k]));
+        double c = r / rk[k];
+        double s = x[k] / rk[k];
+        rk[k] = r;
+        for (size_t i = k + 1; i < n; i++) {
+            rk[i] = (rk[i] - s * x[i]) / c;
+            x[i] = c * x[i] - s * rk[i];
+        }
+    }
+    return true;
+}
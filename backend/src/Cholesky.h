@@ -0,0 +1,61 @@
+#ifndef CHOLESKY_H
+#define CHOLESKY_H
+
+#include <vector>
+
+#include "Matrix.h"
+
+// Cholesky factorization  Sigma + ridge*I = U^T U  of a covariance.
+//
+// U is upper triangular and stored row-major, so every inner loop
+// (factorization, both triangular solves, rank-1 update and downdate)
+// walks contiguous rows. Callers solve through the factor and never form
+// an inverse.
+class CholeskyFactor {
+public:
+    CholeskyFactor() = default;
+
+    // Factors cov + ridge*I. If a pivot is not positive the ridge is
+    // raised (starting from 1e-10 of the mean variance) and the
+    // factorization retried; throws std::runtime_error if that still
+    // fails, e.g. for a matrix with NaNs.
+    static CholeskyFactor factor(MatrixView cov, double ridge = 0.0);
+
+    size_t size() const { return U.rows(); }
+    bool empty() const { return U.rows() == 0; }
+
+    // Diagonal regularization folded into the factor
+    double ridge() const { return ridge_; }
+
+    const Matrix& upper() const { return U; }
+
+    // Sigma^{-1} b
+    std::vector<double> solve(const std::vector<double>& b) const;
+
+    // In place: U^T y = b (forward), then U x = y (backward)
+    void forwardSolve(double* b) const;
+    void backSolve(double* y) const;
+
+    // b^T Sigma^{-1} b = |U^{-T} b|^2
+    double inverseQuadratic(const std::vector<double>& b) const;
+
+    double logDeterminant() const;
+
+    // ---- O(N^2) modifications ----
+
+    // Sigma -> alpha * Sigma
+    void scale(double alpha);
+
+    // Sigma -> Sigma + x x^T
+    void update(std::vector<double> x);
+
+    // Sigma -> Sigma - x x^T. Returns false, leaving the factor
+    // untouched, when the result would not be positive definite.
+    bool downdate(std::vector<double> x);
+
+private:
+    Matrix U;
+    double ridge_ = 0.0;
+};
+
+#endif
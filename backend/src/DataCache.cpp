@@ -1,25 +1,336 @@
 #include "DataCache.h"
 #include "Statistics.h"
+#include "data/CSVLoader.h"
+#include "data/MarketDataService.h"
+#include "data/SnapshotFile.h"
+
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+
+namespace {
+
+std::shared_ptr<RowStore> makeStore(const double* data, size_t rows, size_t cols) {
+    auto store = std::make_shared<RowStore>();
+    size_t capacity = rows + std::max<size_t>(64, rows / 8);
+    store->rows = Matrix(capacity, cols);
+    if (data) std::copy(data, data + rows * cols, store->rows.data());
+    store->used = rows;
+    return store;
+}
+
+// Appends row after the first `rows` rows. Reuses the store when there is
+// spare capacity; readers of older snapshots never look past their rows.
+std::shared_ptr<RowStore> appendTo(const std::shared_ptr<RowStore>& store,
+                                   size_t rows, size_t cols, const double* row) {
+    std::shared_ptr<RowStore> out = store;
+    if (!store || store->used != rows || rows == store->rows.rows()) {
+        out = std::make_shared<RowStore>();
+        out->rows = Matrix(std::max<size_t>(64, rows * 2), cols);
+        if (store) std::copy(store->rows.data(), store->rows.data() + rows * cols,
+                             out->rows.data());
+    }
+    std::copy(row, row + cols, out->rows.rowPtr(rows));
+    out->used = rows + 1;
+    return out;
+}
+
+}
+
+std::shared_ptr<const CholeskyFactor> MarketSnapshot::cholesky() const {
+    std::lock_guard<std::mutex> lock(cholesky_->mtx);
+    if (!cholesky_->factor)
+        cholesky_->factor = std::make_shared<CholeskyFactor>(CholeskyFactor::factor(cov_));
+    return cholesky_->factor;
+}
 
 DataCache& DataCache::instance() {
     static DataCache cache;
     return cache;
 }
 
+DataCache::~DataCache() {
+    stopWatching();
+}
+
+SnapshotPtr DataCache::snapshot() const {
+    return std::atomic_load(&current);
+}
+
+void DataCache::publish(std::shared_ptr<MarketSnapshot> next) {
+    next->version_ = ++version_;
+    std::atomic_store(&current, SnapshotPtr(std::move(next)));
+}
+
 void DataCache::loadIfNeeded() {
-    std::lock_guard<std::mutex> lock(mtx);
+    if (snapshot()) return;
+
+    std::lock_guard<std::mutex> lock(writeMtx);
+    if (snapshot()) return;
 
-    if (loaded) return;
+    const std::string snapshotPath = sourcePath + ".snap";
 
-    prices_ = Statistics::readCSV("../backend/data/prices.csv");
-    returns_ = Statistics::computeReturns(prices_);
-    mean_ = Statistics::computeReturnsMean(returns_);
-    cov_ = Statistics::computeCovariance(returns_, mean_);
+    auto next = loadSnapshotFile(snapshotPath);
+    if (!next) {
+        // Stamp the CSV before parsing it: if it changes while we load,
+        // the stored hash will not match and the next start reloads.
+        SnapshotSource source = SnapshotSource::of(sourcePath, true);
+        next = loadSource();
+        writeSnapshotFile(snapshotPath, *next, source);
+    }
 
-    loaded = true;
+    publish(std::move(next));
 }
 
-const std::vector<std::vector<double>>& DataCache::prices() const { return prices_; }
-const std::vector<std::vector<double>>& DataCache::returns() const { return returns_; }
-const std::vector<double>& DataCache::mean() const { return mean_; }
-const std::vector<std::vector<double>>& DataCache::cov() const { return cov_; }
\ No newline at end of file
+uint64_t DataCache::reload() {
+    std::lock_guard<std::mutex> lock(writeMtx);
+
+    const std::string snapshotPath = sourcePath + ".snap";
+
+    auto next = loadSnapshotFile(snapshotPath);
+    if (!next) {
+        SnapshotSource source = SnapshotSource::of(sourcePath, true);
+        next = loadSource();
+        if (next->priceRows_ == 0 && snapshot()) {
+            std::cerr << "Reload of " << sourcePath << " failed, keeping version "
+                      << version_.load() << "\n";
+            return version_.load();
+        }
+        writeSnapshotFile(snapshotPath, *next, source);
+    }
+
+    publish(std::move(next));
+    replayAppended();
+    return version_.load();
+}
+
+void DataCache::replayAppended() {
+    if (appended.empty()) return;
+
+    SnapshotPtr snap = snapshot();
+    const std::string last = snap->dates_.empty() ? std::string() : snap->dates_.back();
+    size_t cols = snap->priceRows_ ? snap->prices_->rows.cols() : 0;
+
+    std::vector<AppendedBar> kept;
+    for (auto& bar : appended) {
+        if (!bar.date.empty() && bar.date <= last) continue;  // in the source now
+        if (cols && bar.row.size() != cols) {
+            std::cerr << sourcePath << " now has " << cols << " symbols, dropping "
+                      << appended.size() << " appended bars\n";
+            appended.clear();
+            return;
+        }
+        appendLocked(bar.row, bar.date);
+        kept.push_back(std::move(bar));
+    }
+    appended = std::move(kept);
+}
+
+void DataCache::appendPrices(const std::vector<double>& row,
+                             const std::string& date) {
+    std::lock_guard<std::mutex> lock(writeMtx);
+    appendLocked(row, date);
+    appended.push_back({ row, date });
+}
+
+void DataCache::appendLocked(const std::vector<double>& row,
+                             const std::string& date) {
+    SnapshotPtr prev = snapshot();
+    auto next = prev ? std::make_shared<MarketSnapshot>(*prev)
+                     : std::make_shared<MarketSnapshot>();
+
+    size_t N = row.size();
+    if (next->priceRows_ > 0 && N != next->prices_->rows.cols())
+        throw std::invalid_argument(
+            "expected " + std::to_string(next->prices_->rows.cols()) +
+            " prices, got " + std::to_string(N));
+
+    next->prices_ = appendTo(next->prices_, next->priceRows_, N, row.data());
+    next->priceRows_++;
+    next->dates_.push_back(date);
+
+    size_t T = next->priceRows_;
+    if (T >= 2) {
+        const double* last = next->prices_->rows.rowPtr(T - 2);
+        std::vector<double> r(N);
+        for (size_t i = 0; i < N; i++)
+            r[i] = (row[i] - last[i]) / last[i];
+
+        if (next->returnRows_ == 0) next->mean_.assign(N, 0.0);
+
+        // cov' = keep * cov + d d^T / (n + 1) with d = r - mean (see
+        // appendObservation), so the factor follows in O(N^2)
+        std::shared_ptr<const CholeskyFactor> prevFactor;
+        if (prev) {
+            std::lock_guard<std::mutex> factorLock(prev->cholesky_->mtx);
+            prevFactor = prev->cholesky_->factor;
+        }
+        size_t n = next->returnRows_;
+        std::shared_ptr<CholeskyFactor> factor;
+        if (prevFactor && n >= 2) {
+            factor = std::make_shared<CholeskyFactor>(*prevFactor);
+            double add = 1.0 / std::sqrt(static_cast<double>(n + 1));
+            std::vector<double> d(N);
+            for (size_t i = 0; i < N; i++) d[i] = (r[i] - next->mean_[i]) * add;
+            factor->scale((n - 1.0) / n);
+            factor->update(std::move(d));
+        }
+
+        Statistics::appendObservation(r.data(), next->returnRows_,
+                                      next->mean_, next->cov_);
+        next->returns_ = appendTo(next->returns_, next->returnRows_, N, r.data());
+        next->returnRows_++;
+
+        next->cholesky_ = std::make_shared<MarketSnapshot::CholeskySlot>();
+        next->cholesky_->factor = std::move(factor);
+    } else {
+        next->cholesky_ = std::make_shared<MarketSnapshot::CholeskySlot>();
+    }
+
+    publish(std::move(next));
+}
+
+std::shared_ptr<MarketSnapshot>
+DataCache::loadSnapshotFile(const std::string& snapshotPath) {
+    SnapshotFile file;
+    if (!file.open(snapshotPath, sourcePath)) return nullptr;
+
+    size_t T = file.rows();
+    size_t N = file.cols();
+
+    auto snap = std::make_shared<MarketSnapshot>();
+    snap->prices_ = makeStore(file.prices(), T, N);
+    snap->priceRows_ = T;
+    snap->returns_ = makeStore(file.returns(), file.returnRows(), N);
+    snap->returnRows_ = file.returnRows();
+
+    if (file.mean()) snap->mean_.assign(file.mean(), file.mean() + N);
+    if (file.cov()) {
+        snap->cov_ = Matrix(N, N);
+        std::copy(file.cov(), file.cov() + N * N, snap->cov_.data());
+    }
+
+    snap->symbols_ = file.symbols();
+    snap->dates_ = file.dates();
+    return snap;
+}
+
+std::shared_ptr<MarketSnapshot> DataCache::loadSource() {
+    auto snap = std::make_shared<MarketSnapshot>();
+
+    // Either source ends up as one row-major block of prices
+    PriceTable table;
+    PriceFrame frame;
+    const double* values = nullptr;
+    size_t T = 0, N = 0;
+
+    if (std::filesystem::is_directory(sourcePath)) {
+        try {
+            frame = MarketDataService::forSource(sourcePath, missingBars).loadFrame({});
+        } catch (const std::exception& e) {
+            std::cerr << sourcePath << ": " << e.what() << "\n";
+            return snap;
+        }
+        values = frame.prices.data();
+        T = frame.prices.rows();
+        N = frame.prices.cols();
+        snap->symbols_ = std::move(frame.symbols);
+        snap->dates_ = std::move(frame.dates);
+    } else {
+        table = CSVLoader::load(sourcePath);
+        if (!table.ok()) {
+            for (const auto& e : table.errors)
+                std::cerr << sourcePath << ":" << e.line << ":" << e.column
+                          << ": " << e.message << "\n";
+            return snap;
+        }
+        values = table.values.data();
+        T = table.rows;
+        N = table.cols;
+        snap->symbols_ = std::move(table.symbols);
+        snap->dates_ = std::move(table.dates);
+    }
+
+    if (T == 0) return snap;
+
+    snap->prices_ = makeStore(values, T, N);
+    snap->priceRows_ = T;
+
+    Matrix returns = Statistics::computeReturns(snap->prices());
+    snap->returns_ = makeStore(returns.data(), returns.rows(), N);
+    snap->returnRows_ = returns.rows();
+
+    snap->mean_ = Statistics::computeReturnsMean(snap->returns());
+    snap->cov_ = Statistics::computeCovariance(snap->returns(), snap->mean_);
+    return snap;
+}
+
+void DataCache::writeSnapshotFile(const std::string& snapshotPath,
+                                  const MarketSnapshot& snap,
+                                  const SnapshotSource& source) {
+    if (snap.priceRows_ == 0) return;
+
+    SnapshotContents c;
+    c.symbols = &snap.symbols_;
+    c.dates = &snap.dates_;
+    c.rows = snap.priceRows_;
+    c.cols = snap.prices_->rows.cols();
+    c.returnRows = snap.returnRows_;
+    c.prices = snap.prices_->rows.data();
+    c.returns = snap.returnRows_ ? snap.returns_->rows.data() : nullptr;
+    c.mean = snap.mean_.empty() ? nullptr : snap.mean_.data();
+    c.cov = snap.cov_.empty() ? nullptr : snap.cov_.data();
+
+    if (!SnapshotFile::write(snapshotPath, c, source))
+        std::cerr << "Failed to write snapshot " << snapshotPath << "\n";
+}
+
+void DataCache::setSource(std::string path, MissingBarPolicy policy) {
+    if (policy == MissingBarPolicy::Mask)
+        throw std::invalid_argument("masked missing bars are not supported for the market data cache");
+
+    std::lock_guard<std::mutex> lock(writeMtx);
+    sourcePath = std::move(path);
+    missingBars = policy;
+    appended.clear();
+}
+
+void DataCache::startWatching(std::chrono::milliseconds interval) {
+    std::lock_guard<std::mutex> lock(watchMtx);
+    if (watching) return;
+    watching = true;
+
+    watcher = std::thread([this, interval] {
+        // setSource may swap the path under writeMtx at any time
+        auto currentPath = [this] {
+            std::lock_guard<std::mutex> pathLock(writeMtx);
+            return sourcePath;
+        };
+        SnapshotSource seen = SnapshotSource::of(currentPath(), false);
+
+        std::unique_lock<std::mutex> lock(watchMtx);
+        while (!watchCv.wait_for(lock, interval, [this] { return !watching; })) {
+            std::string path = currentPath();
+            SnapshotSource now = SnapshotSource::of(path, false);
+            if (now.size == seen.size && now.mtime == seen.mtime) continue;
+            seen = now;
+
+            lock.unlock();
+            uint64_t v = reload();
+            std::cout << path << " changed, now at version " << v << std::endl;
+            lock.lock();
+        }
+    });
+}
+
+void DataCache::stopWatching() {
+    {
+        std::lock_guard<std::mutex> lock(watchMtx);
+        if (!watching) return;
+        watching = false;
+    }
+    watchCv.notify_all();
+    if (watcher.joinable()) watcher.join();
+}
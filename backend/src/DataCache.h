@@ -1,26 +1,150 @@
 #pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
 #include <vector>
 #include <mutex>
+#include <string>
+#include <thread>
 
+#include "Cholesky.h"
+#include "Matrix.h"
+#include "data/DataProvider.h"
+
+struct SnapshotSource;
+
+// Append-only row storage shared by successive snapshots. Rows below the
+// row count a snapshot was published with are never written again; the
+// single writer appends past them or moves to a larger store.
+struct RowStore {
+    Matrix rows;      // capacity x cols
+    size_t used = 0;  // rows written so far (writer only)
+};
+
+// Immutable market data at one version. Handlers hold one for the whole
+// request and read it without locks.
+class MarketSnapshot {
+public:
+    uint64_t version() const { return version_; }
+
+    MatrixView prices() const { return view(prices_, priceRows_); }
+    MatrixView returns() const { return view(returns_, returnRows_); }
+    const std::vector<double>& mean() const { return mean_; }
+    const Matrix& cov() const { return cov_; }
+
+    const std::vector<std::string>& symbols() const { return symbols_; }
+    const std::vector<std::string>& dates() const { return dates_; }
+
+    // Cholesky factor of cov(), built on first use and shared by every
+    // reader of this version. An append derives the next version's
+    // factor by a rank-1 update when this one has been built.
+    std::shared_ptr<const CholeskyFactor> cholesky() const;
+
+private:
+    friend class DataCache;
+
+    struct CholeskySlot {
+        std::mutex mtx;
+        std::shared_ptr<const CholeskyFactor> factor;
+    };
+
+    static MatrixView view(const std::shared_ptr<RowStore>& s, size_t rows) {
+        return s ? s->rows.rowRange(0, rows) : MatrixView();
+    }
+
+    uint64_t version_ = 0;
+
+    std::shared_ptr<RowStore> prices_;
+    size_t priceRows_ = 0;
+    std::shared_ptr<RowStore> returns_;
+    size_t returnRows_ = 0;
+
+    std::vector<double> mean_;
+    Matrix cov_;
+    std::shared_ptr<CholeskySlot> cholesky_ = std::make_shared<CholeskySlot>();
+
+    std::vector<std::string> symbols_;
+    std::vector<std::string> dates_;
+};
+
+using SnapshotPtr = std::shared_ptr<const MarketSnapshot>;
+
+// Publishes MarketSnapshots RCU style: readers atomically load the current
+// pointer, writers (reload, append) build the next snapshot and swap it
+// in. An old snapshot is freed when its last reader drops it.
 class DataCache {
 public:
     static DataCache& instance();
 
+    // Loads from the binary snapshot next to the CSV when it is still
+    // fresh, otherwise parses the CSV and rewrites the snapshot.
     void loadIfNeeded();
 
-    const std::vector<std::vector<double>>& prices() const;
-    const std::vector<std::vector<double>>& returns() const;
-    const std::vector<double>& mean() const;
-    const std::vector<std::vector<double>>& cov() const;
+    // Current snapshot (never null after loadIfNeeded)
+    SnapshotPtr snapshot() const;
+
+    // Rebuilds from the source and publishes the result, then re-applies
+    // appended bars dated after the source's last row (undated ones
+    // always), so a reload during ingestion loses nothing. Returns the
+    // new version; on a failed load the current snapshot is kept.
+    uint64_t reload();
+
+    // Appends one price row (one value per symbol) and updates returns,
+    // mean and covariance incrementally in O(N^2). Bumps version(). The
+    // bar is also kept for reload() until the source catches up.
+    void appendPrices(const std::vector<double>& row,
+                      const std::string& date = "");
+
+    // Incremented on every load or append; results derived from the
+    // cache should be keyed on it.
+    uint64_t version() const { return version_.load(); }
+
+    const std::string& source() const { return sourcePath; }
+
+    // Wide "Date,SYM1,..." CSV or a directory of per-symbol files, merged
+    // on date with the given policy. Takes effect on the next load.
+    // MissingBarPolicy::Mask is rejected: its NaN prices would poison
+    // returns, covariance and the Cholesky factor.
+    void setSource(std::string path,
+                   MissingBarPolicy missingBars = MissingBarPolicy::ForwardFill);
+
+    // Polls the source and reloads when its size or mtime changes.
+    void startWatching(std::chrono::milliseconds interval);
+    void stopWatching();
+
+    ~DataCache();
 
 private:
     DataCache() = default;
 
-    bool loaded = false;
-    std::mutex mtx;
+    std::shared_ptr<MarketSnapshot> loadSnapshotFile(const std::string& snapshotPath);
+    std::shared_ptr<MarketSnapshot> loadSource();
+    void writeSnapshotFile(const std::string& snapshotPath,
+                           const MarketSnapshot& snap,
+                           const SnapshotSource& source);
+    void publish(std::shared_ptr<MarketSnapshot> next);
 
-    std::vector<std::vector<double>> prices_;
-    std::vector<std::vector<double>> returns_;
-    std::vector<double> mean_;
-    std::vector<std::vector<double>> cov_;
+    // Both called with writeMtx held
+    void appendLocked(const std::vector<double>& row, const std::string& date);
+    void replayAppended();
+
+    struct AppendedBar {
+        std::vector<double> row;
+        std::string date;
+    };
+
+    std::mutex writeMtx;
+    std::atomic<uint64_t> version_{0};
+    SnapshotPtr current;  // accessed only through std::atomic_load/store
+
+    std::string sourcePath = "../backend/data/prices.csv";
+    MissingBarPolicy missingBars = MissingBarPolicy::ForwardFill;
+    std::vector<AppendedBar> appended;  // not yet in the source
+
+    std::thread watcher;
+    std::mutex watchMtx;
+    std::condition_variable watchCv;
+    bool watching = false;
 };
@@ -0,0 +1,292 @@
+#include "FactorModel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+
+namespace {
+
+// Orthonormalizes the columns of A (rows x cols, row-major) in place with
+// modified Gram-Schmidt, run twice for stability.
+void orthonormalize(Matrix& A) {
+    size_t n = A.rows(), k = A.cols();
+    for (int pass = 0; pass < 2; pass++) {
+        for (size_t j = 0; j < k; j++) {
+            for (size_t p = 0; p < j; p++) {
+                double r = 0.0;
+                for (size_t i = 0; i < n; i++) r += A(i, p) * A(i, j);
+                for (size_t i = 0; i < n; i++) A(i, j) -= r * A(i, p);
+            }
+            double norm = 0.0;
+            for (size_t i = 0; i < n; i++) norm += A(i, j) * A(i, j);
+            norm = std::sqrt(norm);
+            if (norm < 1e-300) continue;
+            for (size_t i = 0; i < n; i++) A(i, j) /= norm;
+        }
+    }
+}
+
+// Cyclic Jacobi eigen-decomposition of a small symmetric matrix.
+// On return S is diagonal (eigenvalues) and V holds the eigenvectors.
+void jacobiEigen(Matrix& S, Matrix& V) {
+    size_t n = S.rows();
+    V = Matrix::identity(n);
+
+    for (int sweep = 0; sweep < 100; sweep++) {
+        double off = 0.0;
+        for (size_t i = 0; i < n; i++)
+            for (size_t j = i + 1; j < n; j++) off += S(i, j) * S(i, j);
+        if (off < 1e-30) break;
+
+        for (size_t p = 0; p < n; p++) {
+            for (size_t q = p + 1; q < n; q++) {
+                if (std::abs(S(p, q)) < 1e-300) continue;
+
+                double theta = (S(q, q) - S(p, p)) / (2.0 * S(p, q));
+                double t = (theta >= 0 ? 1.0 : -1.0) /
+                           (std::abs(theta) + std::sqrt(theta * theta + 1.0));
+                double c = 1.0 / std::sqrt(t * t + 1.0);
+                double s = t * c;
+
+                for (size_t k = 0; k < n; k++) {
+                    double skp = S(k, p), skq = S(k, q);
+                    S(k, p) = c * skp - s * skq;
+                    S(k, q) = s * skp + c * skq;
+                }
+                for (size_t k = 0; k < n; k++) {
+                    double spk = S(p, k), sqk = S(q, k);
+                    S(p, k) = c * spk - s * sqk;
+                    S(q, k) = s * spk + c * sqk;
+                }
+                for (size_t k = 0; k < n; k++) {
+                    double vkp = V(k, p), vkq = V(k, q);
+                    V(k, p) = c * vkp - s * vkq;
+                    V(k, q) = s * vkp + c * vkq;
+                }
+            }
+        }
+    }
+}
+
+}
+
+FactorModel FactorModel::fromReturns(MatrixView returns,
+                                     const std::vector<double>& means,
+                                     size_t factors,
+                                     int powerIterations,
+                                     uint64_t seed) {
+    size_t T = returns.rows();
+    size_t N = returns.cols();
+    if (T < 2 || N == 0)
+        throw std::invalid_argument("Factor model needs at least two observations");
+
+    size_t K = std::min({ factors, N, T - 1 });
+    if (K == 0)
+        throw std::invalid_argument("Factor model needs at least one factor");
+
+    size_t L = std::min({ K + 10, N, T });  // oversampled sketch width
+
+    // ---- X = de-meaned returns / sqrt(T - 1), so X^T X = sample cov ----
+    double scale = 1.0 / std::sqrt(static_cast<double>(T - 1));
+    Matrix X(T, N);
+    for (size_t t = 0; t < T; t++)
+        for (size_t i = 0; i < N; i++)
+            X(t, i) = (returns(t, i) - means[i]) * scale;
+
+    auto mulX = [&](const Matrix& Om) {         // X * Om : (T x N)(N x L)
+        Matrix Y(T, Om.cols());
+        for (size_t t = 0; t < T; t++) {
+            const double* x = X.rowPtr(t);
+            double* y = Y.rowPtr(t);
+            for (size_t i = 0; i < N; i++) {
+                const double* o = Om.rowPtr(i);
+                for (size_t c = 0; c < Om.cols(); c++) y[c] += x[i] * o[c];
+            }
+        }
+        return Y;
+    };
+    auto mulXt = [&](const Matrix& Y) {         // X^T * Y : (N x T)(T x L)
+        Matrix Z(N, Y.cols());
+        for (size_t t = 0; t < T; t++) {
+            const double* x = X.rowPtr(t);
+            const double* y = Y.rowPtr(t);
+            for (size_t i = 0; i < N; i++) {
+                double* z = Z.rowPtr(i);
+                for (size_t c = 0; c < Y.cols(); c++) z[c] += x[i] * y[c];
+            }
+        }
+        return Z;
+    };
+
+    // ---- Randomized range finder with power iterations ----
+    std::mt19937_64 gen(seed);
+    std::normal_distribution<double> normal(0.0, 1.0);
+    Matrix omega(N, L);
+    for (size_t i = 0; i < omega.size(); i++) omega.data()[i] = normal(gen);
+
+    Matrix Q = mulX(omega);
+    orthonormalize(Q);
+    for (int it = 0; it < powerIterations; it++) {
+        Matrix Z = mulXt(Q);
+        orthonormalize(Z);
+        Q = mulX(Z);
+        orthonormalize(Q);
+    }
+
+    // ---- Small problem: Z = X^T Q (N x L), eig(Z^T Z) ----
+    Matrix Z = mulXt(Q);
+    Matrix G(L, L);
+    for (size_t i = 0; i < N; i++) {
+        const double* z = Z.rowPtr(i);
+        for (size_t a = 0; a < L; a++)
+            for (size_t b = 0; b < L; b++) G(a, b) += z[a] * z[b];
+    }
+
+    Matrix W;
+    jacobiEigen(G, W);
+
+    std::vector<size_t> order(L);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(),
+              [&](size_t a, size_t b) { return G(a, a) > G(b, b); });
+
+    // Right singular vectors V = Z W / s, factor variances s^2
+    FactorModel m;
+    m.B = Matrix(N, K);
+    m.f.resize(K);
+    for (size_t k = 0; k < K; k++) {
+        size_t c = order[k];
+        double s2 = std::max(G(c, c), 0.0);
+        m.f[k] = s2;
+        double inv = s2 > 0 ? 1.0 / std::sqrt(s2) : 0.0;
+        for (size_t i = 0; i < N; i++) {
+            double v = 0.0;
+            for (size_t a = 0; a < L; a++) v += Z(i, a) * W(a, c);
+            m.B(i, k) = v * inv;
+        }
+    }
+
+    // ---- Residual variances: diag(Sigma) - diag(B F B^T), floored ----
+    m.d.assign(N, 0.0);
+    for (size_t t = 0; t < T; t++) {
+        const double* x = X.rowPtr(t);
+        for (size_t i = 0; i < N; i++) m.d[i] += x[i] * x[i];
+    }
+    for (size_t i = 0; i < N; i++) {
+        double total = m.d[i];
+        double explained = 0.0;
+        for (size_t k = 0; k < K; k++)
+            explained += m.B(i, k) * m.B(i, k) * m.f[k];
+        m.d[i] = std::max(total - explained, 1e-4 * total + 1e-12);
+    }
+
+    m.prepareSolve();
+    return m;
+}
+
+void FactorModel::prepareSolve() {
+    size_t N = B.rows(), K = B.cols();
+
+    // M = F^{-1} + B^T D^{-1} B, then M = L L^T
+    Matrix M(K, K);
+    for (size_t i = 0; i < N; i++) {
+        const double* b = B.rowPtr(i);
+        double w = 1.0 / d[i];
+        for (size_t a = 0; a < K; a++)
+            for (size_t c = 0; c < K; c++) M(a, c) += b[a] * w * b[c];
+    }
+    for (size_t k = 0; k < K; k++)
+        M(k, k) += f[k] > 0 ? 1.0 / f[k] : 1e12;
+
+    capL = Matrix(K, K);
+    for (size_t j = 0; j < K; j++) {
+        double s = M(j, j);
+        for (size_t p = 0; p < j; p++) s -= capL(j, p) * capL(j, p);
+        if (s <= 0) throw std::runtime_error("Factor model capacitance not positive definite");
+        capL(j, j) = std::sqrt(s);
+        for (size_t i = j + 1; i < K; i++) {
+            double v = M(i, j);
+            for (size_t p = 0; p < j; p++) v -= capL(i, p) * capL(j, p);
+            capL(i, j) = v / capL(j, j);
+        }
+    }
+}
+
+double FactorModel::variance(const std::vector<double>& w) const {
+    size_t N = B.rows(), K = B.cols();
+    std::vector<double> y(K, 0.0);  // B^T w
+    double specific = 0.0;
+    for (size_t i = 0; i < N; i++) {
+        const double* b = B.rowPtr(i);
+        for (size_t k = 0; k < K; k++) y[k] += b[k] * w[i];
+        specific += d[i] * w[i] * w[i];
+    }
+    double systematic = 0.0;
+    for (size_t k = 0; k < K; k++) systematic += f[k] * y[k] * y[k];
+    return systematic + specific;
+}
+
+std::vector<double> FactorModel::multiply(const std::vector<double>& x) const {
+    size_t N = B.rows(), K = B.cols();
+    std::vector<double> y(K, 0.0);
+    for (size_t i = 0; i < N; i++) {
+        const double* b = B.rowPtr(i);
+        for (size_t k = 0; k < K; k++) y[k] += b[k] * x[i];
+    }
+    for (size_t k = 0; k < K; k++) y[k] *= f[k];
+
+    std::vector<double> out(N);
+    for (size_t i = 0; i < N; i++)
+        out[i] = dotProduct(B.rowPtr(i), y.data(), K) + d[i] * x[i];
+    return out;
+}
+
+std::vector<double> FactorModel::solve(const std::vector<double>& rhs) const {
+    size_t N = B.rows(), K = B.cols();
+
+    // y = D^{-1} b,  z = B^T y
+    std::vector<double> y(N), z(K, 0.0);
+    for (size_t i = 0; i < N; i++) {
+        y[i] = rhs[i] / d[i];
+        const double* b = B.rowPtr(i);
+        for (size_t k = 0; k < K; k++) z[k] += b[k] * y[i];
+    }
+
+    // u = M^{-1} z via the K x K Cholesky factor
+    for (size_t i = 0; i < K; i++) {
+        double s = z[i];
+        for (size_t p = 0; p < i; p++) s -= capL(i, p) * z[p];
+        z[i] = s / capL(i, i);
+    }
+    for (size_t i = K; i-- > 0;) {
+        double s = z[i];
+        for (size_t p = i + 1; p < K; p++) s -= capL(p, i) * z[p];
+        z[i] = s / capL(i, i);
+    }
+
+    // x = y - D^{-1} B u
+    for (size_t i = 0; i < N; i++)
+        y[i] -= dotProduct(B.rowPtr(i), z.data(), K) / d[i];
+    return y;
+}
+
+Matrix FactorModel::dense() const {
+    size_t N = B.rows(), K = B.cols();
+    Matrix S(N, N);
+    for (size_t i = 0; i < N; i++) {
+        for (size_t j = i; j < N; j++) {
+            double v = 0.0;
+            for (size_t k = 0; k < K; k++) v += B(i, k) * f[k] * B(j, k);
+            if (i == j) v += d[i];
+            S(i, j) = v;
+            S(j, i) = v;
+        }
+    }
+    return S;
+}
+
+size_t FactorModel::bytes() const {
+    return (B.size() + f.size() + d.size() + capL.size()) * sizeof(double);
+}
@@ -0,0 +1,56 @@
+#ifndef FACTOR_MODEL_H
+#define FACTOR_MODEL_H
+
+#include <cstdint>
+#include <vector>
+
+#include "Matrix.h"
+
+// Statistical factor risk model  Sigma = B F B^T + D.
+//
+// B (N x K) and F (K x K, diagonal) come from a truncated randomized SVD
+// of the de-meaned returns; D holds the residual per-asset variances.
+// Memory, quadratic forms and solves are all O(N K), so the model stays
+// usable when N is in the thousands or T < N makes the sample
+// covariance singular.
+class FactorModel {
+public:
+    static FactorModel
+    fromReturns(MatrixView returns,
+                const std::vector<double>& means,
+                size_t factors,
+                int powerIterations = 2,
+                uint64_t seed = 7);
+
+    size_t assets() const { return B.rows(); }
+    size_t factors() const { return B.cols(); }
+
+    const Matrix& loadings() const { return B; }
+    const std::vector<double>& factorVariance() const { return f; }
+    const std::vector<double>& specificVariance() const { return d; }
+
+    // w^T Sigma w
+    double variance(const std::vector<double>& w) const;
+
+    // Sigma x
+    std::vector<double> multiply(const std::vector<double>& x) const;
+
+    // Sigma^{-1} b through the Woodbury identity
+    std::vector<double> solve(const std::vector<double>& b) const;
+
+    // Dense N x N equivalent, for comparison only
+    Matrix dense() const;
+
+    size_t bytes() const;
+
+private:
+    void prepareSolve();
+
+    Matrix B;               // N x K loadings
+    std::vector<double> f;  // K factor variances
+    std::vector<double> d;  // N specific variances
+
+    Matrix capL;            // Cholesky factor of F^{-1} + B^T D^{-1} B
+};
+
+#endif
@@ -0,0 +1,111 @@
+#include "FrontierState.h"
+#include "Cholesky.h"
+#include "FactorModel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+
+FrontierState::FrontierState(const std::vector<double>& mu,
+                             const CholeskyFactor& chol)
+    : invOnes_(chol.solve(std::vector<double>(mu.size(), 1.0))),
+      invMu_(chol.solve(mu)) {
+    init(mu);
+}
+
+FrontierState::FrontierState(const std::vector<double>& mu,
+                             const FactorModel& model)
+    : invOnes_(model.solve(std::vector<double>(mu.size(), 1.0))),
+      invMu_(model.solve(mu)) {
+    init(mu);
+}
+
+void FrontierState::init(const std::vector<double>& mu) {
+    if (mu.empty())
+        throw std::invalid_argument("Frontier needs at least one asset");
+
+    A = std::accumulate(invOnes_.begin(), invOnes_.end(), 0.0);
+    B = std::accumulate(invMu_.begin(), invMu_.end(), 0.0);
+    C = dotProduct(mu.data(), invMu_.data(), mu.size());
+    D = A * C - B * B;
+
+    auto [lo, hi] = std::minmax_element(mu.begin(), mu.end());
+    muMin = *lo;
+    muMax = *hi;
+}
+
+CMLPoint FrontierState::minimumVariance() const {
+    return { std::sqrt(1.0 / A), B / A };
+}
+
+double FrontierState::varianceAt(double r) const {
+    // D == 0 when every asset has the same mean: only the GMV exists
+    if (D <= 0.0) return 1.0 / A;
+    return std::max((A * r * r - 2.0 * B * r + C) / D, 1.0 / A);
+}
+
+std::vector<double> FrontierState::weightsAt(double r) const {
+    size_t n = assets();
+    std::vector<double> w(n);
+    if (D <= 0.0) {
+        for (size_t i = 0; i < n; i++) w[i] = invOnes_[i] / A;
+        return w;
+    }
+    double l = (C - B * r) / D;
+    double g = (A * r - B) / D;
+    for (size_t i = 0; i < n; i++) w[i] = l * invOnes_[i] + g * invMu_[i];
+    return w;
+}
+
+std::vector<CMLPoint> FrontierState::frontier(double rmin, double rmax,
+                                              size_t points) const {
+    std::vector<CMLPoint> out(points);
+    double step = points > 1 ? (rmax - rmin) / (points - 1) : 0.0;
+    for (size_t i = 0; i < points; i++) {
+        double r = rmin + i * step;
+        out[i] = { std::sqrt(varianceAt(r)), r };
+    }
+    return out;
+}
+
+CMLPoint FrontierState::tangencyPoint(double rf) const {
+    // w = (S^-1 mu - rf S^-1 1) / (B - rf A)
+    double denom = B - rf * A;
+    double ret = (C - rf * B) / denom;
+    double var = (C - 2.0 * rf * B + rf * rf * A) / (denom * denom);
+    return { std::sqrt(std::max(var, 0.0)), ret };
+}
+
+double FrontierState::maxSharpe(double rf) const {
+    // Negative on the inefficient branch, where the "tangency" is the
+    // minimum-Sharpe portfolio
+    double s = std::sqrt(std::max(C - 2.0 * rf * B + rf * rf * A, 0.0));
+    return efficient(rf) ? s : -s;
+}
+
+std::vector<double> FrontierState::tangencyWeights(double rf) const {
+    double denom = B - rf * A;
+    std::vector<double> w(assets());
+    for (size_t i = 0; i < w.size(); i++)
+        w[i] = (invMu_[i] - rf * invOnes_[i]) / denom;
+    return w;
+}
+
+TangencyPortfolio FrontierState::tangency(double rf) const {
+    CMLPoint p = tangencyPoint(rf);
+    return { p.expectedReturn, p.risk, tangencyWeights(rf) };
+}
+
+std::vector<CMLPoint> FrontierState::capitalMarketLine(double rf, size_t points,
+                                                       double maxRisk) const {
+    if (maxRisk <= 0.0) maxRisk = tangencyPoint(rf).risk;
+    double slope = maxSharpe(rf);
+
+    std::vector<CMLPoint> cml(points);
+    for (size_t i = 0; i < points; i++) {
+        double risk = points > 1 ? maxRisk * i / (points - 1) : 0.0;
+        cml[i] = { risk, rf + slope * risk };
+    }
+    return cml;
+}
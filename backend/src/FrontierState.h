@@ -0,0 +1,78 @@
+#ifndef FRONTIER_STATE_H
+#define FRONTIER_STATE_H
+
+#include <vector>
+
+#include "Optimizer.h"
+
+class CholeskyFactor;
+class FactorModel;
+
+// Closed-form Markowitz state for one (mu, Sigma).
+//
+// Holds Sigma^{-1} 1, Sigma^{-1} mu and the scalars
+//   A = 1' S^-1 1,  B = 1' S^-1 mu,  C = mu' S^-1 mu,  D = A C - B^2.
+// Every unconstrained frontier, tangency and CML quantity follows from
+// these: risks and returns in O(1), weights in O(N). Building it costs
+// two solves against an existing factor.
+class FrontierState {
+public:
+    FrontierState(const std::vector<double>& mu, const CholeskyFactor& chol);
+    FrontierState(const std::vector<double>& mu, const FactorModel& model);
+
+    size_t assets() const { return invOnes_.size(); }
+
+    double a() const { return A; }
+    double b() const { return B; }
+    double c() const { return C; }
+    double d() const { return D; }
+
+    const std::vector<double>& invOnes() const { return invOnes_; }
+    const std::vector<double>& invMu() const { return invMu_; }
+
+    double minReturn() const { return muMin; }
+    double maxReturn() const { return muMax; }
+
+    // ---- Frontier ----
+
+    // Global minimum-variance portfolio
+    CMLPoint minimumVariance() const;
+
+    // Minimum variance for target return r: (A r^2 - 2 B r + C) / D
+    double varianceAt(double r) const;
+
+    std::vector<double> weightsAt(double r) const;
+
+    // points evenly spaced returns over [rmin, rmax]
+    std::vector<CMLPoint> frontier(double rmin, double rmax, size_t points) const;
+
+    // ---- Tangency / CML ----
+
+    // Tangency portfolio for rf without weights, O(1). Only on the
+    // efficient branch when rf < B / A.
+    CMLPoint tangencyPoint(double rf) const;
+
+    // Sharpe ratio of the tangency portfolio, the CML slope
+    double maxSharpe(double rf) const;
+
+    bool efficient(double rf) const { return rf < B / A; }
+
+    // Sigma^{-1}(mu - rf 1), normalized to sum to one
+    std::vector<double> tangencyWeights(double rf) const;
+
+    TangencyPortfolio tangency(double rf) const;
+
+    // CML from rf out to maxRisk (the tangency risk when <= 0)
+    std::vector<CMLPoint> capitalMarketLine(double rf, size_t points,
+                                            double maxRisk = 0.0) const;
+
+private:
+    void init(const std::vector<double>& mu);
+
+    std::vector<double> invOnes_;
+    std::vector<double> invMu_;
+    double A = 0.0, B = 0.0, C = 0.0, D = 0.0;
+    double muMin = 0.0, muMax = 0.0;
+};
+
+#endif
@@ -0,0 +1,238 @@
+#ifndef MATRIX_H
+#define MATRIX_H
+
+#include <algorithm>
+#include <cstddef>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+// 64-byte aligned allocator so rows start on a cache line / SIMD boundary.
+template <class T, size_t Align = 64>
+struct AlignedAllocator {
+    using value_type = T;
+
+    template <class U> struct rebind { using other = AlignedAllocator<U, Align>; };
+
+    AlignedAllocator() = default;
+    template <class U>
+    AlignedAllocator(const AlignedAllocator<U, Align>&) {}
+
+    T* allocate(size_t n) {
+        return static_cast<T*>(
+            ::operator new(n * sizeof(T), std::align_val_t(Align)));
+    }
+
+    void deallocate(T* p, size_t) {
+        ::operator delete(p, std::align_val_t(Align));
+    }
+
+    template <class U>
+    bool operator==(const AlignedAllocator<U, Align>&) const { return true; }
+    template <class U>
+    bool operator!=(const AlignedAllocator<U, Align>&) const { return false; }
+};
+
+enum class Layout { RowMajor, ColMajor };
+
+// Contiguous dot product with independent accumulators so the compiler
+// can keep several FMA chains in flight without -ffast-math.
+inline double dotProduct(const double* a, const double* b, size_t n) {
+    double s0 = 0.0, s1 = 0.0, s2 = 0.0, s3 = 0.0;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        s0 += a[i] * b[i];
+        s1 += a[i + 1] * b[i + 1];
+        s2 += a[i + 2] * b[i + 2];
+        s3 += a[i + 3] * b[i + 3];
+    }
+    for (; i < n; i++) s0 += a[i] * b[i];
+    return (s0 + s1) + (s2 + s3);
+}
+
+// Non-owning, stride-aware window onto matrix storage.
+// Element (i, j) lives at data[i * rowStride + j * colStride].
+template <class T>
+class BasicMatrixView {
+public:
+    BasicMatrixView() = default;
+
+    BasicMatrixView(T* data, size_t rows, size_t cols,
+                    ptrdiff_t rowStride, ptrdiff_t colStride)
+        : data_(data), rows_(rows), cols_(cols),
+          rowStride_(rowStride), colStride_(colStride) {}
+
+    // Allows MutableMatrixView -> MatrixView
+    template <class U, class = std::enable_if_t<std::is_same<const U, T>::value &&
+                                                !std::is_same<U, T>::value>>
+    BasicMatrixView(const BasicMatrixView<U>& o)
+        : data_(o.data()), rows_(o.rows()), cols_(o.cols()),
+          rowStride_(o.rowStride()), colStride_(o.colStride()) {}
+
+    size_t rows() const { return rows_; }
+    size_t cols() const { return cols_; }
+    bool empty() const { return rows_ == 0 || cols_ == 0; }
+    ptrdiff_t rowStride() const { return rowStride_; }
+    ptrdiff_t colStride() const { return colStride_; }
+    T* data() const { return data_; }
+
+    T& operator()(size_t i, size_t j) const {
+        return data_[i * rowStride_ + j * colStride_];
+    }
+
+    // Start of row i; contiguous only when colStride() == 1
+    T* rowPtr(size_t i) const { return data_ + i * rowStride_; }
+    // Start of column j; contiguous only when rowStride() == 1
+    T* colPtr(size_t j) const { return data_ + j * colStride_; }
+
+    bool rowsContiguous() const { return colStride_ == 1; }
+    bool colsContiguous() const { return rowStride_ == 1; }
+
+    BasicMatrixView row(size_t i) const {
+        return { rowPtr(i), 1, cols_, rowStride_, colStride_ };
+    }
+
+    BasicMatrixView col(size_t j) const {
+        return { colPtr(j), rows_, 1, rowStride_, colStride_ };
+    }
+
+    BasicMatrixView block(size_t r0, size_t c0, size_t nr, size_t nc) const {
+        if (r0 + nr > rows_ || c0 + nc > cols_)
+            throw std::out_of_range("Matrix block out of range");
+        return { data_ + r0 * rowStride_ + c0 * colStride_,
+                 nr, nc, rowStride_, colStride_ };
+    }
+
+    // Rows [r0, r0 + nr), e.g. a date range of a returns matrix
+    BasicMatrixView rowRange(size_t r0, size_t nr) const {
+        return block(r0, 0, nr, cols_);
+    }
+
+    BasicMatrixView transposed() const {
+        return { data_, cols_, rows_, colStride_, rowStride_ };
+    }
+
+private:
+    T* data_ = nullptr;
+    size_t rows_ = 0;
+    size_t cols_ = 0;
+    ptrdiff_t rowStride_ = 0;
+    ptrdiff_t colStride_ = 0;
+};
+
+using MatrixView = BasicMatrixView<const double>;
+using MutableMatrixView = BasicMatrixView<double>;
+
+// Dense, contiguous, 64-byte aligned matrix of doubles.
+class Matrix {
+public:
+    using Storage = std::vector<double, AlignedAllocator<double>>;
+
+    Matrix() = default;
+
+    Matrix(size_t rows, size_t cols, double fill = 0.0,
+           Layout layout = Layout::RowMajor)
+        : rows_(rows), cols_(cols), layout_(layout), data_(rows * cols, fill) {}
+
+    // Deep copy of any view into a new matrix with the given layout
+    explicit Matrix(MatrixView v, Layout layout = Layout::RowMajor)
+        : Matrix(v.rows(), v.cols(), 0.0, layout) {
+        for (size_t i = 0; i < rows_; i++)
+            for (size_t j = 0; j < cols_; j++)
+                (*this)(i, j) = v(i, j);
+    }
+
+    static Matrix fromRows(const std::vector<std::vector<double>>& rows);
+    static Matrix identity(size_t n);
+
+    size_t rows() const { return rows_; }
+    size_t cols() const { return cols_; }
+    size_t size() const { return data_.size(); }
+    bool empty() const { return data_.empty(); }
+    Layout layout() const { return layout_; }
+
+    double* data() { return data_.data(); }
+    const double* data() const { return data_.data(); }
+
+    double& operator()(size_t i, size_t j) {
+        return data_[layout_ == Layout::RowMajor ? i * cols_ + j : j * rows_ + i];
+    }
+    double operator()(size_t i, size_t j) const {
+        return data_[layout_ == Layout::RowMajor ? i * cols_ + j : j * rows_ + i];
+    }
+
+    // Contiguous row i (row-major) or column j (column-major)
+    double* rowPtr(size_t i) { return data_.data() + i * cols_; }
+    const double* rowPtr(size_t i) const { return data_.data() + i * cols_; }
+    double* colPtr(size_t j) { return data_.data() + j * rows_; }
+    const double* colPtr(size_t j) const { return data_.data() + j * rows_; }
+
+    MatrixView view() const {
+        return { data_.data(), rows_, cols_, rowStride(), colStride() };
+    }
+    MutableMatrixView view() {
+        return { data_.data(), rows_, cols_, rowStride(), colStride() };
+    }
+    operator MatrixView() const { return view(); }
+
+    MatrixView row(size_t i) const { return view().row(i); }
+    MatrixView col(size_t j) const { return view().col(j); }
+    MatrixView block(size_t r0, size_t c0, size_t nr, size_t nc) const {
+        return view().block(r0, c0, nr, nc);
+    }
+    MatrixView rowRange(size_t r0, size_t nr) const {
+        return view().rowRange(r0, nr);
+    }
+
+    // Appends one row to a row-major matrix (amortized O(cols))
+    void appendRow(const double* values);
+
+    std::vector<std::vector<double>> toRows() const;
+
+private:
+    ptrdiff_t rowStride() const {
+        return layout_ == Layout::RowMajor ? static_cast<ptrdiff_t>(cols_) : 1;
+    }
+    ptrdiff_t colStride() const {
+        return layout_ == Layout::RowMajor ? 1 : static_cast<ptrdiff_t>(rows_);
+    }
+
+    size_t rows_ = 0;
+    size_t cols_ = 0;
+    Layout layout_ = Layout::RowMajor;
+    Storage data_;
+};
+
+inline Matrix Matrix::fromRows(const std::vector<std::vector<double>>& rows) {
+    Matrix m(rows.size(), rows.empty() ? 0 : rows[0].size());
+    for (size_t i = 0; i < m.rows_; i++) {
+        if (rows[i].size() != m.cols_)
+            throw std::invalid_argument("Ragged rows in Matrix::fromRows");
+        std::copy(rows[i].begin(), rows[i].end(), m.rowPtr(i));
+    }
+    return m;
+}
+
+inline Matrix Matrix::identity(size_t n) {
+    Matrix m(n, n);
+    for (size_t i = 0; i < n; i++) m(i, i) = 1.0;
+    return m;
+}
+
+inline void Matrix::appendRow(const double* values) {
+    if (layout_ != Layout::RowMajor)
+        throw std::logic_error("appendRow needs a row-major matrix");
+    data_.insert(data_.end(), values, values + cols_);
+    rows_++;
+}
+
+inline std::vector<std::vector<double>> Matrix::toRows() const {
+    std::vector<std::vector<double>> out(rows_, std::vector<double>(cols_));
+    for (size_t i = 0; i < rows_; i++)
+        for (size_t j = 0; j < cols_; j++)
+            out[i][j] = (*this)(i, j);
+    return out;
+}
+
+#endif
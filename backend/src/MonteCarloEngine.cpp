@@ -0,0 +1,187 @@
+#include "MonteCarloEngine.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "Cholesky.h"
+#include "Philox.h"
+#include "ThreadPool.h"
+
+namespace {
+
+// Paths per task and per register tile
+constexpr size_t kBlockPaths = 32;
+constexpr size_t kTile = 4;
+
+size_t roundUp(size_t n, size_t m) { return (n + m - 1) / m * m; }
+
+// U packed by 4-column strips: strip j holds rows k < min(n, j + 4) of
+// columns j..j+3 (zero padded past n), 4 values per row, contiguous.
+std::vector<double> packStrips(const CholeskyFactor& factor, size_t n,
+                               std::vector<size_t>& offsets) {
+    offsets.clear();
+    size_t total = 0;
+    for (size_t j = 0; j < n; j += kTile) {
+        offsets.push_back(total);
+        total += std::min(n, j + kTile) * kTile;
+    }
+    std::vector<double> packed(total, 0.0);
+    for (size_t s = 0, j = 0; j < n; s++, j += kTile) {
+        double* strip = packed.data() + offsets[s];
+        for (size_t k = 0; k < std::min(n, j + kTile); k++) {
+            const double* row = factor.upper().rowPtr(k);
+            for (size_t c = 0; c < kTile && j + c < n; c++)
+                if (j + c >= k) strip[k * kTile + c] = row[j + c];
+        }
+    }
+    return packed;
+}
+
+// R = 1 + mu + U'z for a block of `rows` paths, with the block stored
+// asset-major (Z[k * rows + p]) so a 4-column x 4-path accumulator tile
+// vectorizes across paths and stays in registers. Each strip is reused
+// from L1 by every path tile of the block.
+void growthBlock(const double* Z, size_t rows, const double* packed,
+                 const std::vector<size_t>& offsets, const double* onePlusMu,
+                 size_t n, double* R) {
+    for (size_t s = 0, j = 0; j < n; s++, j += kTile) {
+        const double* strip = packed + offsets[s];
+        const size_t kEnd = std::min(n, j + kTile);
+        for (size_t p = 0; p < rows; p += kTile) {
+            double acc[kTile][kTile] = {};
+            for (size_t k = 0; k < kEnd; k++) {
+                const double* z = Z + k * rows + p;
+                const double* u = strip + k * kTile;
+                for (size_t c = 0; c < kTile; c++)
+                    for (size_t q = 0; q < kTile; q++) acc[c][q] += u[c] * z[q];
+            }
+            for (size_t c = 0; c < kTile; c++)
+                for (size_t q = 0; q < kTile; q++)
+                    R[(j + c) * rows + p + q] = onePlusMu[j + c] + acc[c][q];
+        }
+    }
+}
+
+// Values at levels q of v[0, n) by the floor(q n) rank; v is reordered
+void selectLevels(double* v, size_t n, const std::vector<double>& levels, double* out) {
+    for (size_t k = 0; k < levels.size(); k++) {
+        size_t rank = std::min(n - 1, static_cast<size_t>(levels[k] * n));
+        std::nth_element(v, v + rank, v + n);
+        out[k] = v[rank];
+    }
+}
+
+void moments(const double* v, size_t n, double& mean, double& stdev, double& lossProb) {
+    double sum = 0.0, losses = 0.0;
+    for (size_t i = 0; i < n; i++) {
+        sum += v[i];
+        losses += v[i] < 1.0;
+    }
+    mean = sum / n;
+    double ss = 0.0;
+    for (size_t i = 0; i < n; i++) ss += (v[i] - mean) * (v[i] - mean);
+    stdev = n > 1 ? std::sqrt(ss / (n - 1)) : 0.0;
+    lossProb = losses / n;
+}
+
+}
+
+AssetSimulationResult MonteCarloEngine::simulateAssets(
+    const std::vector<double>& mu,
+    const CholeskyFactor& factor,
+    const std::vector<double>& weights,
+    const AssetSimulationOptions& options,
+    ThreadPool& pool)
+{
+    const size_t N = mu.size();
+    if (N == 0 || factor.size() != N || weights.size() != N)
+        throw std::invalid_argument("mean, factor and weights must cover the same assets");
+    if (options.paths < 1 || options.horizon < 1 || options.rebalanceEvery < 0)
+        throw std::invalid_argument("paths and horizon must be positive");
+    for (double q : options.percentiles)
+        if (!(q >= 0.0 && q <= 1.0))
+            throw std::invalid_argument("percentiles must be in [0, 1]");
+
+    const size_t P = static_cast<size_t>(options.paths);
+    const uint32_t H = static_cast<uint32_t>(options.horizon);
+    const size_t stride = roundUp(N, kTile);     // padded asset count
+    const size_t zStride = roundUp(N, 2);        // normals come in pairs
+
+    // Packed U strips and zero-padded 1 + mu, so tiles never branch on N
+    std::vector<size_t> offsets;
+    const std::vector<double> packed = packStrips(factor, N, offsets);
+    std::vector<double> onePlusMu(stride, 1.0);
+    for (size_t k = 0; k < N; k++) onePlusMu[k] += mu[k];
+
+    // Terminal values, asset-major so each asset's paths are contiguous
+    std::vector<double> terminal(N * P), portfolio(P);
+    const Philox4x32 rng(options.seed);
+    const int every = options.rebalanceEvery;
+
+    size_t blocks = (P + kBlockPaths - 1) / kBlockPaths;
+    pool.parallelFor(blocks, [&](size_t b) {
+        const size_t first = b * kBlockPaths;
+        const size_t count = std::min(kBlockPaths, P - first);
+        const size_t rows = roundUp(count, kTile);  // padding rows are simulated and dropped
+
+        // Asset-major block buffers: element (i, p) at i * rows + p
+        std::vector<double> Z(stride * rows, 0.0), R(stride * rows);
+        std::vector<double> growth(N * rows, 1.0), hold(N * rows), value(rows);
+        std::vector<double> draws(zStride);
+        std::vector<uint64_t> scratch(zStride);
+        for (size_t i = 0; i < N; i++)
+            std::fill(hold.begin() + i * rows, hold.begin() + (i + 1) * rows, weights[i]);
+
+        for (uint32_t t = 0; t < H; t++) {
+            for (size_t p = 0; p < rows; p++) {
+                rng.normals(first + p, t, N, draws.data(), scratch.data());
+                for (size_t k = 0; k < N; k++) Z[k * rows + p] = draws[k];
+            }
+
+            growthBlock(Z.data(), rows, packed.data(), offsets, onePlusMu.data(), N, R.data());
+
+            for (size_t i = 0; i < N * rows; i++) {
+                growth[i] *= R[i];
+                hold[i] *= R[i];
+            }
+            if (every > 0 && (t + 1) % every == 0) {
+                std::fill(value.begin(), value.end(), 0.0);
+                for (size_t i = 0; i < N; i++)
+                    for (size_t p = 0; p < rows; p++) value[p] += hold[i * rows + p];
+                for (size_t i = 0; i < N; i++)
+                    for (size_t p = 0; p < rows; p++) hold[i * rows + p] = value[p] * weights[i];
+            }
+        }
+
+        for (size_t p = 0; p < count; p++) {
+            double total = 0.0;
+            for (size_t i = 0; i < N; i++) {
+                terminal[i * P + first + p] = growth[i * rows + p];
+                total += hold[i * rows + p];
+            }
+            portfolio[first + p] = total;
+        }
+    });
+
+    // ---- Terminal statistics ----
+    const auto& levels = options.percentiles;
+    AssetSimulationResult result;
+    result.assetMean.resize(N);
+    result.assetStdev.resize(N);
+    result.assetLossProbability.resize(N);
+    result.assetPercentiles = Matrix(N, levels.size());
+
+    pool.parallelFor(N, [&](size_t i) {
+        double* v = terminal.data() + i * P;
+        moments(v, P, result.assetMean[i], result.assetStdev[i], result.assetLossProbability[i]);
+        if (!levels.empty()) selectLevels(v, P, levels, result.assetPercentiles.rowPtr(i));
+    });
+
+    moments(portfolio.data(), P, result.portfolioMean, result.portfolioStdev,
+            result.portfolioLossProbability);
+    result.portfolioPercentiles.resize(levels.size());
+    if (!levels.empty())
+        selectLevels(portfolio.data(), P, levels, result.portfolioPercentiles.data());
+    return result;
+}
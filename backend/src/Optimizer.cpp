@@ -4,8 +4,13 @@
 #include <algorithm>
 #include <stdexcept>
 
+#include "Cholesky.h"
+#include "FactorModel.h"
+#include "FrontierState.h"
 #include "OptimizerUtils.h"
 #include "PortfolioMetrics.h"
+#include "SmallKernels.h"
+#include "ThreadPool.h"
 
 static double dot(const std::vector<double>& a,
                   const std::vector<double>& b) {
@@ -15,136 +20,206 @@ static double dot(const std::vector<double>& a,
     return s;
 }
 
-static std::vector<double>
-matVec(const std::vector<std::vector<double>>& A,
-       const std::vector<double>& x) {
-    std::vector<double> r(A.size(), 0.0);
-    for (int i = 0; i < A.size(); i++)
-        for (int j = 0; j < x.size(); j++)
-            r[i] += A[i][j] * x[j];
-    return r;
+static void covTimes(MatrixView cov, const double* x, double* out) {
+    size_t n = cov.rows();
+    for (size_t i = 0; i < n; i++)
+        out[i] = dotProduct(cov.rowPtr(i), x, n);
 }
 
-static std::vector<std::vector<double>>
-invert(std::vector<std::vector<double>> A) {
-    int n = A.size();
-    std::vector<std::vector<double>> I(n,
-        std::vector<double>(n, 0.0));
-    for (int i = 0; i < n; i++) I[i][i] = 1.0;
+// Largest eigenvalue of cov from a few power iterations, padded so the
+// FISTA step stays below 1/L
+static double lipschitz(MatrixView cov, std::vector<double>& v, std::vector<double>& Av) {
+    size_t n = cov.rows();
+    std::fill(v.begin(), v.end(), 1.0 / std::sqrt(static_cast<double>(n)));
+    double lambda = 0.0;
+    for (int it = 0; it < 30; it++) {
+        covTimes(cov, v.data(), Av.data());
+        double norm = std::sqrt(dot(Av, Av));
+        if (norm <= 0.0) break;
+        double next = dot(v, Av);
+        for (size_t i = 0; i < n; i++) v[i] = Av[i] / norm;
+        if (std::abs(next - lambda) <= 1e-6 * next) {
+            lambda = next;
+            break;
+        }
+        lambda = next;
+    }
+    return 1.1 * lambda;
+}
 
-    for (int i = 0; i < n; i++) {
-        double p = A[i][i];
-        if (std::abs(p) < 1e-12)
-            throw std::runtime_error("Singular matrix");
+namespace {
 
-        for (int j = 0; j < n; j++) {
-            A[i][j] /= p;
-            I[i][j] /= p;
-        }
+struct MinVarianceWorkspace {
+    std::vector<double> x, xPrev, y, Sx, SxPrev, Sy;
+    std::vector<std::pair<double, int>> breakpoints;
+    std::vector<size_t> order;
 
-        for (int k = 0; k < n; k++) {
-            if (k == i) continue;
-            double f = A[k][i];
-            for (int j = 0; j < n; j++) {
-                A[k][j] -= f * A[i][j];
-                I[k][j] -= f * I[i][j];
-            }
-        }
+    void resize(size_t n) {
+        for (auto* v : { &x, &xPrev, &y, &Sx, &SxPrev, &Sy }) v->resize(n);
+        breakpoints.reserve(2 * n);
+        order.resize(n);
     }
-    return I;
+};
+
 }
 
-std::vector<double>
+MinVarianceResult
 Optimizer::minimizeVariance(
-    const std::vector<std::vector<double>>& cov,
+    MatrixView cov,
+    double maxWeight,
     int maxIter,
-    double lr) {
-
-    int N = cov.size();
-    std::vector<double> w(N, 1.0 / N);
-
-    for (int it = 0; it < maxIter; it++) {
-        std::vector<double> grad(N, 0.0);
-        for (int i = 0; i < N; i++)
-            for (int j = 0; j < N; j++)
-                grad[i] += 2 * cov[i][j] * w[j];
+    double tol) {
+
+    size_t N = cov.rows();
+    if (N == 0 || cov.cols() != N)
+        throw std::invalid_argument("covariance must be square and non-empty");
+    double cap = std::min(maxWeight, 1.0);
+    if (cap * N < 1.0 - 1e-12)
+        throw std::invalid_argument("max_weight too small for a fully invested portfolio");
+
+    // Per-thread workspace: pool workers running batches of solves keep
+    // their buffers between calls
+    thread_local MinVarianceWorkspace ws;
+    ws.resize(N);
+    auto& x = ws.x;
+    auto& xPrev = ws.xPrev;
+    auto& y = ws.y;
+    auto& Sx = ws.Sx;
+    auto& SxPrev = ws.SxPrev;
+    auto& Sy = ws.Sy;
+    auto& breakpoints = ws.breakpoints;
+    auto& order = ws.order;
+    std::fill(x.begin(), x.end(), 1.0 / N);
+
+    double L = lipschitz(cov, y, Sy);
+    if (!(L > 0.0)) L = 1.0;
+    const double step = 1.0 / L;
+
+    MinVarianceResult result;
+    covTimes(cov, x.data(), Sx.data());
+    y = x;
+    Sy = Sx;
+    double t = 1.0;
+
+    for (int it = 1; it <= maxIter; it++) {
+        // x+ = P(y - grad/L), grad of w'Sw / 2 is Sw
+        xPrev.swap(x);
+        SxPrev.swap(Sx);
+        for (size_t i = 0; i < N; i++) x[i] = y[i] - step * Sy[i];
+        OptimizerUtils::projectCappedSimplex(x.data(), N, cap, breakpoints);
+        covTimes(cov, x.data(), Sx.data());
+        result.iterations = it;
+
+        if (it % 10 == 0 || it == maxIter) {
+            double var = dot(x, Sx);
+            // Gap of w'Sw is twice the gap of the halved objective
+            result.dualityGap = 2.0 * OptimizerUtils::cappedSimplexGap(
+                Sx.data(), x.data(), N, cap, order);
+            if (result.dualityGap <= tol * var) {
+                result.converged = true;
+                break;
+            }
+        }
 
-        for (int i = 0; i < N; i++)
-            w[i] -= lr * grad[i];
+        // Gradient-based restart: drop momentum when it points uphill
+        double uphill = 0.0;
+        for (size_t i = 0; i < N; i++) uphill += (y[i] - x[i]) * (x[i] - xPrev[i]);
+        if (uphill > 0.0) t = 1.0;
 
-        double s = 0;
-        for (double x : w) s += x;
-        for (double& x : w) x /= s;
+        double tNext = 0.5 * (1.0 + std::sqrt(1.0 + 4.0 * t * t));
+        double beta = (t - 1.0) / tNext;
+        t = tNext;
 
-        OptimizerUtils::applyConstraints(w, 0.3);
+        // S y follows from S x and S xPrev, no extra product
+        for (size_t i = 0; i < N; i++) {
+            y[i] = x[i] + beta * (x[i] - xPrev[i]);
+            Sy[i] = Sx[i] + beta * (Sx[i] - SxPrev[i]);
+        }
     }
-    return w;
+
+    result.risk = PortfolioMetrics::portfolioRisk(dot(x, Sx));
+    result.weights = x;
+    return result;
 }
 
 std::vector<std::pair<double, double>>
 Optimizer::computeEfficientFrontier(
     const std::vector<double>& mu,
-    const std::vector<std::vector<double>>& cov,
+    MatrixView cov,
     int points) {
+    return computeEfficientFrontier(
+        FrontierState(mu, CholeskyFactor::factor(cov)), points);
+}
 
-    int n = mu.size();
-    auto SInv = invert(cov);
-    std::vector<double> ones(n, 1.0);
-
-    double A = dot(ones, matVec(SInv, ones));
-    double B = dot(ones, matVec(SInv, mu));
-    double C = dot(mu, matVec(SInv, mu));
-    double D = A * C - B * B;
-
-    double rmin = *std::min_element(mu.begin(), mu.end());
-    double rmax = *std::max_element(mu.begin(), mu.end());
+std::vector<std::pair<double, double>>
+Optimizer::computeEfficientFrontier(
+    const FrontierState& state,
+    int points) {
 
     std::vector<std::pair<double, double>> ef;
+    for (const auto& p : state.frontier(state.minReturn(), state.maxReturn(), points))
+        ef.push_back({ p.risk, p.expectedReturn });
+    return ef;
+}
 
-    for (int i = 0; i < points; i++) {
-        double r = rmin + i * (rmax - rmin) / (points - 1);
-        double a = (C - B * r) / D;
-        double b = (A * r - B) / D;
-
-        std::vector<double> w(n);
-        for (int j = 0; j < n; j++)
-            w[j] = a * matVec(SInv, ones)[j]
-                 + b * matVec(SInv, mu)[j];
-
-        double var = dot(w, matVec(cov, w));
-        ef.push_back({ std::sqrt(var), r });
+TangencyPortfolio
+Optimizer::computeTangencyPortfolio(
+    const std::vector<double>& mu,
+    MatrixView cov,
+    double rf) {
+    // Small universes: stack Cholesky, no factor or state allocation
+    TangencyPortfolio tp;
+    tp.weights.resize(mu.size());
+    if (SmallKernels::tangencyWeights(cov, mu.data(), mu.size(), rf, tp.weights.data())) {
+        OptimizerUtils::applyConstraints(tp.weights, 0.3);
+        tp.expectedReturn = dot(tp.weights, mu);
+        tp.risk = std::sqrt(PortfolioMetrics::portfolioVariance(tp.weights, cov));
+        return tp;
     }
-
-    return ef;
+    return computeTangencyPortfolio(
+        mu, cov, FrontierState(mu, CholeskyFactor::factor(cov)), rf);
 }
 
 TangencyPortfolio
 Optimizer::computeTangencyPortfolio(
     const std::vector<double>& mu,
-    const std::vector<std::vector<double>>& cov,
+    MatrixView cov,
+    const FrontierState& state,
     double rf) {
 
-    int n = mu.size();
-    auto SInv = invert(cov);
+    TangencyPortfolio tp;
+    tp.weights = state.tangencyWeights(rf);
+
+    OptimizerUtils::applyConstraints(tp.weights, 0.3);
+
+
+    tp.expectedReturn = dot(tp.weights, mu);
+    tp.risk = std::sqrt(PortfolioMetrics::portfolioVariance(tp.weights, cov));
+
+    return tp;
+}
 
-    std::vector<double> excess(n);
-    for (int i = 0; i < n; i++)
-        excess[i] = mu[i] - rf;
+std::vector<std::pair<double, double>>
+Optimizer::computeEfficientFrontier(
+    const std::vector<double>& mu,
+    const FactorModel& model,
+    int points) {
+    return computeEfficientFrontier(FrontierState(mu, model), points);
+}
 
-    auto temp = matVec(SInv, excess);
-    double denom = 0;
-    for (double v : temp) denom += v;
+TangencyPortfolio
+Optimizer::computeTangencyPortfolio(
+    const std::vector<double>& mu,
+    const FactorModel& model,
+    double rf) {
 
     TangencyPortfolio tp;
-    tp.weights.resize(n);
-    for (int i = 0; i < n; i++)
-        tp.weights[i] = temp[i] / denom;
+    tp.weights = FrontierState(mu, model).tangencyWeights(rf);
 
     OptimizerUtils::applyConstraints(tp.weights, 0.3);
 
-
     tp.expectedReturn = dot(tp.weights, mu);
-    tp.risk = std::sqrt(dot(tp.weights, matVec(cov, tp.weights)));
+    tp.risk = std::sqrt(model.variance(tp.weights));
 
     return tp;
 }
@@ -172,54 +247,175 @@ Optimizer::computeCapitalMarketLine(
 
 PortfolioResult Optimizer::computeRiskParityPortfolio(
     const std::vector<double>& mu,
-    const std::vector<std::vector<double>>& cov,
+    MatrixView cov,
     int maxIter,
     double tol
 ) {
-    int N = mu.size();
-    std::vector<double> w(N, 1.0 / N);
-
-    for (int iter = 0; iter < maxIter; iter++) {
-
-        std::vector<double> sigmaW(N, 0.0);
-        for (int i = 0; i < N; i++)
-            for (int j = 0; j < N; j++)
-                sigmaW[i] += cov[i][j] * w[j];
-
-        double portVar = 0.0;
-        for (int i = 0; i < N; i++)
-            portVar += w[i] * sigmaW[i];
-
-        double targetRC = portVar / N;
-        bool converged = true;
-
-        for (int i = 0; i < N; i++) {
-            double rc = w[i] * sigmaW[i];
-            if (rc <= 1e-10) rc = 1e-10;
-
-            double adjustment = targetRC / rc;
-            double newWi = w[i] * adjustment;
+    std::vector<double> equal(mu.size(), 1.0);
+    RiskBudgetResult rb = computeRiskBudgetPortfolio(mu, cov, equal, maxIter, tol);
+    return { std::move(rb.weights), rb.expectedReturn, rb.risk };
+}
 
-            double alpha = 0.3; // damping
-            if (std::abs(newWi - w[i]) > tol)
-                converged = false;
+RiskBudgetResult Optimizer::computeRiskBudgetPortfolio(
+    const std::vector<double>& mu,
+    MatrixView cov,
+    const std::vector<double>& budgets,
+    int maxSweeps,
+    double tol
+) {
+    size_t N = mu.size();
+    if (N == 0 || cov.rows() != N || cov.cols() != N)
+        throw std::invalid_argument("mean and covariance sizes differ");
+    if (budgets.size() != N)
+        throw std::invalid_argument("risk budgets need one value per asset");
+
+    double total = 0.0;
+    for (double b : budgets) {
+        if (!(b > 0.0) || !std::isfinite(b))
+            throw std::invalid_argument("risk budgets must be positive");
+        total += b;
+    }
+    std::vector<double> b(N);
+    for (size_t i = 0; i < N; i++) b[i] = budgets[i] / total;
+
+    for (size_t i = 0; i < N; i++)
+        if (!(cov(i, i) > 0.0))
+            throw std::invalid_argument("risk budgeting needs positive variances");
+
+    // Start from inverse-volatility scaled by budget; y is only defined
+    // up to the log-barrier scale, so normalize its variance to one
+    std::vector<double> y(N), Sy(N);
+    for (size_t i = 0; i < N; i++) y[i] = b[i] / std::sqrt(cov(i, i));
+    for (size_t i = 0; i < N; i++) Sy[i] = dotProduct(cov.rowPtr(i), y.data(), N);
+    double var = dot(y, Sy);
+    double s = 1.0 / std::sqrt(var);
+    for (size_t i = 0; i < N; i++) {
+        y[i] *= s;
+        Sy[i] *= s;
+    }
 
-            w[i] = (1 - alpha) * w[i] + alpha * newWi;
+    RiskBudgetResult result;
+    for (int sweep = 1; sweep <= maxSweeps; sweep++) {
+        for (size_t i = 0; i < N; i++) {
+            // Stationarity in y_i: s_ii y^2 + c y - b_i = 0, c = (Sy)_i - s_ii y_i
+            const double* row = cov.rowPtr(i);
+            double sii = row[i];
+            double c = Sy[i] - sii * y[i];
+            double next = (-c + std::sqrt(c * c + 4.0 * sii * b[i])) / (2.0 * sii);
+            double delta = next - y[i];
+            if (delta == 0.0) continue;
+            y[i] = next;
+            for (size_t j = 0; j < N; j++) Sy[j] += delta * row[j];
         }
+        result.sweeps = sweep;
+
+        // Contribution shares are scale-free, so check them on y directly
+        var = dot(y, Sy);
+        double dev = 0.0;
+        for (size_t i = 0; i < N; i++)
+            dev = std::max(dev, std::abs(y[i] * Sy[i] / var - b[i]));
+        result.maxDeviation = dev;
+        if (dev <= tol) {
+            result.converged = true;
+            break;
+        }
+    }
 
-        // Normalize weights
-        double sumW = std::accumulate(w.begin(), w.end(), 0.0);
-        for (double& wi : w) wi /= sumW;
-
-        if (converged) break;
+    double sum = std::accumulate(y.begin(), y.end(), 0.0);
+    result.weights.resize(N);
+    result.riskContributions.resize(N);
+    for (size_t i = 0; i < N; i++) {
+        result.weights[i] = y[i] / sum;
+        result.riskContributions[i] = y[i] * Sy[i] / var;
     }
+    result.expectedReturn = PortfolioMetrics::portfolioReturn(result.weights, mu);
+    result.risk = PortfolioMetrics::portfolioRisk(var / (sum * sum));
+    return result;
+}
 
-    double ret =
-        PortfolioMetrics::portfolioReturn(w, mu);
+static BatchResult solveOne(const std::vector<double>& mu, MatrixView cov,
+                            const FrontierState& state, const BatchProblem& p) {
+    BatchResult r;
+    switch (p.kind) {
+    case BatchProblem::Kind::Tangency:
+        if (p.constrained) {
+            auto cp = PortfolioQP::maxSharpe(mu, cov, p.rf, p.constraints);
+            r.weights = std::move(cp.weights);
+            r.expectedReturn = cp.expectedReturn;
+            r.risk = cp.risk;
+            r.iterations = cp.qp.iterations;
+            r.converged = cp.qp.converged;
+        } else {
+            Optimizer opt;
+            auto tp = opt.computeTangencyPortfolio(mu, cov, state, p.rf);
+            r.weights = std::move(tp.weights);
+            r.expectedReturn = tp.expectedReturn;
+            r.risk = tp.risk;
+        }
+        break;
+
+    case BatchProblem::Kind::TargetReturn:
+        if (p.constrained) {
+            auto cp = PortfolioQP::targetReturn(mu, cov, p.targetReturn, p.constraints);
+            r.weights = std::move(cp.weights);
+            r.expectedReturn = cp.expectedReturn;
+            r.risk = cp.risk;
+            r.iterations = cp.qp.iterations;
+            r.converged = cp.qp.converged;
+        } else {
+            r.weights = state.weightsAt(p.targetReturn);
+            r.expectedReturn = p.targetReturn;
+            r.risk = PortfolioMetrics::portfolioRisk(state.varianceAt(p.targetReturn));
+        }
+        break;
+
+    case BatchProblem::Kind::MinVariance: {
+        auto mv = Optimizer::minimizeVariance(cov, p.maxWeight);
+        r.expectedReturn = PortfolioMetrics::portfolioReturn(mv.weights, mu);
+        r.weights = std::move(mv.weights);
+        r.risk = mv.risk;
+        r.iterations = mv.iterations;
+        r.converged = mv.converged;
+        break;
+    }
 
-    double risk =
-        PortfolioMetrics::portfolioRisk(
-            PortfolioMetrics::portfolioVariance(w, cov));
+    case BatchProblem::Kind::RiskParity: {
+        std::vector<double> budgets = p.budgets.empty()
+            ? std::vector<double>(mu.size(), 1.0) : p.budgets;
+        auto rb = Optimizer::computeRiskBudgetPortfolio(mu, cov, budgets);
+        r.weights = std::move(rb.weights);
+        r.expectedReturn = rb.expectedReturn;
+        r.risk = rb.risk;
+        r.iterations = rb.sweeps;
+        r.converged = rb.converged;
+        break;
+    }
+    }
+    return r;
+}
 
-    return { w, ret, risk };
+std::vector<BatchResult> Optimizer::solveBatch(
+    const std::vector<double>& mu,
+    MatrixView cov,
+    const FrontierState& state,
+    const std::vector<BatchProblem>& problems,
+    ThreadPool& pool
+) {
+    if (state.assets() != mu.size() || cov.rows() != mu.size())
+        throw std::invalid_argument("batch state does not match the universe");
+
+    std::vector<BatchResult> results(problems.size());
+    pool.parallelFor(problems.size(), [&](size_t i) {
+        auto started = std::chrono::steady_clock::now();
+        try {
+            results[i] = solveOne(mu, cov, state, problems[i]);
+        }
+        catch (const std::exception& e) {
+            results[i] = BatchResult{};
+            results[i].error = e.what();
+        }
+        results[i].elapsedMs = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - started).count();
+    });
+    return results;
 }
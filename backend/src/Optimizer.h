@@ -1,9 +1,17 @@
 #ifndef OPTIMIZER_H
 #define OPTIMIZER_H
 
+#include <string>
 #include <vector>
 #include <utility>
 
+#include "Matrix.h"
+#include "PortfolioQP.h"
+
+class FactorModel;
+class FrontierState;
+class ThreadPool;
+
 struct TangencyPortfolio {
     double expectedReturn;
     double risk;
@@ -21,24 +29,104 @@ struct PortfolioResult {
     double risk;
 };
 
+struct RiskBudgetResult {
+    std::vector<double> weights;
+    double expectedReturn = 0.0;
+    double risk = 0.0;
+    std::vector<double> riskContributions;  // w_i (Sw)_i / w'Sw, sums to 1
+    int sweeps = 0;
+    double maxDeviation = 0.0;              // max |contribution - budget|
+    bool converged = false;
+};
+
+struct MinVarianceResult {
+    std::vector<double> weights;
+    double risk = 0.0;
+    int iterations = 0;
+    double dualityGap = 0.0;  // upper bound on w'Sw - optimum
+    bool converged = false;
+};
+
+// One item of a batch. Tangency and target-return problems use the
+// closed form on the shared frontier state unless `constrained` is set,
+// in which case they go through PortfolioQP with `constraints` (a weight
+// cap goes in constraints.maxWeight). `maxWeight` is read only by
+// min-variance, which honours it via the FISTA solver.
+struct BatchProblem {
+    enum class Kind { Tangency, TargetReturn, MinVariance, RiskParity };
+
+    Kind kind = Kind::Tangency;
+    double rf = 0.0;
+    double targetReturn = 0.0;
+    double maxWeight = 0.3;
+    std::vector<double> budgets;       // risk parity; equal when empty
+    bool constrained = false;
+    PortfolioConstraints constraints;
+};
+
+struct BatchResult {
+    std::vector<double> weights;
+    double expectedReturn = 0.0;
+    double risk = 0.0;
+    int iterations = 0;
+    bool converged = true;
+    double elapsedMs = 0.0;
+    std::string error;                 // empty on success
+
+    bool ok() const { return error.empty(); }
+};
 
 class Optimizer {
 public:
-    static std::vector<double>
-    minimizeVariance(const std::vector<std::vector<double>>& cov,
-                     int maxIter = 1000,
-                     double lr = 0.01);
+    // Long-only, capped minimum variance by FISTA with adaptive restart.
+    // The step is 1/L from a power-iteration estimate of the largest
+    // eigenvalue, each step projects exactly onto the capped simplex, and
+    // the loop stops once the Frank-Wolfe duality gap is below
+    // tol * w'Sw. One covariance product per iteration.
+    static MinVarianceResult
+    minimizeVariance(MatrixView cov,
+                     double maxWeight = 0.3,
+                     int maxIter = 5000,
+                     double tol = 1e-9);
+
+    std::vector<std::pair<double, double>>
+    computeEfficientFrontier(
+        const std::vector<double>& mu,
+        MatrixView cov,
+        int points);
+
+    // O(1) per point from a precomputed FrontierState
+    std::vector<std::pair<double, double>>
+    computeEfficientFrontier(
+        const FrontierState& state,
+        int points);
 
+    // Same frontier using Woodbury solves on a factor model, O(N K)
     std::vector<std::pair<double, double>>
     computeEfficientFrontier(
         const std::vector<double>& mu,
-        const std::vector<std::vector<double>>& cov,
+        const FactorModel& model,
         int points);
 
     TangencyPortfolio
     computeTangencyPortfolio(
         const std::vector<double>& mu,
-        const std::vector<std::vector<double>>& cov,
+        MatrixView cov,
+        double rf);
+
+    // Weights in O(N) from the state; risk of the constrained weights
+    // is re-evaluated against cov
+    TangencyPortfolio
+    computeTangencyPortfolio(
+        const std::vector<double>& mu,
+        MatrixView cov,
+        const FrontierState& state,
+        double rf);
+
+    TangencyPortfolio
+    computeTangencyPortfolio(
+        const std::vector<double>& mu,
+        const FactorModel& model,
         double rf);
 
     std::vector<CMLPoint>
@@ -49,12 +137,40 @@ public:
         int points
     );
 
+    // Equal risk contributions; see computeRiskBudgetPortfolio
     PortfolioResult computeRiskParityPortfolio(
         const std::vector<double>& mu,
-        const std::vector<std::vector<double>>& cov,
+        MatrixView cov,
         int maxIter = 500,
         double tol = 1e-8
     );
+
+    // Solves every problem, fanned out over the pool. Unconstrained
+    // tangency and target-return items share the factorization in
+    // `state` (built from mu and cov); constrained ones build and factor
+    // their own QP. Results are in input order; a failing item records
+    // its error and does not stop the others.
+    static std::vector<BatchResult> solveBatch(
+        const std::vector<double>& mu,
+        MatrixView cov,
+        const FrontierState& state,
+        const std::vector<BatchProblem>& problems,
+        ThreadPool& pool
+    );
+
+    // Risk budgeting by cyclical coordinate descent on
+    //   min  y'Sy / 2 - sum b_i log y_i,   w = y / sum y
+    // Each coordinate has a closed-form positive root and updates Sy
+    // with one covariance row, so a sweep is O(N^2) with no full
+    // product. Budgets are normalized to sum to one; stops once every
+    // contribution is within tol of its budget.
+    static RiskBudgetResult computeRiskBudgetPortfolio(
+        const std::vector<double>& mu,
+        MatrixView cov,
+        const std::vector<double>& budgets,
+        int maxSweeps = 500,
+        double tol = 1e-8
+    );
 };
 
 #endif
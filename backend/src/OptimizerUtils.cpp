@@ -1,5 +1,7 @@
 #include "OptimizerUtils.h"
+#include <algorithm>
 #include <numeric>
+#include <stdexcept>
 
 namespace OptimizerUtils {
 
@@ -23,4 +25,77 @@ namespace OptimizerUtils {
                 wi /= sum;
         }
     }
+
+    void projectCappedSimplex(
+        std::vector<double>& w,
+        double maxWeight
+    ) {
+        std::vector<std::pair<double, int>> scratch;
+        projectCappedSimplex(w.data(), w.size(), maxWeight, scratch);
+    }
+
+    void projectCappedSimplex(
+        double* w,
+        size_t n,
+        double maxWeight,
+        std::vector<std::pair<double, int>>& scratch
+    ) {
+        if (n == 0) return;
+        double cap = std::min(maxWeight, 1.0);
+        if (cap * n < 1.0 - 1e-12)
+            throw std::invalid_argument("max weight too small for a fully invested portfolio");
+
+        // f(tau) = sum clamp(w_i - tau, 0, cap) is non-increasing and
+        // piecewise linear: coordinate i turns on at tau = w_i (+1 slope)
+        // and saturates at tau = w_i - cap (-1 slope).
+        scratch.clear();
+        for (size_t i = 0; i < n; i++) {
+            scratch.push_back({ w[i], +1 });
+            scratch.push_back({ w[i] - cap, -1 });
+        }
+        std::sort(scratch.begin(), scratch.end(),
+                  [](const auto& a, const auto& b) { return a.first > b.first; });
+
+        double tau = scratch[0].first, f = 0.0;
+        int slope = 0;
+        for (size_t k = 0; k < scratch.size(); k++) {
+            double next = scratch[k].first;
+            double fNext = f + slope * (tau - next);
+            if (fNext >= 1.0 && slope > 0) {
+                tau -= (1.0 - f) / slope;
+                f = 1.0;
+                break;
+            }
+            tau = next;
+            f = fNext;
+            slope += scratch[k].second;
+        }
+        // Every coordinate at the cap (n * cap == 1)
+        if (f < 1.0) tau = scratch.back().first;
+
+        for (size_t i = 0; i < n; i++)
+            w[i] = std::clamp(w[i] - tau, 0.0, cap);
+    }
+
+    double cappedSimplexGap(
+        const double* g,
+        const double* w,
+        size_t n,
+        double maxWeight,
+        std::vector<size_t>& order
+    ) {
+        order.resize(n);
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(),
+                  [&](size_t a, size_t b) { return g[a] < g[b]; });
+        double left = 1.0, best = 0.0, current = 0.0;
+        for (size_t k = 0; k < n && left > 0.0; k++) {
+            double take = std::min(maxWeight, left);
+            best += take * g[order[k]];
+            left -= take;
+        }
+        for (size_t i = 0; i < n; i++)
+            current += g[i] * w[i];
+        return current - best;
+    }
 }
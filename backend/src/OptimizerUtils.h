@@ -1,4 +1,6 @@
 #pragma once
+#include <cstddef>
+#include <utility>
 #include <vector>
 
 namespace OptimizerUtils {
@@ -8,4 +10,30 @@ namespace OptimizerUtils {
         double maxWeight = 0.3
     );
 
+    // Euclidean projection onto { 0 <= w_i <= maxWeight, sum w = 1 }.
+    // Sorts the 2N breakpoints of sum clamp(v - tau, 0, cap), O(N log N).
+    // Throws when N * maxWeight < 1.
+    void projectCappedSimplex(
+        std::vector<double>& w,
+        double maxWeight
+    );
+
+    // Same, reusing `scratch` for the breakpoints across calls
+    void projectCappedSimplex(
+        double* w,
+        size_t n,
+        double maxWeight,
+        std::vector<std::pair<double, int>>& scratch
+    );
+
+    // Frank-Wolfe gap g'w - min_s g's over the same set; the minimizer
+    // fills the smallest gradients up to the cap. `order` is scratch.
+    double cappedSimplexGap(
+        const double* g,
+        const double* w,
+        size_t n,
+        double maxWeight,
+        std::vector<size_t>& order
+    );
+
 }
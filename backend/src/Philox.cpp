@@ -0,0 +1,102 @@
+#include "Philox.h"
+
+#include <cstring>
+
+namespace {
+
+inline double fromBits(uint64_t b) {
+    double d;
+    std::memcpy(&d, &b, sizeof d);
+    return d;
+}
+
+inline uint64_t toBits(double d) {
+    uint64_t b;
+    std::memcpy(&b, &d, sizeof b);
+    return b;
+}
+
+constexpr uint64_t kMantissa = 0xFFFFFFFFFFFFFull;
+constexpr uint64_t kOne = 0x3FF0000000000000ull;
+
+}
+
+// Two passes so each is a plain loop the compiler vectorizes at SSE2:
+// integer Philox rounds into 52-bit words, then the floating-point
+// transform. The second pass builds its uniforms from the words rather
+// than reloading doubles, which keeps the bit tricks vectorizable, and
+// avoids branches (selects would stop if-conversion).
+void Philox4x32::normals(uint64_t path, uint32_t step, size_t count,
+                         double* out, uint64_t* scratch) const {
+    const size_t pairs = (count + 1) / 2;
+    uint64_t* a = scratch;
+    uint64_t* b = scratch + pairs;
+    const uint32_t pathLo = static_cast<uint32_t>(path);
+    const uint32_t pathHi = static_cast<uint32_t>(path >> 32);
+
+    for (size_t k = 0; k < pairs; k++) {
+        uint32_t c0 = pathLo, c1 = pathHi, c2 = step, c3 = static_cast<uint32_t>(k);
+        uint32_t k0 = key[0], k1 = key[1];
+        for (int round = 0; round < 10; round++) {
+            uint64_t p0 = uint64_t(0xD2511F53u) * c0;
+            uint64_t p1 = uint64_t(0xCD9E8D57u) * c2;
+            uint32_t n0 = static_cast<uint32_t>(p1 >> 32) ^ c1 ^ k0;
+            uint32_t n2 = static_cast<uint32_t>(p0 >> 32) ^ c3 ^ k1;
+            c1 = static_cast<uint32_t>(p1);
+            c3 = static_cast<uint32_t>(p0);
+            c0 = n0;
+            c2 = n2;
+            k0 += 0x9E3779B9u;
+            k1 += 0xBB67AE85u;
+        }
+        a[k] = ((uint64_t(c0) << 20) ^ c1) & kMantissa;
+        b[k] = ((uint64_t(c2) << 20) ^ c3) & kMantissa;
+    }
+
+    const double magic = 6755399441055744.0;  // 1.5 * 2^52, rounds to integer
+    const double ln2 = 0.6931471805599453;
+    for (size_t k = 0; k < pairs; k++) {
+        // u1 in (0, 1): [1, 2) from the mantissa bits, shifted by half an ulp
+        double u1 = fromBits(kOne | a[k]) - (1.0 - 0x1.0p-53);
+        uint64_t bits = toBits(u1);
+        double e = fromBits(0x4330000000000000ull | (bits >> 52)) - (4503599627370496.0 + 1023.0);
+        double m = fromBits((bits & kMantissa) | kOne);
+
+        // log m = 2 atanh(s) + ln 2 / 2 with y = m / sqrt 2, |s| < 0.172
+        double y = m * 0.7071067811865476;
+        double s = (y - 1.0) / (y + 1.0), s2 = s * s;
+        double poly = 1.0 / 23;
+        poly = poly * s2 + 1.0 / 21;
+        poly = poly * s2 + 1.0 / 19;
+        poly = poly * s2 + 1.0 / 17;
+        poly = poly * s2 + 1.0 / 15;
+        poly = poly * s2 + 1.0 / 13;
+        poly = poly * s2 + 1.0 / 11;
+        poly = poly * s2 + 1.0 / 9;
+        poly = poly * s2 + 1.0 / 7;
+        poly = poly * s2 + 1.0 / 5;
+        poly = poly * s2 + 1.0 / 3;
+        poly = poly * s2 + 1.0;
+        double logU = 2.0 * s * poly + (e + 0.5) * ln2;
+        double r = std::sqrt(-2.0 * logU);
+
+        // sincos(2 pi u2): reduce to the nearest quarter turn q in [-2, 2]
+        // and x in [-pi/4, pi/4], then rotate by q quarter turns
+        double v = fromBits(kOne | b[k]) - 1.0;
+        v -= (v + magic) - magic;
+        double q = (4.0 * v + magic) - magic;
+        double x = (v - 0.25 * q) * 6.283185307179586;
+        double x2 = x * x;
+        double sn = x * (1.0 + x2 * (-1.0 / 6 + x2 * (1.0 / 120 + x2 * (-1.0 / 5040
+                  + x2 * (1.0 / 362880 + x2 * (-1.0 / 39916800 + x2 * (1.0 / 6227020800.0
+                  + x2 * (-1.0 / 1307674368000.0))))))));
+        double cs = 1.0 + x2 * (-0.5 + x2 * (1.0 / 24 + x2 * (-1.0 / 720 + x2 * (1.0 / 40320
+                  + x2 * (-1.0 / 3628800 + x2 * (1.0 / 479001600.0
+                  + x2 * (-1.0 / 87178291200.0)))))));
+        double aq = std::fabs(q);
+        double cq = 1.0 - aq, sq = q * (2.0 - aq);  // cos, sin of q pi / 2
+
+        out[k] = r * (cq * cs - sq * sn);
+        out[pairs + k] = r * (cq * sn + sq * cs);
+    }
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+// Philox4x32-10 (Salmon et al., "Parallel random numbers: as easy as
+// 1, 2, 3"). A counter-based generator: every output block is a pure
+// function of (key, counter), so a draw can be addressed directly by
+// (seed, path, step) and any split of paths across threads produces the
+// same numbers. No state is carried between calls.
+class Philox4x32 {
+public:
+    using Block = std::array<uint32_t, 4>;
+
+    explicit Philox4x32(uint64_t seed)
+        : key{ static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32) } {}
+
+    Block operator()(Block c) const {
+        uint32_t k0 = key[0], k1 = key[1];
+        for (int round = 0; round < 10; round++) {
+            uint64_t p0 = uint64_t(0xD2511F53u) * c[0];
+            uint64_t p1 = uint64_t(0xCD9E8D57u) * c[2];
+            c = { static_cast<uint32_t>(p1 >> 32) ^ c[1] ^ k0, static_cast<uint32_t>(p1),
+                  static_cast<uint32_t>(p0 >> 32) ^ c[3] ^ k1, static_cast<uint32_t>(p0) };
+            k0 += 0x9E3779B9u;
+            k1 += 0xBB67AE85u;
+        }
+        return c;
+    }
+
+    // Uniform in (0, 1) from 53 bits of two words; never 0, so log() is safe
+    static double uniform(uint32_t hi, uint32_t lo) {
+        uint64_t bits = ((uint64_t(hi) << 32) | lo) >> 11;
+        return (static_cast<double>(bits) + 0.5) * 0x1.0p-53;
+    }
+
+    // Standard normals z[2k], z[2k + 1] of `stream`, by Box-Muller on one
+    // block at counter (stream, k). Draw j of a stream is normal(stream, j / 2)
+    // component j % 2 wherever it is computed.
+    void normalPair(uint64_t stream, uint64_t k, double& z0, double& z1) const {
+        Block b = (*this)({ static_cast<uint32_t>(stream), static_cast<uint32_t>(stream >> 32),
+                            static_cast<uint32_t>(k), static_cast<uint32_t>(k >> 32) });
+        double r = std::sqrt(-2.0 * std::log(uniform(b[0], b[1])));
+        double theta = 6.283185307179586 * uniform(b[2], b[3]);
+        z0 = r * std::cos(theta);
+        z1 = r * std::sin(theta);
+    }
+
+    // `count` standard normals for one (path, step), from the blocks at
+    // counter (path, step, k). Box-Muller is batched over structure-of-
+    // arrays buffers with polynomial log and sincos so the loops
+    // vectorize; draws agree with libm to ~1e-13. Pair k fills out[k] and
+    // out[h + k], h = (count + 1) / 2, so `out` needs room for 2h values;
+    // `scratch` needs 2h words.
+    void normals(uint64_t path, uint32_t step, size_t count,
+                 double* out, uint64_t* scratch) const;
+
+private:
+    std::array<uint32_t, 2> key;
+};
@@ -0,0 +1,99 @@
+#include "PortfolioCache.h"
+
+#include <cstdio>
+
+std::string PortfolioKey::str() const {
+    char rfText[32];
+    std::snprintf(rfText, sizeof(rfText), "%.17g", rf);
+    return std::to_string(version) + "|" + universe + "|" + objective + "|" +
+           rfText + "|" + constraints;
+}
+
+PortfolioCache& PortfolioCache::instance() {
+    static PortfolioCache cache;
+    return cache;
+}
+
+PortfolioCache::PortfolioCache(size_t cap) : capacity(cap) {}
+
+void PortfolioCache::advanceLocked(uint64_t version) {
+    if (version <= currentVersion) return;
+    // Newer data: everything cached so far is stale
+    counters.evictions += lru.size();
+    lru.clear();
+    index.clear();
+    byId.clear();
+    currentVersion = version;
+}
+
+PortfolioPtr PortfolioCache::getOrCompute(const PortfolioKey& key,
+                                          const std::function<CachedPortfolio()>& compute) {
+    std::string k = key.str();
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        advanceLocked(key.version);
+
+        auto it = index.find(k);
+        if (it != index.end()) {
+            counters.hits++;
+            lru.splice(lru.begin(), lru, it->second);
+            return it->second->second;
+        }
+        counters.misses++;
+    }
+
+    CachedPortfolio p = compute();
+    char id[40];
+    std::snprintf(id, sizeof(id), "pf-%llu-%016zx",
+                  static_cast<unsigned long long>(key.version),
+                  std::hash<std::string>{}(k));
+    p.id = id;
+    p.version = key.version;
+    p.objective = key.objective;
+    p.rf = key.rf;
+    auto value = std::make_shared<const CachedPortfolio>(std::move(p));
+
+    std::lock_guard<std::mutex> lock(mtx);
+    if (key.version < currentVersion) return value;  // stale, don't cache
+
+    auto it = index.find(k);
+    if (it != index.end()) return it->second->second;  // raced with another miss
+
+    lru.emplace_front(k, value);
+    index[k] = lru.begin();
+    byId[value->id] = lru.begin();
+    while (lru.size() > capacity) {
+        index.erase(lru.back().first);
+        byId.erase(lru.back().second->id);
+        lru.pop_back();
+        counters.evictions++;
+    }
+    return value;
+}
+
+PortfolioPtr PortfolioCache::find(const std::string& id, uint64_t version) {
+    std::lock_guard<std::mutex> lock(mtx);
+    advanceLocked(version);
+
+    auto it = byId.find(id);
+    if (it == byId.end() || it->second->second->version != version) return nullptr;
+    counters.hits++;
+    lru.splice(lru.begin(), lru, it->second);
+    return it->second->second;
+}
+
+void PortfolioCache::clear() {
+    std::lock_guard<std::mutex> lock(mtx);
+    counters.evictions += lru.size();
+    lru.clear();
+    index.clear();
+    byId.clear();
+}
+
+PortfolioCacheStats PortfolioCache::stats() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    PortfolioCacheStats st = counters;
+    st.entries = lru.size();
+    st.capacity = capacity;
+    return st;
+}
@@ -0,0 +1,82 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Optimizer output over one universe at one data version.
+struct CachedPortfolio {
+    std::string id;
+    uint64_t version = 0;
+    std::string objective;
+    double rf = 0.0;
+    std::vector<std::string> symbols;
+    std::vector<double> weights;   // in symbols order
+    double expectedReturn = 0.0;
+    double risk = 0.0;
+};
+
+using PortfolioPtr = std::shared_ptr<const CachedPortfolio>;
+
+// What a portfolio was optimized for. `universe` identifies the asset
+// set and date range, `constraints` is any canonical text of the
+// constraint set ("" for none).
+struct PortfolioKey {
+    uint64_t version = 0;
+    std::string universe;
+    std::string objective;
+    double rf = 0.0;
+    std::string constraints;
+
+    std::string str() const;
+};
+
+struct PortfolioCacheStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+    size_t entries = 0;
+    size_t capacity = 0;
+};
+
+// Bounded LRU of optimizer results, shared by every endpoint that needs
+// "the" portfolio for a request. Each entry gets a stable id that later
+// requests can pass instead of re-optimizing. Like UniverseCache, a newer
+// data version drops everything built on older ones.
+class PortfolioCache {
+public:
+    static PortfolioCache& instance();
+
+    explicit PortfolioCache(size_t capacity = 1024);
+
+    // Cached result for key, or compute() stored under it. compute runs
+    // outside the lock; concurrent misses on one key may both compute.
+    PortfolioPtr getOrCompute(const PortfolioKey& key,
+                              const std::function<CachedPortfolio()>& compute);
+
+    // By id, for a caller holding data at `version`; nullptr when unknown
+    // or built on another version. A newer version drops older entries
+    // exactly as getOrCompute does.
+    PortfolioPtr find(const std::string& id, uint64_t version);
+
+    void clear();
+    PortfolioCacheStats stats() const;
+
+private:
+    using Entry = std::pair<std::string, PortfolioPtr>;  // key string, value
+
+    void advanceLocked(uint64_t version);
+
+    mutable std::mutex mtx;
+    std::list<Entry> lru;  // most recent first
+    std::unordered_map<std::string, std::list<Entry>::iterator> index;
+    std::unordered_map<std::string, std::list<Entry>::iterator> byId;
+    uint64_t currentVersion = 0;
+
+    size_t capacity;
+    mutable PortfolioCacheStats counters;
+};
@@ -1,6 +1,9 @@
 #include "PortfolioMetrics.h"
 #include <cmath>
 
+#include "FactorModel.h"
+#include "SmallKernels.h"
+
 double PortfolioMetrics::portfolioReturn(
     const std::vector<double>& w,
     const std::vector<double>& mu
@@ -13,18 +16,35 @@ double PortfolioMetrics::portfolioReturn(
 
 double PortfolioMetrics::portfolioVariance(
     const std::vector<double>& w,
-    const std::vector<std::vector<double>>& cov
+    MatrixView cov
 ) {
     double var = 0.0;
-    int n = w.size();
+    size_t n = w.size();
+
+    // Unrolled fixed-size form for small universes
+    if (SmallKernels::quadraticForm(cov, w.data(), n, var)) return var;
 
-    for (int i = 0; i < n; i++)
-        for (int j = 0; j < n; j++)
-            var += w[i] * cov[i][j] * w[j];
+    for (size_t i = 0; i < n; i++) {
+        double s = 0.0;
+        if (cov.rowsContiguous()) {
+            s = dotProduct(cov.rowPtr(i), w.data(), n);
+        } else {
+            for (size_t j = 0; j < n; j++)
+                s += cov(i, j) * w[j];
+        }
+        var += w[i] * s;
+    }
 
     return var;
 }
 
+double PortfolioMetrics::portfolioVariance(
+    const std::vector<double>& w,
+    const FactorModel& model
+) {
+    return model.variance(w);
+}
+
 double PortfolioMetrics::portfolioRisk(double variance) {
     return std::sqrt(std::max(variance, 0.0));
 }
@@ -39,17 +59,21 @@ double PortfolioMetrics::sharpeRatio(
 }
 
 std::vector<double> PortfolioMetrics::portfolioReturnSeries(
-    const std::vector<std::vector<double>>& returns,
+    MatrixView returns,
     const std::vector<double>& weights
 ) {
-    std::vector<double> portfolioReturns;
+    std::vector<double> portfolioReturns(returns.rows());
 
-    for (const auto& row : returns) {
+    for (size_t t = 0; t < returns.rows(); t++) {
         double r = 0.0;
-        for (int i = 0; i < weights.size(); i++)
-            r += weights[i] * row[i];
+        if (returns.rowsContiguous()) {
+            r = dotProduct(returns.rowPtr(t), weights.data(), weights.size());
+        } else {
+            for (size_t i = 0; i < weights.size(); i++)
+                r += weights[i] * returns(t, i);
+        }
 
-        portfolioReturns.push_back(r);
+        portfolioReturns[t] = r;
     }
 
     return portfolioReturns;
@@ -3,6 +3,10 @@
 
 #include <vector>
 
+#include "Matrix.h"
+
+class FactorModel;
+
 class PortfolioMetrics {
 public:
     static double portfolioReturn(
@@ -12,7 +16,13 @@ public:
 
     static double portfolioVariance(
         const std::vector<double>& weights,
-        const std::vector<std::vector<double>>& cov
+        MatrixView cov
+    );
+
+    // O(N K) quadratic form through the factor structure
+    static double portfolioVariance(
+        const std::vector<double>& weights,
+        const FactorModel& model
     );
 
     static double portfolioRisk(double variance);
@@ -24,7 +34,7 @@ public:
     );
 
     static std::vector<double> portfolioReturnSeries(
-        const std::vector<std::vector<double>>& returns,
+        MatrixView returns,
         const std::vector<double>& weights
     );
 
@@ -0,0 +1,395 @@
+#include "PortfolioQP.h"
+#include "PortfolioMetrics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+
+namespace {
+
+constexpr double kInf = QPSolver::kInfinity;
+
+// Risk term of a problem: the sample covariance, or a factor model lifted
+// as y = B'w so the objective is blkdiag(D, F) plus K rows B'w - y = 0
+struct Risk {
+    MatrixView cov;
+    const FactorModel* model = nullptr;
+
+    size_t assets() const { return model ? model->assets() : cov.rows(); }
+
+    double variance(const std::vector<double>& w) const {
+        return model ? model->variance(w) : PortfolioMetrics::portfolioVariance(w, cov);
+    }
+};
+
+void checkSizes(const std::vector<double>& mu, const Risk& risk,
+                const PortfolioConstraints& c) {
+    size_t n = mu.size();
+    if (n == 0 || risk.assets() != n || (!risk.model && risk.cov.cols() != n))
+        throw std::invalid_argument("mean and covariance sizes differ");
+    if ((!c.lower.empty() && c.lower.size() != n) ||
+        (!c.upper.empty() && c.upper.size() != n))
+        throw std::invalid_argument("per-asset bounds need one value per asset");
+    for (const auto& g : c.groups)
+        for (size_t i : g.members)
+            if (i >= n) throw std::invalid_argument("group " + g.name + " has an unknown asset");
+    if (c.hasTurnover() && c.previous.size() != n)
+        throw std::invalid_argument("turnover limit needs previous weights for every asset");
+
+    double lo = 0.0, hi = 0.0;
+    for (size_t i = 0; i < n; i++) {
+        if (c.lowerBound(i) > c.upperBound(i))
+            throw std::invalid_argument("asset lower bound above upper bound");
+        lo += c.lowerBound(i);
+        hi += c.upperBound(i);
+    }
+    if (lo > 1.0 + 1e-12 || hi < 1.0 - 1e-12)
+        throw std::invalid_argument("weight bounds cannot sum to one");
+}
+
+// Objective over `vars` variables with the risk on the first n. A factor
+// model appends its K variables and their rows after everything else, so
+// it goes in once the other rows are built.
+void addRisk(QPProblem& p, const Risk& risk, size_t vars) {
+    size_t n = risk.assets();
+    if (!risk.model) {
+        p.P = Matrix(vars, vars);
+        for (size_t i = 0; i < n; i++)
+            for (size_t j = 0; j < n; j++) p.P(i, j) = risk.cov(i, j);
+        p.q.assign(vars, 0.0);
+        return;
+    }
+
+    const FactorModel& m = *risk.model;
+    const Matrix& B = m.loadings();
+    size_t K = m.factors();
+    p.diagonal.assign(vars + K, 0.0);
+    for (size_t i = 0; i < n; i++) p.diagonal[i] = m.specificVariance()[i];
+    for (size_t k = 0; k < K; k++) p.diagonal[vars + k] = m.factorVariance()[k];
+    p.q.assign(vars + K, 0.0);
+
+    for (size_t k = 0; k < K; k++) {
+        QPRow row{ {}, 0.0, 0.0 };
+        row.terms.reserve(n + 1);
+        for (size_t i = 0; i < n; i++) row.terms.push_back({ i, B(i, k) });
+        row.terms.push_back({ vars + k, -1.0 });
+        p.rows.push_back(std::move(row));
+    }
+}
+
+// Objective, budget, bounds, groups and turnover over x in [0, n)
+QPProblem baseProblem(const Risk& risk, const PortfolioConstraints& c) {
+    size_t n = risk.assets();
+
+    QPProblem p;
+    QPRow budget{ {}, 1.0, 1.0 };
+    for (size_t i = 0; i < n; i++) budget.terms.push_back({ i, 1.0 });
+    p.rows.push_back(std::move(budget));
+
+    for (size_t i = 0; i < n; i++)
+        p.rows.push_back({ { { i, 1.0 } }, c.lowerBound(i), c.upperBound(i) });
+
+    for (const auto& g : c.groups) {
+        QPRow row{ {}, g.minWeight, g.maxWeight };
+        for (size_t i : g.members) row.terms.push_back({ i, 1.0 });
+        p.rows.push_back(std::move(row));
+    }
+
+    if (c.hasTurnover()) {
+        // t_i >= |x_i - prev_i|,  sum t <= maxTurnover
+        QPRow total{ {}, 0.0, c.maxTurnover };
+        for (size_t i = 0; i < n; i++) {
+            p.rows.push_back({ { { i, 1.0 }, { n + i, -1.0 } }, -kInf, c.previous[i] });
+            p.rows.push_back({ { { i, 1.0 }, { n + i, 1.0 } }, c.previous[i], kInf });
+            p.rows.push_back({ { { n + i, 1.0 } }, 0.0, kInf });
+            total.terms.push_back({ n + i, 1.0 });
+        }
+        p.rows.push_back(std::move(total));
+    }
+    addRisk(p, risk, c.hasTurnover() ? 2 * n : n);
+    return p;
+}
+
+ConstrainedPortfolio finish(const std::vector<double>& mu, const Risk& risk,
+                            const PortfolioConstraints& c,
+                            std::vector<double> w, QPResult qp) {
+    // Snap solver noise onto the bounds
+    for (size_t i = 0; i < w.size(); i++) {
+        double lo = c.lowerBound(i), hi = c.upperBound(i);
+        if (std::abs(w[i] - lo) < 1e-9) w[i] = lo;
+        if (std::abs(w[i] - hi) < 1e-9) w[i] = hi;
+    }
+
+    ConstrainedPortfolio out;
+    out.expectedReturn = PortfolioMetrics::portfolioReturn(w, mu);
+    out.risk = PortfolioMetrics::portfolioRisk(risk.variance(w));
+    out.weights = std::move(w);
+    out.qp = std::move(qp);
+    return out;
+}
+
+ConstrainedPortfolio minVarianceFor(const std::vector<double>& mu, const Risk& risk,
+                                    const PortfolioConstraints& c,
+                                    const QPSettings& settings,
+                                    const QPResult* warm) {
+    checkSizes(mu, risk, c);
+    QPProblem p = baseProblem(risk, c);
+    QPResult r = QPSolver::solve(p, settings, warm);
+    std::vector<double> w(r.x.begin(), r.x.begin() + mu.size());
+    return finish(mu, risk, c, std::move(w), std::move(r));
+}
+
+ConstrainedPortfolio targetReturnFor(const std::vector<double>& mu, const Risk& risk,
+                                     double target,
+                                     const PortfolioConstraints& c,
+                                     const QPSettings& settings,
+                                     const QPResult* warm) {
+    checkSizes(mu, risk, c);
+    QPProblem p = baseProblem(risk, c);
+
+    // Scale the row so its coefficients are O(1) like the budget row
+    double scale = 0.0;
+    for (double m : mu) scale = std::max(scale, std::abs(m));
+    scale = scale > 0.0 ? 1.0 / scale : 1.0;
+
+    QPRow row{ {}, target * scale, target * scale };
+    for (size_t i = 0; i < mu.size(); i++) row.terms.push_back({ i, mu[i] * scale });
+    p.rows.insert(p.rows.begin() + 1, std::move(row));
+
+    QPResult r = QPSolver::solve(p, settings, warm);
+    std::vector<double> w(r.x.begin(), r.x.begin() + mu.size());
+    return finish(mu, risk, c, std::move(w), std::move(r));
+}
+
+ConstrainedPortfolio maxSharpeFor(const std::vector<double>& mu, const Risk& risk, double rf,
+                                  const PortfolioConstraints& c,
+                                  const QPSettings& settings,
+                                  const QPResult* warm) {
+    checkSizes(mu, risk, c);
+    if (c.hasTurnover())
+        throw std::invalid_argument("turnover limits are not supported for max Sharpe");
+
+    size_t n = mu.size();
+    double best = -kInf;
+    for (double m : mu) best = std::max(best, m - rf);
+    if (best <= 0.0)
+        throw std::invalid_argument("no asset earns more than the risk-free rate");
+
+    // Variables y (n) and kappa; x = y / kappa. Excess returns are
+    // normalized so y stays O(1).
+    QPProblem p;
+    QPRow excess{ {}, 1.0, 1.0 };
+    for (size_t i = 0; i < n; i++) excess.terms.push_back({ i, (mu[i] - rf) / best });
+    p.rows.push_back(std::move(excess));
+
+    QPRow budget{ { { n, -1.0 } }, 0.0, 0.0 };
+    for (size_t i = 0; i < n; i++) budget.terms.push_back({ i, 1.0 });
+    p.rows.push_back(std::move(budget));
+
+    // Zero bounds leave kappa out of the row so it stays a simple bound
+    auto boundRow = [&](size_t i, double b, double lo, double hi) {
+        QPRow row{ { { i, 1.0 } }, lo, hi };
+        if (b != 0.0) row.terms.push_back({ n, -b });
+        return row;
+    };
+    for (size_t i = 0; i < n; i++) {
+        p.rows.push_back(boundRow(i, c.upperBound(i), -kInf, 0.0));
+        p.rows.push_back(boundRow(i, c.lowerBound(i), 0.0, kInf));
+    }
+    for (const auto& g : c.groups) {
+        QPRow hi{ { { n, -g.maxWeight } }, -kInf, 0.0 };
+        QPRow lo{ { { n, -g.minWeight } }, 0.0, kInf };
+        for (size_t i : g.members) {
+            hi.terms.push_back({ i, 1.0 });
+            lo.terms.push_back({ i, 1.0 });
+        }
+        p.rows.push_back(std::move(hi));
+        p.rows.push_back(std::move(lo));
+    }
+    p.rows.push_back({ { { n, 1.0 } }, 0.0, kInf });
+    addRisk(p, risk, n + 1);
+
+    // A new rf moves the excess row; rescale a warm y, kappa onto it so
+    // only the small change in direction is left to the solver
+    QPResult rescaled;
+    if (warm && warm->x.size() == p.variables() && warm->z.size() == p.rows.size()) {
+        double e = 0.0;
+        for (const auto& t : p.rows[0].terms) e += t.second * warm->x[t.first];
+        if (e > 1e-12) {
+            rescaled = *warm;
+            for (double& v : rescaled.x) v /= e;
+            for (size_t r = 0; r < p.rows.size(); r++) {
+                double v = 0.0;
+                for (const auto& t : p.rows[r].terms) v += t.second * rescaled.x[t.first];
+                rescaled.z[r] = v;
+            }
+            warm = &rescaled;
+        }
+    }
+
+    QPResult r = QPSolver::solve(p, settings, warm);
+    double kappa = r.x[n];
+    if (!(kappa > 1e-12))
+        throw std::runtime_error("max Sharpe problem is infeasible");
+
+    std::vector<double> w(n);
+    for (size_t i = 0; i < n; i++) w[i] = r.x[i] / kappa;
+    return finish(mu, risk, c, std::move(w), std::move(r));
+}
+
+std::vector<ConstrainedPortfolio>
+frontierFor(const std::vector<double>& mu, const Risk& risk, int points,
+            const PortfolioConstraints& c,
+            const QPSettings& settings) {
+    std::vector<ConstrainedPortfolio> out;
+    if (points < 2) return out;
+    out.reserve(points);  // warm points into out must stay valid
+
+    ConstrainedPortfolio gmv = minVarianceFor(mu, risk, c, settings, nullptr);
+    double rmin = gmv.expectedReturn;
+    double rmax = PortfolioQP::maxReturn(mu, c);
+    out.push_back(gmv);
+    // Bounds can pin the minimum-variance portfolio at the top already
+    if (rmax - rmin <= 1e-12 * std::max(1.0, std::abs(rmax))) return out;
+
+    // Target rows shift the row layout, so points warm-start each other
+    // and not the minimum-variance solve
+    const QPResult* warm = nullptr;
+    for (int i = 1; i < points; i++) {
+        double r = rmin + (rmax - rmin) * i / (points - 1);
+        // Pull the last point just inside the boundary
+        if (i == points - 1) r -= 1e-4 * (rmax - rmin);
+        ConstrainedPortfolio p = targetReturnFor(mu, risk, r, c, settings, warm);
+        if (!p.qp.converged) continue;
+        out.push_back(std::move(p));
+        warm = &out.back().qp;
+    }
+    return out;
+}
+
+}
+
+double PortfolioConstraints::lowerBound(size_t i) const {
+    if (!lower.empty()) return lower[i];
+    return longOnly ? 0.0 : -maxWeight;
+}
+
+double PortfolioConstraints::upperBound(size_t i) const {
+    if (!upper.empty()) return upper[i];
+    return maxWeight;
+}
+
+ConstrainedPortfolio
+PortfolioQP::minVariance(const std::vector<double>& mu, MatrixView cov,
+                         const PortfolioConstraints& c,
+                         const QPSettings& settings,
+                         const QPResult* warm) {
+    return minVarianceFor(mu, Risk{ cov }, c, settings, warm);
+}
+
+ConstrainedPortfolio
+PortfolioQP::minVariance(const std::vector<double>& mu, const FactorModel& model,
+                         const PortfolioConstraints& c,
+                         const QPSettings& settings,
+                         const QPResult* warm) {
+    return minVarianceFor(mu, Risk{ {}, &model }, c, settings, warm);
+}
+
+ConstrainedPortfolio
+PortfolioQP::targetReturn(const std::vector<double>& mu, MatrixView cov, double target,
+                          const PortfolioConstraints& c,
+                          const QPSettings& settings,
+                          const QPResult* warm) {
+    return targetReturnFor(mu, Risk{ cov }, target, c, settings, warm);
+}
+
+ConstrainedPortfolio
+PortfolioQP::targetReturn(const std::vector<double>& mu, const FactorModel& model, double target,
+                          const PortfolioConstraints& c,
+                          const QPSettings& settings,
+                          const QPResult* warm) {
+    return targetReturnFor(mu, Risk{ {}, &model }, target, c, settings, warm);
+}
+
+ConstrainedPortfolio
+PortfolioQP::maxSharpe(const std::vector<double>& mu, MatrixView cov, double rf,
+                       const PortfolioConstraints& c,
+                       const QPSettings& settings,
+                       const QPResult* warm) {
+    return maxSharpeFor(mu, Risk{ cov }, rf, c, settings, warm);
+}
+
+ConstrainedPortfolio
+PortfolioQP::maxSharpe(const std::vector<double>& mu, const FactorModel& model, double rf,
+                       const PortfolioConstraints& c,
+                       const QPSettings& settings,
+                       const QPResult* warm) {
+    return maxSharpeFor(mu, Risk{ {}, &model }, rf, c, settings, warm);
+}
+
+double PortfolioQP::maxReturn(const std::vector<double>& mu,
+                              const PortfolioConstraints& c) {
+    size_t n = mu.size();
+    std::vector<size_t> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return mu[a] > mu[b]; });
+
+    // Start every asset at its floor, then fill the best ones up
+    double left = 1.0, ret = 0.0;
+    for (size_t i = 0; i < n; i++) {
+        left -= c.lowerBound(i);
+        ret += c.lowerBound(i) * mu[i];
+    }
+    for (size_t i : order) {
+        double add = std::min(left, c.upperBound(i) - c.lowerBound(i));
+        if (add <= 0.0) break;
+        ret += add * mu[i];
+        left -= add;
+    }
+    return ret;
+}
+
+std::vector<ConstrainedPortfolio>
+PortfolioQP::frontier(const std::vector<double>& mu, MatrixView cov, int points,
+                      const PortfolioConstraints& c,
+                      const QPSettings& settings) {
+    return frontierFor(mu, Risk{ cov }, points, c, settings);
+}
+
+std::vector<ConstrainedPortfolio>
+PortfolioQP::frontier(const std::vector<double>& mu, const FactorModel& model, int points,
+                      const PortfolioConstraints& c,
+                      const QPSettings& settings) {
+    return frontierFor(mu, Risk{ {}, &model }, points, c, settings);
+}
+
+QPWarmStarts& QPWarmStarts::instance() {
+    static QPWarmStarts cache;
+    return cache;
+}
+
+std::shared_ptr<const QPResult> QPWarmStarts::get(const std::string& key) const {
+    std::lock_guard<std::mutex> lock(mtx);
+    auto it = index.find(key);
+    if (it == index.end()) return nullptr;
+    lru.splice(lru.begin(), lru, it->second);
+    return it->second->second;
+}
+
+void QPWarmStarts::put(const std::string& key, QPResult result) {
+    auto value = std::make_shared<const QPResult>(std::move(result));
+    std::lock_guard<std::mutex> lock(mtx);
+    auto it = index.find(key);
+    if (it != index.end()) {
+        it->second->second = std::move(value);
+        lru.splice(lru.begin(), lru, it->second);
+        return;
+    }
+    lru.emplace_front(key, std::move(value));
+    index[key] = lru.begin();
+    if (lru.size() > kCapacity) {
+        index.erase(lru.back().first);
+        lru.pop_back();
+    }
+}
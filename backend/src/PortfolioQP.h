@@ -0,0 +1,134 @@
+#ifndef PORTFOLIO_QP_H
+#define PORTFOLIO_QP_H
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "FactorModel.h"
+#include "Matrix.h"
+#include "QPSolver.h"
+
+struct AssetGroup {
+    std::string name;
+    std::vector<size_t> members;  // asset indices
+    double minWeight = 0.0;
+    double maxWeight = 1.0;
+};
+
+struct PortfolioConstraints {
+    bool longOnly = true;
+    double maxWeight = 1.0;        // per-asset cap (and -cap floor when long-short)
+
+    // Per-asset bounds; override the two fields above when non-empty
+    std::vector<double> lower;
+    std::vector<double> upper;
+
+    std::vector<AssetGroup> groups;
+
+    // sum |w - previous| <= maxTurnover; ignored when maxTurnover < 0
+    std::vector<double> previous;
+    double maxTurnover = -1.0;
+
+    double lowerBound(size_t i) const;
+    double upperBound(size_t i) const;
+    bool hasTurnover() const { return maxTurnover >= 0.0; }
+};
+
+struct ConstrainedPortfolio {
+    std::vector<double> weights;
+    double expectedReturn = 0.0;
+    double risk = 0.0;
+    QPResult qp;                   // raw solver output, for warm starts
+};
+
+// Markowitz problems with real constraints, solved by QPSolver.
+//
+// Every builder adds the budget row, per-asset bounds and group rows;
+// turnover adds one auxiliary variable per asset. Max-Sharpe is solved
+// through the usual homogenization  min y'Sy  s.t. (mu - rf)'y = 1 with
+// the bounds scaled by kappa = 1'y, so it stays a convex QP; turnover
+// does not homogenize and is rejected there.
+//
+// The FactorModel overloads lift y = B'w into K extra variables, so the
+// objective is the diagonal blkdiag(D, F) with K rows B'w - y = 0 and the
+// solver's factorization stays O(N K^2) instead of O(N^3).
+class PortfolioQP {
+public:
+    static ConstrainedPortfolio
+    minVariance(const std::vector<double>& mu, MatrixView cov,
+                const PortfolioConstraints& constraints,
+                const QPSettings& settings = {},
+                const QPResult* warm = nullptr);
+
+    static ConstrainedPortfolio
+    minVariance(const std::vector<double>& mu, const FactorModel& model,
+                const PortfolioConstraints& constraints,
+                const QPSettings& settings = {},
+                const QPResult* warm = nullptr);
+
+    static ConstrainedPortfolio
+    targetReturn(const std::vector<double>& mu, MatrixView cov, double target,
+                 const PortfolioConstraints& constraints,
+                 const QPSettings& settings = {},
+                 const QPResult* warm = nullptr);
+
+    static ConstrainedPortfolio
+    targetReturn(const std::vector<double>& mu, const FactorModel& model, double target,
+                 const PortfolioConstraints& constraints,
+                 const QPSettings& settings = {},
+                 const QPResult* warm = nullptr);
+
+    static ConstrainedPortfolio
+    maxSharpe(const std::vector<double>& mu, MatrixView cov, double rf,
+              const PortfolioConstraints& constraints,
+              const QPSettings& settings = {},
+              const QPResult* warm = nullptr);
+
+    static ConstrainedPortfolio
+    maxSharpe(const std::vector<double>& mu, const FactorModel& model, double rf,
+              const PortfolioConstraints& constraints,
+              const QPSettings& settings = {},
+              const QPResult* warm = nullptr);
+
+    // Target-return points from the constrained minimum-variance return
+    // up to the highest return the bounds allow, each warm-started from
+    // the previous one. Points the solver cannot reach are left out.
+    static std::vector<ConstrainedPortfolio>
+    frontier(const std::vector<double>& mu, MatrixView cov, int points,
+             const PortfolioConstraints& constraints,
+             const QPSettings& settings = {});
+
+    static std::vector<ConstrainedPortfolio>
+    frontier(const std::vector<double>& mu, const FactorModel& model, int points,
+             const PortfolioConstraints& constraints,
+             const QPSettings& settings = {});
+
+    // Highest mu'w under the per-asset bounds and budget (greedy)
+    static double maxReturn(const std::vector<double>& mu,
+                            const PortfolioConstraints& constraints);
+};
+
+// Last solution per problem key (universe, objective, constraints), so a
+// repeat request after new data or a different rf starts from it.
+class QPWarmStarts {
+public:
+    static QPWarmStarts& instance();
+
+    std::shared_ptr<const QPResult> get(const std::string& key) const;
+    void put(const std::string& key, QPResult result);
+
+private:
+    static constexpr size_t kCapacity = 256;
+
+    using Entry = std::pair<std::string, std::shared_ptr<const QPResult>>;
+
+    mutable std::mutex mtx;
+    mutable std::list<Entry> lru;  // most recent first
+    std::unordered_map<std::string, std::list<Entry>::iterator> index;
+};
+
+#endif
@@ -0,0 +1,570 @@
+#include "QPSolver.h"
+#include "Cholesky.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+
+double normInf(const std::vector<double>& v) {
+    double m = 0.0;
+    for (double x : v) m = std::max(m, std::abs(x));
+    return m;
+}
+
+// Stiffer step on equality rows, as in OSQP
+std::vector<double> rowRho(const std::vector<QPRow>& rows, double rho) {
+    std::vector<double> r(rows.size());
+    for (size_t i = 0; i < rows.size(); i++)
+        r[i] = rows[i].lo == rows[i].hi ? rho * 1e3 : rho;
+    return r;
+}
+
+CholeskyFactor factorKKT(const Matrix& P, double sigma,
+                         const std::vector<QPRow>& rows,
+                         const std::vector<double>& rho) {
+    size_t n = P.rows();
+    Matrix K(P);
+    for (size_t i = 0; i < n; i++) K(i, i) += sigma;
+    for (size_t r = 0; r < rows.size(); r++) {
+        const auto& t = rows[r].terms;
+        for (const auto& a : t)
+            for (const auto& b : t)
+                K(a.first, b.first) += rho[r] * a.second * b.second;
+    }
+    return CholeskyFactor::factor(K);
+}
+
+// Step matrix  M = P + sigma I + A' diag(rho) A  of the x-update.
+//
+// A dense P is factored as is. With a diagonal P, M = S + W' R W: W holds
+// the rows with two or more terms over ordinary variables, and S the
+// diagonal, the single-term rows and the rows whose other terms are all
+// hubs (variables in most rows, such as the max-Sharpe scale). S is
+// solved by eliminating the ordinary variables onto the small hub block,
+// and W through Woodbury with the capacitance  R^-1 + W S^-1 W'.
+class StepMatrix {
+public:
+    StepMatrix(const QPProblem& objective, const std::vector<QPRow>& rows, double sigma)
+        : obj(objective), rows(rows), sigma(sigma), n(objective.variables()) {
+        if (!obj.diagonalObjective()) return;
+
+        std::vector<size_t> count(n, 0);
+        for (const auto& r : rows)
+            if (r.terms.size() > 1)
+                for (const auto& t : r.terms) count[t.first]++;
+
+        hubPos.assign(n, kOrdinary);
+        for (size_t i = 0; i < n; i++)
+            if (2 * count[i] > n) {
+                hubPos[i] = hubs.size();
+                hubs.push_back(i);
+            }
+        for (size_t r = 0; r < rows.size(); r++) {
+            size_t ordinary = 0;
+            for (const auto& t : rows[r].terms) ordinary += hubPos[t.first] == kOrdinary;
+            (ordinary > 1 ? coupling : local).push_back(r);
+        }
+
+        // Not worth it: fall back to the dense factorization
+        if (2 * (hubs.size() + coupling.size()) > n) {
+            denseP = Matrix(n, n);
+            for (size_t i = 0; i < n; i++) denseP(i, i) = obj.diagonal[i];
+            hubs.clear();
+            hubPos.clear();
+            local.clear();
+            coupling.clear();
+        } else {
+            structured = true;
+        }
+    }
+
+    void factor(const std::vector<double>& rho) {
+        if (!structured) {
+            full = factorKKT(obj.diagonalObjective() ? denseP : obj.P, sigma, rows, rho);
+            return;
+        }
+
+        // ---- S: diagonal, hub block and ordinary-hub links ----
+        const size_t h = hubs.size();
+        diag.resize(n);
+        for (size_t i = 0; i < n; i++) diag[i] = obj.diagonal[i] + sigma;
+        Matrix hub(h, h);
+        for (size_t a = 0; a < h; a++) hub(a, a) = diag[hubs[a]];
+
+        linkStart.assign(n + 1, 0);
+        struct Link { size_t var, hub; double value; };
+        std::vector<Link> pending;
+        for (size_t r : local) {
+            const auto& t = rows[r].terms;
+            size_t own = kOrdinary;
+            double ownCoef = 0.0;
+            for (const auto& a : t)
+                if (hubPos[a.first] == kOrdinary) {
+                    own = a.first;
+                    ownCoef = a.second;
+                }
+            if (own != kOrdinary) diag[own] += rho[r] * ownCoef * ownCoef;
+            for (const auto& a : t) {
+                size_t ha = hubPos[a.first];
+                if (ha == kOrdinary) continue;
+                if (own != kOrdinary) pending.push_back({ own, ha, rho[r] * ownCoef * a.second });
+                for (const auto& b : t) {
+                    size_t hb = hubPos[b.first];
+                    if (hb != kOrdinary) hub(ha, hb) += rho[r] * a.second * b.second;
+                }
+            }
+        }
+        for (const auto& l : pending) linkStart[l.var + 1]++;
+        for (size_t i = 0; i < n; i++) linkStart[i + 1] += linkStart[i];
+        links.resize(pending.size());
+        std::vector<size_t> fill(linkStart.begin(), linkStart.end() - 1);
+        for (const auto& l : pending) links[fill[l.var]++] = { l.hub, l.value };
+
+        // Schur complement of the ordinary block
+        for (size_t i = 0; i < n; i++)
+            for (size_t a = linkStart[i]; a < linkStart[i + 1]; a++)
+                for (size_t b = linkStart[i]; b < linkStart[i + 1]; b++)
+                    hub(links[a].first, links[b].first) -=
+                        links[a].second * links[b].second / diag[i];
+        if (h > 0) hubFactor = CholeskyFactor::factor(hub);
+
+        // ---- Woodbury: Z = S^-1 W', C = R^-1 + W Z ----
+        const size_t m = coupling.size();
+        Z = Matrix(m, n);
+        for (size_t k = 0; k < m; k++) {
+            double* z = Z.rowPtr(k);
+            for (const auto& t : rows[coupling[k]].terms) z[t.first] = t.second;
+            solveS(z);
+        }
+        Matrix C(m, m);
+        for (size_t a = 0; a < m; a++) {
+            C(a, a) = 1.0 / rho[coupling[a]];
+            for (size_t b = 0; b < m; b++)
+                for (const auto& t : rows[coupling[a]].terms) C(a, b) += t.second * Z(b, t.first);
+        }
+        if (m > 0) capacitance = CholeskyFactor::factor(C);
+    }
+
+    // x <- M^-1 x
+    void solve(std::vector<double>& x) const {
+        if (!structured) {
+            full.forwardSolve(x.data());
+            full.backSolve(x.data());
+            return;
+        }
+        solveS(x.data());
+        const size_t m = coupling.size();
+        if (m == 0) return;
+        std::vector<double> t(m, 0.0);
+        for (size_t k = 0; k < m; k++)
+            for (const auto& a : rows[coupling[k]].terms) t[k] += a.second * x[a.first];
+        capacitance.forwardSolve(t.data());
+        capacitance.backSolve(t.data());
+        for (size_t k = 0; k < m; k++) {
+            const double* z = Z.rowPtr(k);
+            for (size_t i = 0; i < n; i++) x[i] -= t[k] * z[i];
+        }
+    }
+
+private:
+    static constexpr size_t kOrdinary = static_cast<size_t>(-1);
+
+    // In place S^-1 b: hubs first through their Schur complement, then
+    // the ordinary variables from their diagonal
+    void solveS(double* b) const {
+        const size_t h = hubs.size();
+        std::vector<double> xh(h);
+        for (size_t a = 0; a < h; a++) xh[a] = b[hubs[a]];
+        for (size_t i = 0; i < n; i++)
+            for (size_t a = linkStart[i]; a < linkStart[i + 1]; a++)
+                xh[links[a].first] -= links[a].second * b[i] / diag[i];
+        if (h > 0) {
+            hubFactor.forwardSolve(xh.data());
+            hubFactor.backSolve(xh.data());
+        }
+        for (size_t i = 0; i < n; i++) {
+            if (hubPos[i] != kOrdinary) continue;
+            double v = b[i];
+            for (size_t a = linkStart[i]; a < linkStart[i + 1]; a++)
+                v -= links[a].second * xh[links[a].first];
+            b[i] = v / diag[i];
+        }
+        for (size_t a = 0; a < h; a++) b[hubs[a]] = xh[a];
+    }
+
+    const QPProblem& obj;
+    const std::vector<QPRow>& rows;
+    double sigma;
+    size_t n;
+    bool structured = false;
+
+    Matrix denseP;
+    CholeskyFactor full;
+
+    std::vector<size_t> hubs, hubPos;       // hub variables, position or kOrdinary
+    std::vector<size_t> local, coupling;    // row indices
+    std::vector<double> diag;               // S on ordinary variables
+    std::vector<size_t> linkStart;          // per variable, into links
+    std::vector<std::pair<size_t, double>> links;  // (hub position, S entry)
+    CholeskyFactor hubFactor;
+    Matrix Z;                               // S^-1 W', one row per coupling row
+    CholeskyFactor capacitance;
+};
+
+void multiplyA(const std::vector<QPRow>& rows, const std::vector<double>& x,
+               std::vector<double>& out) {
+    for (size_t r = 0; r < rows.size(); r++) {
+        double s = 0.0;
+        for (const auto& t : rows[r].terms) s += t.second * x[t.first];
+        out[r] = s;
+    }
+}
+
+void multiplyAt(const std::vector<QPRow>& rows, const std::vector<double>& y,
+                std::vector<double>& out) {
+    std::fill(out.begin(), out.end(), 0.0);
+    for (size_t r = 0; r < rows.size(); r++)
+        for (const auto& t : rows[r].terms) out[t.first] += t.second * y[r];
+}
+
+void multiplyP(const QPProblem& p, const std::vector<double>& x, std::vector<double>& out) {
+    if (p.diagonalObjective()) {
+        for (size_t i = 0; i < x.size(); i++) out[i] = p.diagonal[i] * x[i];
+        return;
+    }
+    for (size_t i = 0; i < p.P.rows(); i++)
+        out[i] = dotProduct(p.P.rowPtr(i), x.data(), x.size());
+}
+
+// LDL' of a quasi-definite matrix in place (no pivoting needed), then
+// solves K x = b. Returns false on a zero pivot.
+bool ldlSolve(Matrix& K, std::vector<double>& b, bool factored) {
+    size_t n = K.rows();
+    if (!factored) {
+        std::vector<double> t(n);
+        for (size_t j = 0; j < n; j++) {
+            double* rj = K.rowPtr(j);
+            for (size_t k = 0; k < j; k++) t[k] = rj[k] * K(k, k);  // L_jk D_k
+            double d = rj[j] - dotProduct(rj, t.data(), j);
+            if (d == 0.0 || !std::isfinite(d)) return false;
+            rj[j] = d;
+            for (size_t i = j + 1; i < n; i++) {
+                double* ri = K.rowPtr(i);
+                ri[j] = (ri[j] - dotProduct(ri, t.data(), j)) / d;
+            }
+        }
+    }
+    for (size_t i = 0; i < n; i++) b[i] -= dotProduct(K.rowPtr(i), b.data(), i);
+    for (size_t i = 0; i < n; i++) b[i] /= K(i, i);
+    for (size_t i = n; i-- > 0;)
+        for (size_t k = i + 1; k < n; k++) b[i] -= K(k, i) * b[k];
+    return true;
+}
+
+// Active set guessed from (z, y): -1 lower, +1 upper, 0 inactive.
+// Equality rows always count as lower-active.
+std::vector<int> activeSet(const std::vector<QPRow>& rows, const std::vector<double>& z,
+                           const std::vector<double>& y, double rho) {
+    std::vector<int> side(rows.size(), 0);
+    for (size_t r = 0; r < rows.size(); r++) {
+        if (rows[r].lo == rows[r].hi || z[r] - rows[r].lo < -y[r] / rho) side[r] = -1;
+        else if (rows[r].hi - z[r] < y[r] / rho) side[r] = 1;
+    }
+    return side;
+}
+
+// Re-solves the QP with the rows in `side` held at their bounds. On
+// success overwrites x, z, y with the polished point.
+bool polish(const QPProblem& p, const QPSettings& s, const std::vector<int>& side,
+            std::vector<double>& x, std::vector<double>& z, std::vector<double>& y) {
+    const size_t n = p.variables();
+    const size_t m = p.rows.size();
+    const auto& rows = p.rows;
+
+    std::vector<double> target(m, 0.0);
+    for (size_t r = 0; r < m; r++)
+        if (side[r]) target[r] = side[r] < 0 ? rows[r].lo : rows[r].hi;
+
+    // Single-term active rows fix their variable
+    std::vector<char> fixed(n, 0);
+    std::vector<double> xp(n, 0.0);
+    for (size_t r = 0; r < m; r++) {
+        if (!side[r] || rows[r].terms.size() != 1) continue;
+        const auto& t = rows[r].terms[0];
+        if (fixed[t.first] || t.second == 0.0) continue;
+        fixed[t.first] = 1;
+        xp[t.first] = target[r] / t.second;
+    }
+
+    std::vector<size_t> freeVars, general;
+    std::vector<size_t> pos(n, 0);
+    for (size_t i = 0; i < n; i++)
+        if (!fixed[i]) {
+            pos[i] = freeVars.size();
+            freeVars.push_back(i);
+        }
+    for (size_t r = 0; r < m; r++) {
+        if (!side[r]) continue;
+        bool touchesFree = false;
+        for (const auto& t : rows[r].terms) touchesFree |= !fixed[t.first] && t.second != 0.0;
+        if (touchesFree) general.push_back(r);
+    }
+
+    size_t f = freeVars.size(), g = general.size();
+    if (f + g > s.polishMaxSize) return false;
+
+    // [P_FF + dI  G'] [x_F]   [-q_F - P_FX x_X]
+    // [G         -dI] [lam] = [b - G_X x_X    ]
+    const double delta = 1e-9;
+    auto build = [&](Matrix& K, std::vector<double>& rhs) {
+        K = Matrix(f + g, f + g);
+        rhs.assign(f + g, 0.0);
+        for (size_t a = 0; a < f; a++) {
+            size_t i = freeVars[a];
+            if (p.diagonalObjective()) {
+                K(a, a) = p.diagonal[i];
+                rhs[a] = -p.q[i];
+                continue;
+            }
+            const double* Pi = p.P.rowPtr(i);
+            for (size_t b = 0; b < f; b++) K(a, b) = Pi[freeVars[b]];
+            double s2 = p.q[i];
+            for (size_t j = 0; j < n; j++)
+                if (fixed[j]) s2 += Pi[j] * xp[j];
+            rhs[a] = -s2;
+        }
+        for (size_t k = 0; k < g; k++) {
+            double b = target[general[k]];
+            for (const auto& t : rows[general[k]].terms) {
+                if (fixed[t.first]) {
+                    b -= t.second * xp[t.first];
+                } else {
+                    K(f + k, pos[t.first]) += t.second;
+                    K(pos[t.first], f + k) += t.second;
+                }
+            }
+            rhs[f + k] = b;
+        }
+    };
+
+    Matrix K0, K;
+    std::vector<double> rhs;
+    build(K0, rhs);
+    K = K0;
+    for (size_t a = 0; a < f; a++) K(a, a) += delta;
+    for (size_t k = 0; k < g; k++) K(f + k, f + k) -= delta;
+
+    std::vector<double> sol = rhs;
+    if (!ldlSolve(K, sol, false)) return false;
+
+    // Iterative refinement against the unregularized system
+    for (int it = 0; it < 3; it++) {
+        std::vector<double> res(f + g);
+        for (size_t i = 0; i < f + g; i++)
+            res[i] = rhs[i] - dotProduct(K0.rowPtr(i), sol.data(), f + g);
+        ldlSolve(K, res, true);
+        for (size_t i = 0; i < f + g; i++) sol[i] += res[i];
+    }
+
+    std::vector<double> xn = xp;
+    for (size_t a = 0; a < f; a++) xn[freeVars[a]] = sol[a];
+
+    // Duals: general rows from the KKT solve, then the fixing rows take
+    // whatever stationarity still needs on their variable
+    std::vector<double> yn(m, 0.0);
+    for (size_t k = 0; k < g; k++) yn[general[k]] = sol[f + k];
+
+    std::vector<double> grad(n), Aty(n);
+    multiplyP(p, xn, grad);
+    for (size_t i = 0; i < n; i++) grad[i] += p.q[i];
+    multiplyAt(rows, yn, Aty);
+    std::vector<char> assigned(n, 0);
+    for (size_t r = 0; r < m; r++) {
+        if (!side[r] || rows[r].terms.size() != 1) continue;
+        const auto& t = rows[r].terms[0];
+        if (!fixed[t.first] || assigned[t.first] || t.second == 0.0) continue;
+        assigned[t.first] = 1;
+        yn[r] = -(grad[t.first] + Aty[t.first]) / t.second;
+    }
+
+    // Accept only a feasible point with consistent dual signs
+    std::vector<double> zn(m);
+    multiplyA(rows, xn, zn);
+    double scale = std::max(1.0, normInf(zn));
+    double tol = 1e-8 * scale;
+    for (size_t r = 0; r < m; r++) {
+        if (zn[r] < rows[r].lo - tol || zn[r] > rows[r].hi + tol) return false;
+        if (rows[r].lo == rows[r].hi) continue;
+        double ytol = 1e-9 * std::max(1.0, normInf(yn));
+        if (side[r] == -1 && yn[r] > ytol) return false;
+        if (side[r] == 1 && yn[r] < -ytol) return false;
+    }
+
+    x = std::move(xn);
+    for (size_t r = 0; r < m; r++) zn[r] = std::clamp(zn[r], rows[r].lo, rows[r].hi);
+    z = std::move(zn);
+    y = std::move(yn);
+    return true;
+}
+
+}
+
+QPResult QPSolver::solve(const QPProblem& problem,
+                         const QPSettings& s,
+                         const QPResult* warm) {
+    const size_t n = problem.variables();
+    const size_t m = problem.rows.size();
+    const auto& rows = problem.rows;
+
+    if (problem.diagonalObjective() ? problem.diagonal.size() != n
+                                    : problem.P.rows() != n || problem.P.cols() != n)
+        throw std::invalid_argument("QP objective size mismatch");
+    for (const auto& r : rows) {
+        if (r.lo > r.hi) throw std::invalid_argument("QP row with lo > hi");
+        for (const auto& t : r.terms)
+            if (t.first >= n) throw std::invalid_argument("QP row index out of range");
+    }
+
+    // ---- Cost scaling: unit mean diagonal ----
+    double diag = 0.0;
+    for (size_t i = 0; i < n; i++)
+        diag += problem.diagonalObjective() ? problem.diagonal[i] : problem.P(i, i);
+    diag /= std::max<size_t>(n, 1);
+    double c = diag > 0.0 ? 1.0 / diag : 1.0;
+
+    QPProblem scaled;
+    scaled.P = problem.P;
+    for (size_t i = 0; i < scaled.P.size(); i++) scaled.P.data()[i] *= c;
+    scaled.diagonal = problem.diagonal;
+    for (double& v : scaled.diagonal) v *= c;
+    scaled.q = problem.q;
+    for (double& v : scaled.q) v *= c;
+    const std::vector<double>& q = scaled.q;
+
+    // ---- Initial iterate ----
+    QPResult res;
+    std::vector<double>& x = res.x;
+    std::vector<double>& z = res.z;
+    std::vector<double>& y = res.y;
+    double rho = s.rho;
+
+    if (warm && warm->x.size() == n && warm->y.size() == m && warm->z.size() == m) {
+        x = warm->x;
+        z = warm->z;
+        y = warm->y;
+        for (double& v : y) v *= c;
+        if (warm->rho > 0.0) rho = warm->rho;
+        res.warmStarted = true;
+    } else {
+        x.assign(n, 0.0);
+        z.assign(m, 0.0);
+        y.assign(m, 0.0);
+    }
+    for (size_t r = 0; r < m; r++) z[r] = std::clamp(z[r], rows[r].lo, rows[r].hi);
+
+    std::vector<double> rhoVec = rowRho(rows, rho);
+    StepMatrix kkt(scaled, rows, s.sigma);
+    kkt.factor(rhoVec);
+
+    std::vector<double> rhs(n), xt(n), zt(m), w(m), Ax(m), Px(n), Aty(n);
+    std::vector<int> lastSide, triedSide;
+
+    for (int it = 1; it <= s.maxIter; it++) {
+        // x~ = (P + sigma I + A'RA)^-1 (sigma x - q + A'(R z - y))
+        for (size_t r = 0; r < m; r++) w[r] = rhoVec[r] * z[r] - y[r];
+        multiplyAt(rows, w, rhs);
+        for (size_t i = 0; i < n; i++) rhs[i] += s.sigma * x[i] - q[i];
+        xt = rhs;
+        kkt.solve(xt);
+        multiplyA(rows, xt, zt);
+
+        for (size_t i = 0; i < n; i++) x[i] = s.alpha * xt[i] + (1.0 - s.alpha) * x[i];
+        for (size_t r = 0; r < m; r++) {
+            double zr = s.alpha * zt[r] + (1.0 - s.alpha) * z[r];
+            double zn = std::clamp(zr + y[r] / rhoVec[r], rows[r].lo, rows[r].hi);
+            y[r] += rhoVec[r] * (zr - zn);
+            z[r] = zn;
+        }
+        res.iterations = it;
+
+        if (it % s.checkEvery != 0 && it != s.maxIter) continue;
+
+        // ---- Residuals ----
+        multiplyA(rows, x, Ax);
+        multiplyP(scaled, x, Px);
+        multiplyAt(rows, y, Aty);
+
+        double prim = 0.0, dual = 0.0;
+        for (size_t r = 0; r < m; r++) prim = std::max(prim, std::abs(Ax[r] - z[r]));
+        for (size_t i = 0; i < n; i++) dual = std::max(dual, std::abs(Px[i] + q[i] + Aty[i]));
+
+        double primScale = std::max(normInf(Ax), normInf(z));
+        double dualScale = std::max({ normInf(Px), normInf(Aty), normInf(q) });
+        res.primalResidual = prim;
+        res.dualResidual = dual / c;
+
+        if (prim <= s.epsAbs + s.epsRel * primScale &&
+            dual <= s.epsAbs + s.epsRel * dualScale) {
+            res.converged = true;
+            break;
+        }
+
+        // ---- Early polish once the active set stops moving ----
+        if (s.polish) {
+            std::vector<int> side = activeSet(rows, z, y, rho);
+            if (side == lastSide && side != triedSide) {
+                triedSide = side;
+                std::vector<double> xp = x, zp = z, yp(m);
+                for (size_t r = 0; r < m; r++) yp[r] = y[r] / c;
+                if (polish(problem, s, side, xp, zp, yp)) {
+                    x = std::move(xp);
+                    z = std::move(zp);
+                    for (size_t r = 0; r < m; r++) y[r] = yp[r] * c;
+                    res.polished = true;
+                    break;
+                }
+            }
+            lastSide = std::move(side);
+        }
+
+        // ---- Adaptive rho: balance the two residuals ----
+        if (s.adaptiveRho && it % (s.checkEvery * 10) == 0) {
+            double pr = prim / std::max(primScale, 1e-30);
+            double du = dual / std::max(dualScale, 1e-30);
+            double next = std::clamp(rho * std::sqrt(pr / std::max(du, 1e-30)), 1e-6, 1e6);
+            if (next > 5.0 * rho || next < 0.2 * rho) {
+                rho = next;
+                rhoVec = rowRho(rows, rho);
+                kkt.factor(rhoVec);
+            }
+        }
+    }
+
+    for (double& v : y) v /= c;
+    res.rho = rho;
+
+    // Duals are unscaled now, so the active-set test sees rho / c
+    if (!res.polished && s.polish &&
+        polish(problem, s, activeSet(rows, z, y, rho / c), x, z, y))
+        res.polished = true;
+
+    if (res.polished) {
+        res.converged = true;
+        multiplyA(rows, x, Ax);
+        res.primalResidual = 0.0;
+        for (size_t r = 0; r < m; r++)
+            res.primalResidual = std::max(res.primalResidual, std::abs(Ax[r] - z[r]));
+        multiplyP(problem, x, Px);
+        multiplyAt(rows, y, Aty);
+        res.dualResidual = 0.0;
+        for (size_t i = 0; i < n; i++)
+            res.dualResidual = std::max(res.dualResidual, std::abs(Px[i] + problem.q[i] + Aty[i]));
+    }
+
+    multiplyP(problem, x, Px);
+    res.objective = 0.0;
+    for (size_t i = 0; i < n; i++) res.objective += x[i] * (0.5 * Px[i] + problem.q[i]);
+    return res;
+}
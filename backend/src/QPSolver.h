@@ -0,0 +1,86 @@
+#ifndef QP_SOLVER_H
+#define QP_SOLVER_H
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Matrix.h"
+
+// One linear constraint  lo <= sum(coef * x[index]) <= hi.
+// lo == hi makes it an equality; use +-QPSolver::kInfinity for one side.
+struct QPRow {
+    std::vector<std::pair<size_t, double>> terms;
+    double lo;
+    double hi;
+};
+
+//   minimize  1/2 x'Px + q'x   subject to  lo <= A x <= hi
+//
+// A diagonal objective can be given in `diagonal` with P left empty, so
+// lifted factor models never form an n x n matrix.
+struct QPProblem {
+    Matrix P;                   // n x n, symmetric positive semidefinite
+    std::vector<double> diagonal; // n, used instead of P when P is empty
+    std::vector<double> q;      // n
+    std::vector<QPRow> rows;    // A, one sparse row each
+
+    size_t variables() const { return q.size(); }
+    bool diagonalObjective() const { return P.empty(); }
+};
+
+struct QPSettings {
+    double rho = 0.1;
+    double sigma = 1e-6;
+    double alpha = 1.6;         // over-relaxation
+    double epsAbs = 1e-5;
+    double epsRel = 1e-5;
+    int maxIter = 10000;
+    int checkEvery = 5;         // residual check interval
+    bool adaptiveRho = true;
+    bool polish = true;         // exact re-solve on the detected active set
+    size_t polishMaxSize = 800; // skip polishing larger reduced systems
+};
+
+struct QPResult {
+    std::vector<double> x;      // primal solution
+    std::vector<double> z;      // A x, projected onto the bounds
+    std::vector<double> y;      // constraint duals
+    double rho = 0.0;           // step size at exit, reused by warm starts
+    double objective = 0.0;
+    double primalResidual = 0.0;
+    double dualResidual = 0.0;
+    int iterations = 0;
+    bool converged = false;
+    bool warmStarted = false;
+    bool polished = false;
+};
+
+// ADMM solver in the style of OSQP.
+//
+// Each iteration solves one system with the fixed matrix
+// P + sigma I + A' diag(rho) A through a cached Cholesky factor (refactored
+// only when rho adapts), then projects onto the bounds. Equality rows get
+// a stiffer rho. The objective is scaled to unit mean diagonal internally.
+// With a diagonal objective that matrix is split into a diagonal part,
+// a few "hub" variables that appear in most rows, and the handful of rows
+// coupling many variables, which enter through Woodbury; factoring then
+// costs O(n m^2) for m such rows instead of O(n^3).
+//
+// ADMM only runs to a modest tolerance; polishing then guesses the active
+// set from the duals, fixes variables at active bounds and solves the
+// remaining equality-constrained QP exactly through its quasi-definite
+// KKT system. The polished point is kept when it is feasible and its
+// duals have the right signs. Passing the previous result warm-starts
+// x, z, y and rho, so re-solves after a small change in the data usually
+// finish in a few iterations.
+class QPSolver {
+public:
+    static constexpr double kInfinity = 1e30;
+
+    static QPResult solve(const QPProblem& problem,
+                          const QPSettings& settings = {},
+                          const QPResult* warm = nullptr);
+};
+
+#endif
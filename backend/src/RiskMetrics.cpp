@@ -1,20 +1,309 @@
 #include "RiskMetrics.h"
 #include "PortfolioMetrics.h"
+#include "Philox.h"
+#include "Sobol.h"
+#include "Statistics.h"
+#include "ThreadPool.h"
 #include <vector>
 #include <bits/stdc++.h>
 
+namespace {
+
+// Values at levels q of v as the sorted slice would give them, at index
+// floor(q n); one nth_element per level, each over the range above the
+// previous rank. v is reordered.
+void selectPercentiles(double* v, size_t n, const std::vector<double>& levels, double* out) {
+    std::vector<std::pair<size_t, size_t>> ranks(levels.size());
+    for (size_t k = 0; k < levels.size(); k++)
+        ranks[k] = { std::min(n - 1, static_cast<size_t>(levels[k] * n)), k };
+    std::sort(ranks.begin(), ranks.end());
+
+    size_t from = 0;
+    for (const auto& [rank, k] : ranks) {
+        if (rank >= from) {
+            std::nth_element(v + from, v + rank, v + n);
+            from = rank + 1;
+        }
+        out[k] = v[rank];
+    }
+}
+
+// ES from VaR and the sum of the `index` returns below it, over a tail
+// of `mass` observations: VaR + sum of (loss - VaR) / mass
+double shortfall(double var, double below, size_t index, double mass) {
+    if (index == 0 || !(mass > 0.0)) return var;
+    return var + (-below - index * var) / mass;
+}
+
+// Window contents as Fenwick trees over return ranks: counts, and sums of
+// the returns at those ranks
+class RankWindow {
+public:
+    explicit RankWindow(size_t n) : count(n + 1, 0), sum(n + 1, 0.0), top(1) {
+        while (top * 2 <= n) top *= 2;
+    }
+
+    void add(size_t rank, double value, int delta) {
+        for (size_t i = rank + 1; i < count.size(); i += i & (0 - i)) {
+            count[i] += delta;
+            sum[i] += value;
+        }
+    }
+
+    // Rank of the element with `index` smaller ones in the window; `below`
+    // gets their sum
+    size_t select(size_t index, double& below) const {
+        size_t pos = 0, need = index + 1;
+        below = 0.0;
+        for (size_t step = top; step > 0; step /= 2) {
+            size_t next = pos + step;
+            if (next < count.size() && static_cast<size_t>(count[next]) < need) {
+                pos = next;
+                need -= count[next];
+                below += sum[next];
+            }
+        }
+        return pos;  // 1-based position pos + 1, i.e. rank pos
+    }
+
+private:
+    std::vector<int> count;
+    std::vector<double> sum;
+    size_t top;
+};
+
+constexpr int kTileSteps = 16;     // even, so Box-Muller pairs never straddle tiles
+constexpr size_t kBlockPaths = 256;
+constexpr int kMinBatches = 4;     // before a batch spread counts as an error estimate
+
+// Brownian-bridge point: W(t) = wl W(left) + wr W(right) + sd z, where z
+// is the normal of bridge dimension `dim`
+struct BridgeStep {
+    int t, left, right, dim;
+    double wl, wr, sd;
+};
+
+BridgeStep bridgeStep(int t, int left, int right, int dim) {
+    double span = right - left;
+    return { t, left, right, dim, (right - t) / span, (t - left) / span,
+             std::sqrt((t - left) * (right - t) / span) };
+}
+
+// Construction order: W(H), tile boundaries by bisection, then interior
+// points breadth first across all tiles, so the moves that carry most of
+// the variance come first and take the Sobol' dimensions. Boundaries
+// first also lets tiles be filled one at a time from W at their ends.
+struct BridgePlan {
+    std::vector<BridgeStep> boundary;            // W at 16, 32, ..., H
+    std::vector<std::vector<BridgeStep>> tiles;  // interior points per tile
+};
+
+// Slot of a boundary time in a path's boundary array
+int boundarySlot(int t) { return (t + kTileSteps - 1) / kTileSteps; }
+
+BridgePlan bridgePlan(int H) {
+    const int K = boundarySlot(H);
+    auto at = [&](int k) { return std::min(k * kTileSteps, H); };
+    BridgePlan plan;
+    int dim = 0;
+    plan.boundary.push_back({ H, 0, 0, dim++, 0.0, 0.0, std::sqrt(static_cast<double>(H)) });
+
+    std::deque<std::array<int, 3>> spans{ { -1, 0, K } };  // tile, lo, hi
+    while (!spans.empty()) {
+        auto [tile, lo, hi] = spans.front();
+        spans.pop_front();
+        if (hi - lo < 2) continue;
+        int mid = (lo + hi) / 2;
+        plan.boundary.push_back(bridgeStep(at(mid), at(lo), at(hi), dim++));
+        spans.push_back({ tile, lo, mid });
+        spans.push_back({ tile, mid, hi });
+    }
+
+    plan.tiles.resize(K);
+    for (int k = 0; k < K; k++) spans.push_back({ k, at(k), at(k + 1) });
+    while (!spans.empty()) {
+        auto [tile, lo, hi] = spans.front();
+        spans.pop_front();
+        if (hi - lo < 2) continue;
+        int mid = (lo + hi) / 2;
+        plan.tiles[tile].push_back(bridgeStep(mid, lo, hi, dim++));
+        spans.push_back({ tile, lo, mid });
+        spans.push_back({ tile, mid, hi });
+    }
+    return plan;
+}
+
+// One batch of the streamed summary: percentiles into `bands`, means
+// into `mean`, terminal values into `terminal` and leading full paths
+// into `samples` (may have no rows). Batch `replicate` uses paths
+// replicate * paths onwards, or the replicate-th Sobol' scramble.
+void runBatch(double mu_p, double sigma_p, const MonteCarloOptions& options,
+              uint64_t replicate, const BridgePlan& plan, ThreadPool& pool,
+              Matrix& bands, std::vector<double>& mean, Matrix& samples,
+              double* terminal) {
+    const int H = options.horizon;
+    const size_t paths = static_cast<size_t>(options.paths);
+    const size_t blocks = (paths + kBlockPaths - 1) / kBlockPaths;
+    const uint64_t base = replicate * paths;
+    const bool sobol = options.sampling == Sampling::Sobol;
+    const bool antithetic = options.sampling == Sampling::Antithetic;
+    const bool cv = options.controlVariate;
+    const auto& levels = options.percentiles;
+    const Philox4x32 rng(options.seed);
+
+    // Sobol' coordinates for the leading bridge dimensions
+    std::unique_ptr<Sobol> points;
+    int sobolDims = 0;
+    if (sobol) {
+        sobolDims = std::min(Sobol::kMaxDims, H);
+        points = std::make_unique<Sobol>(sobolDims, options.seed, replicate);
+    }
+
+    // Lognormal twin: log step m + s z has the mean and variance of
+    // 1 + mu + sigma z, and known quantiles at every step
+    const double s2 = std::log1p(sigma_p * sigma_p / ((1.0 + mu_p) * (1.0 + mu_p)));
+    const double s = std::sqrt(s2), m = std::log1p(mu_p) - 0.5 * s2;
+    std::vector<double> levelZ(levels.size());
+    for (size_t k = 0; k < levels.size(); k++) levelZ[k] = Statistics::normalQuantile(levels[k]);
+
+    // Sobol: W at the tile boundaries of every path, before any tile
+    const int K = boundarySlot(H);
+    std::vector<double> boundary;
+    if (sobol) {
+        boundary.resize(paths * (K + 1));
+        pool.parallelFor(blocks, [&](size_t b) {
+            size_t end = std::min(paths, (b + 1) * kBlockPaths);
+            for (size_t i = b * kBlockPaths; i < end; i++) {
+                double* w = boundary.data() + i * (K + 1);
+                w[0] = 0.0;
+                for (const BridgeStep& step : plan.boundary) {
+                    double z;
+                    if (step.dim < sobolDims) {
+                        z = Statistics::normalQuantile((*points)(static_cast<uint32_t>(i), step.dim));
+                    } else {
+                        double z0, z1;
+                        rng.normalPair(base + i, static_cast<uint64_t>(step.t / 2), z0, z1);
+                        z = step.t % 2 ? z1 : z0;
+                    }
+                    w[boundarySlot(step.t)] = step.wl * w[boundarySlot(step.left)]
+                                            + step.wr * w[boundarySlot(step.right)] + step.sd * z;
+                }
+            }
+        });
+    }
+
+    // Tiles hold step-major slices: tile[j * paths + i]
+    std::vector<double> value(paths, 1.0), twin(cv ? paths : 0, 1.0);
+    std::vector<double> tile(paths * kTileSteps), twinTile(cv ? paths * kTileSteps : 0);
+    std::vector<double> blockSums(blocks * kTileSteps), twinSums(cv ? blocks * kTileSteps : 0);
+
+    for (int t0 = 0; t0 < H; t0 += kTileSteps) {
+        const int n = std::min(kTileSteps, H - t0);
+
+        pool.parallelFor(blocks, [&](size_t b) {
+            double* sums = blockSums.data() + b * kTileSteps;
+            std::fill(sums, sums + kTileSteps, 0.0);
+            double* xSums = cv ? twinSums.data() + b * kTileSteps : nullptr;
+            if (cv) std::fill(xSums, xSums + kTileSteps, 0.0);
+
+            size_t end = std::min(paths, (b + 1) * kBlockPaths);
+            for (size_t i = b * kBlockPaths; i < end; i++) {
+                const uint64_t g = base + i;
+                double z[kTileSteps];
+                if (sobol) {
+                    // Interior of the tile by bridge from W at its ends;
+                    // Philox normals keyed by time for the trailing dims
+                    double draws[kTileSteps + 2], w[kTileSteps + 1];
+                    for (int t = t0; t <= t0 + n; t += 2)
+                        rng.normalPair(g, static_cast<uint64_t>(t / 2), draws[t - t0], draws[t - t0 + 1]);
+                    const double* wb = boundary.data() + i * (K + 1);
+                    const int k = t0 / kTileSteps;
+                    w[0] = wb[k];
+                    w[n] = wb[k + 1];
+                    for (const BridgeStep& step : plan.tiles[k]) {
+                        double zs = step.dim < sobolDims
+                            ? Statistics::normalQuantile((*points)(static_cast<uint32_t>(i), step.dim))
+                            : draws[step.t - t0];
+                        w[step.t - t0] = step.wl * w[step.left - t0] + step.wr * w[step.right - t0]
+                                       + step.sd * zs;
+                    }
+                    for (int j = 0; j < n; j++) z[j] = w[j + 1] - w[j];
+                } else {
+                    // Antithetic partners share the draws of stream g / 2
+                    const uint64_t stream = antithetic ? g / 2 : g;
+                    const double sign = antithetic && (g & 1) ? -1.0 : 1.0;
+                    for (int j = 0; j < n; j += 2) {
+                        rng.normalPair(stream, static_cast<uint64_t>((t0 + j) / 2), z[j], z[j + 1]);
+                        z[j] *= sign;
+                        z[j + 1] *= sign;
+                    }
+                }
+
+                double v = value[i];
+                for (int j = 0; j < n; j++) {
+                    v *= 1.0 + mu_p + sigma_p * z[j];
+                    tile[j * paths + i] = v;
+                    sums[j] += v;
+                }
+                value[i] = v;
+                if (cv) {
+                    double x = twin[i];
+                    for (int j = 0; j < n; j++) {
+                        x *= std::exp(m + s * z[j]);
+                        twinTile[j * paths + i] = x;
+                        xSums[j] += x;
+                    }
+                    twin[i] = x;
+                }
+                if (i < samples.rows())
+                    for (int j = 0; j < n; j++)
+                        samples(i, t0 + j) = tile[j * paths + i];
+            }
+        });
+
+        // Block order, not completion order, keeps the means reproducible.
+        // The twin's mean is exactly (1 + mu)^t.
+        for (int j = 0; j < n; j++) {
+            double sum = 0.0, xSum = 0.0;
+            for (size_t b = 0; b < blocks; b++) {
+                sum += blockSums[b * kTileSteps + j];
+                if (cv) xSum += twinSums[b * kTileSteps + j];
+            }
+            mean[t0 + j] = sum / paths;
+            if (cv) mean[t0 + j] += std::pow(1.0 + mu_p, t0 + j + 1) - xSum / paths;
+        }
+
+        if (levels.empty()) continue;
+        pool.parallelFor(static_cast<size_t>(n), [&](size_t j) {
+            std::vector<double> picked(levels.size()), twinPicked(levels.size());
+            selectPercentiles(tile.data() + j * paths, paths, levels, picked.data());
+            if (cv) selectPercentiles(twinTile.data() + j * paths, paths, levels, twinPicked.data());
+            const double t = static_cast<double>(t0 + j + 1);
+            for (size_t k = 0; k < levels.size(); k++) {
+                double q = picked[k];
+                if (cv && std::isfinite(levelZ[k]))
+                    q += std::exp(t * m + std::sqrt(t) * s * levelZ[k]) - twinPicked[k];
+                bands(k, t0 + j) = q;
+            }
+        });
+    }
+
+    std::copy(value.begin(), value.end(), terminal);
+}
+
+}
+
+// The shocks touch the mean or scale the covariance, so each is the
+// base quadratic form plus an O(1) or O(N) change to the mean; nothing is
+// copied. StressEngine does the same for whole grids of scenarios.
 StressResult RiskMetrics::marketCrash(
     const std::vector<double>& weights,
     const std::vector<double>& mu,
-    const std::vector<std::vector<double>>& cov,
+    MatrixView cov,
     double crashPct
 ) {
-    std::vector<double> shockedMu = mu;
-    for (double& m : shockedMu)
-        m *= (1.0 - crashPct);
-
     double ret =
-        PortfolioMetrics::portfolioReturn(weights, shockedMu);
+        (1.0 - crashPct) * PortfolioMetrics::portfolioReturn(weights, mu);
 
     double risk =
         PortfolioMetrics::portfolioRisk(
@@ -26,15 +315,16 @@ StressResult RiskMetrics::marketCrash(
 StressResult RiskMetrics::singleAssetShock(
     const std::vector<double>& weights,
     const std::vector<double>& mu,
-    const std::vector<std::vector<double>>& cov,
+    MatrixView cov,
     int assetIndex,
     double shockPct
 ) {
-    std::vector<double> shockedMu = mu;
-    shockedMu[assetIndex] *= (1.0 - shockPct);
+    if (assetIndex < 0 || static_cast<size_t>(assetIndex) >= mu.size())
+        throw std::invalid_argument("asset_index out of range");
 
     double ret =
-        PortfolioMetrics::portfolioReturn(weights, shockedMu);
+        PortfolioMetrics::portfolioReturn(weights, mu)
+        - weights[assetIndex] * mu[assetIndex] * shockPct;
 
     double risk =
         PortfolioMetrics::portfolioRisk(
@@ -46,125 +336,273 @@ StressResult RiskMetrics::singleAssetShock(
 StressResult RiskMetrics::volatilitySpike(
     const std::vector<double>& weights,
     const std::vector<double>& mu,
-    const std::vector<std::vector<double>>& cov,
+    MatrixView cov,
     double spikeFactor
 ) {
-    std::vector<std::vector<double>> shockedCov = cov;
-    for (auto& row : shockedCov)
-        for (double& x : row)
-            x *= spikeFactor;
-
+    // Covariance scaled by spikeFactor: the variance scales with it
     double ret =
         PortfolioMetrics::portfolioReturn(weights, mu);
 
     double risk =
         PortfolioMetrics::portfolioRisk(
-            PortfolioMetrics::portfolioVariance(weights, shockedCov));
+            spikeFactor * PortfolioMetrics::portfolioVariance(weights, cov));
 
     return { ret, risk };
 }
 
+size_t RiskMetrics::tailRank(size_t n, double confidence) {
+    // The nudge keeps products like 0.05 * 100 = 5.000000000000004 and
+    // 0.1 * 10 = 0.9999999999999998 on their whole number
+    double at = std::floor((1.0 - confidence) * n + 1e-9);
+    return static_cast<size_t>(std::clamp(at, 0.0, static_cast<double>(n - 1)));
+}
+
+void RiskMetrics::lossTail(std::vector<double>& losses, double confidence,
+                           double& var, double& es) {
+    if (losses.empty()) {
+        var = es = 0.0;
+        return;
+    }
+
+    size_t rank = tailRank(losses.size(), confidence);
+    std::nth_element(losses.begin(), losses.begin() + rank, losses.end(),
+                     std::greater<double>());
+    var = losses[rank];
+    double excess = 0.0;
+    for (size_t i = 0; i < rank; i++) excess += losses[i] - var;
+    es = rank ? var + excess / ((1.0 - confidence) * losses.size()) : var;
+}
+
 double RiskMetrics::historicalVaR(
     const std::vector<double>& portfolioReturns,
     double confidence
 ) {
-    if (portfolioReturns.empty())
-        return 0.0;
-
-    std::vector<double> sorted = portfolioReturns;
-    std::sort(sorted.begin(), sorted.end());
-
-    int index = static_cast<int>(
-        (1.0 - confidence) * sorted.size()
-    );
-
-    index = std::max(0, std::min(index, (int)sorted.size() - 1));
+    std::vector<double> losses(portfolioReturns.size());
+    for (size_t i = 0; i < losses.size(); i++) losses[i] = -portfolioReturns[i];
+    double var, es;
+    lossTail(losses, confidence, var, es);
+    return var;
+}
 
-    // VaR is reported as a positive loss
-    return -sorted[index];
+double RiskMetrics::historicalES(
+    const std::vector<double>& portfolioReturns,
+    double confidence
+) {
+    std::vector<double> losses(portfolioReturns.size());
+    for (size_t i = 0; i < losses.size(); i++) losses[i] = -portfolioReturns[i];
+    double var, es;
+    lossTail(losses, confidence, var, es);
+    return es;
 }
 
-MonteCarloResult RiskMetrics::monteCarloSimulation(
-    const std::vector<double>& weights,
-    const std::vector<double>& mu,
-    const std::vector<std::vector<double>>& cov,
-    int numSimulations,
-    int horizon
+RollingTailRisk RiskMetrics::rollingTailRisk(
+    const std::vector<double>& portfolioReturns,
+    size_t window,
+    const std::vector<double>& confidences
 ) {
-    MonteCarloResult result;
-    result.paths.resize(numSimulations, std::vector<double>(horizon));
+    const size_t n = portfolioReturns.size();
+    if (window < 1 || window > n)
+        throw std::invalid_argument("window must be between 1 and the number of returns");
+    for (double c : confidences)
+        if (!(c > 0.0 && c < 1.0))
+            throw std::invalid_argument("confidence levels must be in (0, 1)");
 
-    // ---- Portfolio mean ----
-    double mu_p = 0.0;
-    for (size_t i = 0; i < weights.size(); i++) {
-        mu_p += weights[i] * mu[i];
-    }
+    // Ranks by (return, position), so equal returns stay distinct
+    std::vector<uint32_t> order(n), rank(n);
+    for (size_t i = 0; i < n; i++) order[i] = static_cast<uint32_t>(i);
+    std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+        return portfolioReturns[a] < portfolioReturns[b] ||
+               (portfolioReturns[a] == portfolioReturns[b] && a < b);
+    });
+    for (size_t r = 0; r < n; r++) rank[order[r]] = static_cast<uint32_t>(r);
 
-    // ---- Portfolio variance ----
-    double var_p = 0.0;
-    for (size_t i = 0; i < weights.size(); i++) {
-        for (size_t j = 0; j < weights.size(); j++) {
-            var_p += weights[i] * weights[j] * cov[i][j];
-        }
-    }
-    double sigma_p = std::sqrt(var_p);
-
-    std::mt19937 gen(42); // deterministic
-    std::normal_distribution<double> dist(mu_p, sigma_p);
-
-    // ---- Simulate paths ----
-    for (int s = 0; s < numSimulations; s++) {
-        double value = 1.0;
-        for (int t = 0; t < horizon; t++) {
-            double r = dist(gen);
-            value *= (1.0 + r);
-            result.paths[s][t] = value;
-        }
-    }
+    RankWindow tree(n);
+    const size_t L = confidences.size(), steps = n - window + 1;
+    RollingTailRisk out;
+    out.window = window;
+    out.confidences = confidences;
+    out.var = Matrix(L, steps);
+    out.es = Matrix(L, steps);
 
-    // ---- Percentiles ----
-    result.p5.resize(horizon);
-    result.p50.resize(horizon);
-    result.p95.resize(horizon);
+    std::vector<size_t> index(L);
+    for (size_t k = 0; k < L; k++) index[k] = tailRank(window, confidences[k]);
 
-    for (int t = 0; t < horizon; t++) {
-        std::vector<double> slice;
-        slice.reserve(numSimulations);
+    for (size_t t = 0; t < n; t++) {
+        tree.add(rank[t], portfolioReturns[t], 1);
+        if (t + 1 < window) continue;
+        if (t >= window) tree.add(rank[t - window], -portfolioReturns[t - window], -1);
 
-        for (int s = 0; s < numSimulations; s++) {
-            slice.push_back(result.paths[s][t]);
+        size_t col = t + 1 - window;
+        for (size_t k = 0; k < L; k++) {
+            double below;
+            size_t r = tree.select(index[k], below);
+            double var = -portfolioReturns[order[r]];
+            out.var(k, col) = var;
+            out.es(k, col) = shortfall(var, below, index[k], (1.0 - confidences[k]) * window);
         }
-
-        std::sort(slice.begin(), slice.end());
-
-        result.p5[t]  = slice[(int)(0.05 * numSimulations)];
-        result.p50[t] = slice[(int)(0.50 * numSimulations)];
-        result.p95[t] = slice[(int)(0.95 * numSimulations)];
     }
+    return out;
+}
 
-    return result;
+Matrix
+RiskMetrics::monteCarloPortfolioPaths(
+    double mu_p,
+    double sigma_p,
+    int numSim,
+    int horizon,
+    uint64_t seed
+) {
+    return monteCarloPortfolioPaths(
+        mu_p, sigma_p, numSim, horizon, seed, ThreadPool::shared());
 }
 
-std::vector<std::vector<double>>
+Matrix
 RiskMetrics::monteCarloPortfolioPaths(
     double mu_p,
     double sigma_p,
     int numSim,
-    int horizon
+    int horizon,
+    uint64_t seed,
+    ThreadPool& pool
 ) {
-    std::mt19937 rng(std::random_device{}());
-    std::normal_distribution<double> dist(mu_p, sigma_p);
-
-    std::vector<std::vector<double>> paths(numSim,
-        std::vector<double>(horizon, 1.0));
-
-    for (int i = 0; i < numSim; i++) {
-        double value = 1.0;
-        for (int t = 0; t < horizon; t++) {
-            double ret = dist(rng);
-            value *= (1.0 + ret);
-            paths[i][t] = value;
+    if (numSim < 1 || horizon < 1)
+        throw std::invalid_argument("num_simulations and horizon must be positive");
+
+    Matrix paths(numSim, horizon);
+    const Philox4x32 rng(seed);
+
+    // Blocks of paths per task; a path's draws depend only on its index
+    const size_t block = 256;
+    size_t blocks = (static_cast<size_t>(numSim) + block - 1) / block;
+    pool.parallelFor(blocks, [&](size_t b) {
+        size_t end = std::min(static_cast<size_t>(numSim), (b + 1) * block);
+        for (size_t i = b * block; i < end; i++) {
+            double* row = paths.rowPtr(i);
+            double value = 1.0;
+            for (int t = 0; t < horizon; t += 2) {
+                double z0, z1;
+                rng.normalPair(i, static_cast<uint64_t>(t / 2), z0, z1);
+                value *= 1.0 + mu_p + sigma_p * z0;
+                row[t] = value;
+                if (t + 1 < horizon) {
+                    value *= 1.0 + mu_p + sigma_p * z1;
+                    row[t + 1] = value;
+                }
+            }
         }
-    }
+    });
     return paths;
 }
+
+MonteCarloSummary
+RiskMetrics::monteCarloSummary(
+    double mu_p,
+    double sigma_p,
+    const MonteCarloOptions& options
+) {
+    return monteCarloSummary(mu_p, sigma_p, options, ThreadPool::shared());
+}
+
+MonteCarloSummary
+RiskMetrics::monteCarloSummary(
+    double mu_p,
+    double sigma_p,
+    const MonteCarloOptions& options,
+    ThreadPool& pool
+) {
+    const int P = options.paths, H = options.horizon;
+    if (P < 1 || H < 1)
+        throw std::invalid_argument("num_simulations and horizon must be positive");
+    for (double q : options.percentiles)
+        if (!(q >= 0.0 && q <= 1.0))
+            throw std::invalid_argument("percentiles must be in [0, 1]");
+    if (options.histogramBins < 0 || options.samplePaths < 0 || options.samplePaths > P)
+        throw std::invalid_argument("histogram_bins and sample_paths must be in range");
+    if (options.sampling == Sampling::Antithetic && P % 2 != 0)
+        throw std::invalid_argument("antithetic sampling needs an even num_simulations");
+    if (options.controlVariate && !(mu_p > -1.0))
+        throw std::invalid_argument("the control variate needs a mean return above -100%");
+    const bool targeted = options.targetStdError > 0.0;
+    if (options.targetStdError < 0.0 ||
+        (targeted && options.maxPaths / kMinBatches < P))
+        throw std::invalid_argument("target_std_error must be positive and max_simulations allow four batches");
+
+    BridgePlan plan;
+    if (options.sampling == Sampling::Sobol) plan = bridgePlan(H);
+
+    const size_t paths = static_cast<size_t>(P);
+    const size_t levels = options.percentiles.size();
+    MonteCarloSummary out;
+    out.samplePaths = Matrix(options.samplePaths, H);
+    std::vector<double> terminal;
+
+    if (!targeted) {
+        out.bands = Matrix(levels, H);
+        out.mean.assign(H, 0.0);
+        terminal.resize(paths);
+        runBatch(mu_p, sigma_p, options, 0, plan, pool,
+                 out.bands, out.mean, out.samplePaths, terminal.data());
+        out.pathsUsed = P;
+        out.batches = 1;
+        out.stdError = std::nan("");
+    } else {
+        // Batch estimates as deviations from the first batch, which keeps
+        // the variance sums free of cancellation
+        Matrix bands(levels, H), noSamples(0, H);
+        std::vector<double> mean(H);
+        const size_t cells = (levels + 1) * H;
+        std::vector<double> first(cells), sum(cells, 0.0), sumSq(cells, 0.0);
+        int b = 0;
+        for (;;) {
+            terminal.resize((b + 1) * paths);
+            runBatch(mu_p, sigma_p, options, static_cast<uint64_t>(b), plan, pool,
+                     bands, mean, b == 0 ? out.samplePaths : noSamples,
+                     terminal.data() + b * paths);
+            for (size_t c = 0; c < cells; c++) {
+                double x = c < levels * H ? bands.data()[c] : mean[c - levels * H];
+                if (b == 0) first[c] = x;
+                double d = x - first[c];
+                sum[c] += d;
+                sumSq[c] += d * d;
+            }
+            b++;
+
+            if (b < kMinBatches) continue;
+            double worst = 0.0;
+            for (size_t c = 0; c < cells; c++) {
+                double var = (sumSq[c] - sum[c] * sum[c] / b) / (b - 1);
+                worst = std::max(worst, var / b);
+            }
+            out.stdError = std::sqrt(worst);
+            if (out.stdError <= options.targetStdError ||
+                static_cast<long long>(b + 1) * P > options.maxPaths)
+                break;
+        }
+
+        out.bands = Matrix(levels, H);
+        out.mean.resize(H);
+        for (size_t c = 0; c < cells; c++) {
+            double x = first[c] + sum[c] / b;
+            if (c < levels * H) out.bands.data()[c] = x;
+            else out.mean[c - levels * H] = x;
+        }
+        out.pathsUsed = b * P;
+        out.batches = b;
+    }
+
+    // ---- Terminal histogram ----
+    const int bins = options.histogramBins;
+    if (bins > 0) {
+        auto [lo, hi] = std::minmax_element(terminal.begin(), terminal.end());
+        double left = *lo, width = (*hi - *lo) / bins;
+        out.histogramEdges.resize(bins + 1);
+        for (int k = 0; k <= bins; k++) out.histogramEdges[k] = left + k * width;
+        out.histogramEdges[bins] = *hi;
+        out.histogramCounts.assign(bins, 0);
+        for (double v : terminal) {
+            int k = width > 0.0 ? static_cast<int>((v - left) / width) : 0;
+            out.histogramCounts[std::clamp(k, 0, bins - 1)]++;
+        }
+    }
+    return out;
+}
@@ -1,16 +1,54 @@
 #pragma once
+#include <cstdint>
 #include <vector>
 
+#include "Matrix.h"
+
+class ThreadPool;
+
+// How step normals are drawn. Antithetic pairs path 2m with the negated
+// draws of path 2m + 1; Sobol builds each path by Brownian bridge from
+// scrambled Sobol' points, so the coarse moves (terminal value, tile
+// boundaries) take the low-discrepancy dimensions.
+enum class Sampling { Pseudo, Antithetic, Sobol };
+
+struct MonteCarloOptions {
+    int paths = 1000;         // per batch in target mode
+    int horizon = 252;
+    uint64_t seed = 42;
+    std::vector<double> percentiles{ 0.05, 0.50, 0.95 };  // levels in [0, 1]
+    int histogramBins = 50;   // terminal-value histogram, 0 for none
+    int samplePaths = 0;      // leading paths kept in full
+    Sampling sampling = Sampling::Pseudo;
+    bool controlVariate = false;   // lognormal control on bands and means
+    double targetStdError = 0.0;   // > 0: batches until the standard error is below this
+    int maxPaths = 1000000;        // target mode stops here regardless
+};
+
+// Aggregates of a simulation that never holds the full path matrix
+struct MonteCarloSummary {
+    Matrix bands;                       // percentiles x horizon
+    std::vector<double> mean;           // per step
+    std::vector<double> histogramEdges; // bins + 1, over [min, max] of terminal values
+    std::vector<size_t> histogramCounts;
+    Matrix samplePaths;                 // samplePaths x horizon
+    int pathsUsed = 0;
+    int batches = 0;
+    double stdError = 0.0;              // largest over bands and means; NaN for one batch
+};
+
 struct StressResult {
     double stressedReturn;
     double stressedRisk;
 };
 
-struct MonteCarloResult {
-    std::vector<std::vector<double>> paths;
-    std::vector<double> p5;
-    std::vector<double> p50;
-    std::vector<double> p95;
+// Rolling historical tail risk as positive losses; column t is the window
+// of observations [t, t + window)
+struct RollingTailRisk {
+    size_t window = 0;
+    std::vector<double> confidences;
+    Matrix var;  // confidences x (observations - window + 1)
+    Matrix es;
 };
 
 class RiskMetrics {
@@ -22,41 +60,103 @@ public:
         double confidenceLevel
     );
 
-    //Monte Carlo Simulation
-    static MonteCarloResult monteCarloSimulation(
-        const std::vector<double>& weights,
-        const std::vector<double>& mu,
-        const std::vector<std::vector<double>>& cov,
-        int numSimulations,
-        int horizon
+    // Value paths from 1.0 with N(mu_p, sigma_p) step returns. The draw
+    // for (path, step) is a Philox block keyed by seed, so the output is
+    // bit-identical for any pool size or split of paths.
+    static Matrix
+    monteCarloPortfolioPaths(
+        double mu_p,
+        double sigma_p,
+        int numSim,
+        int horizon,
+        uint64_t seed
     );
 
-    static std::vector<std::vector<double>>
+    static Matrix
     monteCarloPortfolioPaths(
         double mu_p,
         double sigma_p,
         int numSim,
-        int horizon
+        int horizon,
+        uint64_t seed,
+        ThreadPool& pool
     );
 
+    // Same paths as monteCarloPortfolioPaths for the same seed (pseudo
+    // sampling), simulated in tiles of steps. Each tile's step slices are
+    // reduced to exact percentiles (nth_element, on the pool) and means,
+    // so memory is O(paths x tile + percentiles x horizon) instead of
+    // O(paths x horizon).
+    //
+    // With controlVariate each path also carries a lognormal twin driven
+    // by the same normals, moment-matched to one step; its analytic
+    // quantiles and mean correct the estimates (beta = 1). With
+    // targetStdError, independent batches of `paths` (fresh paths, or a
+    // fresh scramble for Sobol) run until the standard error over batch
+    // estimates is at most the target, at least four batches and at most
+    // maxPaths; the estimates are batch averages.
+    static MonteCarloSummary
+    monteCarloSummary(
+        double mu_p,
+        double sigma_p,
+        const MonteCarloOptions& options
+    );
+
+    static MonteCarloSummary
+    monteCarloSummary(
+        double mu_p,
+        double sigma_p,
+        const MonteCarloOptions& options,
+        ThreadPool& pool
+    );
+
+    // Tail convention shared by the historical measures below and by
+    // CVaROptimizer: of n losses, VaR is the one with floor((1 - c) n)
+    // worse ones (the empirical c-quantile), and ES = VaR + sum of
+    // (loss - VaR) over the worse ones / ((1 - c) n), the
+    // Rockafellar-Uryasev CVaR. Returns that count of worse losses.
+    static size_t tailRank(size_t n, double confidence);
+
+    // VaR and ES of `losses` under that convention, by nth_element
+    // selection; losses is reordered
+    static void lossTail(std::vector<double>& losses, double confidence,
+                         double& var, double& es);
 
-    // Historical VaR
+    // Historical VaR of the returns as a positive loss
     static double historicalVaR(
         const std::vector<double>& portfolioReturns,
         double confidenceLevel
     );
 
+    // Historical Expected Shortfall; the mean of the worst (1 - c) n
+    // returns when that is a whole number
+    static double historicalES(
+        const std::vector<double>& portfolioReturns,
+        double confidenceLevel
+    );
+
+    // VaR and ES of every window for several levels in one pass. Returns
+    // are ranked once; the window lives in Fenwick trees of counts and
+    // sums over the ranks, so a step is one insert, one removal and, per
+    // level, an order-statistic descent that also yields the tail sum:
+    // O(log n) instead of a copy and sort per window.
+    static RollingTailRisk rollingTailRisk(
+        const std::vector<double>& portfolioReturns,
+        size_t window,
+        const std::vector<double>& confidences
+    );
+
     static StressResult marketCrash(
         const std::vector<double>& weights,
         const std::vector<double>& mu,
-        const std::vector<std::vector<double>>& cov,
+        MatrixView cov,
         double crashPct
     );
 
     static StressResult singleAssetShock(
         const std::vector<double>& weights,
         const std::vector<double>& mu,
-        const std::vector<std::vector<double>>& cov,
+        MatrixView cov,
         int assetIndex,
         double shockPct
     );
@@ -64,7 +164,7 @@ public:
     static StressResult volatilitySpike(
         const std::vector<double>& weights,
         const std::vector<double>& mu,
-        const std::vector<std::vector<double>>& cov,
+        MatrixView cov,
         double spikeFactor
     );
 };
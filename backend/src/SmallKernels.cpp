@@ -0,0 +1,27 @@
+#include "SmallKernels.h"
+
+#include <utility>
+
+namespace SmallKernels {
+namespace detail {
+
+namespace {
+
+template <size_t... I>
+constexpr std::array<QuadFn, sizeof...(I)> quads(std::index_sequence<I...>) {
+    return { &quadraticForm<I + 1>... };
+}
+template <size_t... I>
+constexpr std::array<TangencyFn, sizeof...(I)> tangencies(std::index_sequence<I...>) {
+    return { &tangencyWeights<I + 1>... };
+}
+
+}
+
+const std::array<QuadFn, kMaxAssets> quadTable =
+    quads(std::make_index_sequence<kMaxAssets>{});
+const std::array<TangencyFn, kMaxAssets> tangencyTable =
+    tangencies(std::make_index_sequence<kMaxAssets>{});
+
+}
+}
@@ -0,0 +1,117 @@
+#ifndef SMALL_KERNELS_H
+#define SMALL_KERNELS_H
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+
+#include "Matrix.h"
+
+// Fixed-size kernels for universes of up to kMaxAssets assets.
+//
+// With N a compile-time constant every loop below has a known trip count,
+// so the compiler unrolls it and keeps the working matrix in a stack
+// array; at these sizes the generic paths spend more time on loop and
+// allocation overhead than on arithmetic. The dispatch functions pick the
+// specialization for a runtime size and return false when there is none
+// (or the input does not qualify), leaving the caller on its generic path.
+namespace SmallKernels {
+
+constexpr size_t kMaxAssets = 32;
+
+// w' S w. S w is accumulated as sum_j w_j S_j. (S is symmetric), so each
+// step is an independent N-wide multiply-add the compiler keeps in
+// vector registers instead of N serial dot-product chains.
+template <size_t N>
+double quadraticForm(const double* S, ptrdiff_t rowStride, const double* w) {
+    std::array<double, N> Sw{};
+    for (size_t j = 0; j < N; j++) {
+        const double* row = S + j * rowStride;
+        double wj = w[j];
+        for (size_t i = 0; i < N; i++) Sw[i] += wj * row[i];
+    }
+    double var = 0.0;
+    for (size_t i = 0; i < N; i++) var += w[i] * Sw[i];
+    return var;
+}
+
+// Solves S x = b by an in-register Cholesky of the upper triangle.
+// False when S is not numerically positive definite.
+template <size_t N>
+bool choleskySolve(const double* S, ptrdiff_t rowStride, const double* b, double* x) {
+    std::array<double, N * N> U{};
+    for (size_t i = 0; i < N; i++) {
+        for (size_t j = i; j < N; j++) {
+            double s = S[i * rowStride + j];
+            for (size_t k = 0; k < i; k++) s -= U[k * N + i] * U[k * N + j];
+            if (j == i) {
+                if (!(s > 0.0)) return false;
+                U[i * N + i] = std::sqrt(s);
+            } else {
+                U[i * N + j] = s / U[i * N + i];
+            }
+        }
+    }
+    // U' y = b, then U x = y
+    for (size_t i = 0; i < N; i++) {
+        double s = b[i];
+        for (size_t k = 0; k < i; k++) s -= U[k * N + i] * x[k];
+        x[i] = s / U[i * N + i];
+    }
+    for (size_t i = N; i-- > 0;) {
+        double s = x[i];
+        for (size_t k = i + 1; k < N; k++) s -= U[i * N + k] * x[k];
+        x[i] = s / U[i * N + i];
+    }
+    return true;
+}
+
+// S^-1 (mu - rf) normalized to sum to one
+template <size_t N>
+bool tangencyWeights(const double* S, ptrdiff_t rowStride, const double* mu,
+                     double rf, double* w) {
+    std::array<double, N> excess;
+    for (size_t i = 0; i < N; i++) excess[i] = mu[i] - rf;
+    if (!choleskySolve<N>(S, rowStride, excess.data(), w)) return false;
+    double sum = 0.0;
+    for (size_t i = 0; i < N; i++) sum += w[i];
+    if (sum == 0.0 || !std::isfinite(sum)) return false;
+    for (size_t i = 0; i < N; i++) w[i] /= sum;
+    return true;
+}
+
+// ---- Runtime dispatch ----
+// Each needs n in [1, kMaxAssets] and a square n x n cov with contiguous
+// rows. Inline so the view is unpacked at the call site; the tables of
+// instantiations live in SmallKernels.cpp.
+
+namespace detail {
+
+using QuadFn = double (*)(const double*, ptrdiff_t, const double*);
+using TangencyFn = bool (*)(const double*, ptrdiff_t, const double*, double, double*);
+
+// Entry i is the N = i + 1 specialization
+extern const std::array<QuadFn, kMaxAssets> quadTable;
+extern const std::array<TangencyFn, kMaxAssets> tangencyTable;
+
+inline bool fits(MatrixView cov, size_t n) {
+    return n >= 1 && n <= kMaxAssets && cov.rows() == n && cov.cols() == n &&
+           cov.rowsContiguous();
+}
+
+}
+
+inline bool quadraticForm(MatrixView cov, const double* w, size_t n, double& out) {
+    if (!detail::fits(cov, n)) return false;
+    out = detail::quadTable[n - 1](cov.data(), cov.rowStride(), w);
+    return true;
+}
+
+inline bool tangencyWeights(MatrixView cov, const double* mu, size_t n, double rf, double* w) {
+    if (!detail::fits(cov, n)) return false;
+    return detail::tangencyTable[n - 1](cov.data(), cov.rowStride(), mu, rf, w);
+}
+
+}
+
+#endif
@@ -0,0 +1,106 @@
+#include "Sobol.h"
+
+#include <stdexcept>
+
+#include "Philox.h"
+
+namespace {
+
+// Joe-Kuo (new-joe-kuo-6.21201) dimensions 2..32: degree s, coefficient
+// bits a of the primitive polynomial, initial odd m_1..m_s
+struct Primitive {
+    int s;
+    uint32_t a;
+    uint32_t m[7];
+};
+
+const Primitive kPrimitives[Sobol::kMaxDims - 1] = {
+    { 1, 0, { 1 } },
+    { 2, 1, { 1, 3 } },
+    { 3, 1, { 1, 3, 1 } },
+    { 3, 2, { 1, 1, 1 } },
+    { 4, 1, { 1, 1, 3, 3 } },
+    { 4, 4, { 1, 3, 5, 13 } },
+    { 5, 2, { 1, 1, 5, 5, 17 } },
+    { 5, 4, { 1, 1, 5, 5, 5 } },
+    { 5, 7, { 1, 1, 7, 11, 19 } },
+    { 5, 11, { 1, 1, 5, 1, 1 } },
+    { 5, 13, { 1, 1, 1, 3, 11 } },
+    { 5, 14, { 1, 3, 5, 5, 31 } },
+    { 6, 1, { 1, 3, 3, 9, 7, 49 } },
+    { 6, 13, { 1, 1, 1, 15, 21, 21 } },
+    { 6, 16, { 1, 3, 1, 13, 27, 49 } },
+    { 6, 19, { 1, 1, 1, 15, 7, 5 } },
+    { 6, 22, { 1, 3, 1, 15, 13, 25 } },
+    { 6, 25, { 1, 1, 5, 5, 19, 61 } },
+    { 7, 1, { 1, 3, 7, 11, 23, 15, 103 } },
+    { 7, 4, { 1, 3, 7, 13, 13, 15, 69 } },
+    { 7, 7, { 1, 1, 3, 13, 7, 35, 63 } },
+    { 7, 8, { 1, 3, 5, 9, 1, 25, 53 } },
+    { 7, 14, { 1, 3, 1, 13, 9, 35, 107 } },
+    { 7, 19, { 1, 3, 1, 5, 27, 61, 31 } },
+    { 7, 21, { 1, 1, 5, 11, 19, 41, 61 } },
+    { 7, 28, { 1, 3, 5, 3, 3, 13, 69 } },
+    { 7, 31, { 1, 1, 7, 13, 1, 19, 1 } },
+    { 7, 32, { 1, 3, 7, 5, 13, 19, 59 } },
+    { 7, 37, { 1, 1, 3, 9, 25, 29, 41 } },
+    { 7, 41, { 1, 3, 5, 13, 23, 1, 55 } },
+    { 7, 42, { 1, 3, 7, 3, 13, 59, 17 } },
+};
+
+uint32_t parity(uint32_t x) {
+    x ^= x >> 16;
+    x ^= x >> 8;
+    x ^= x >> 4;
+    x ^= x >> 2;
+    x ^= x >> 1;
+    return x & 1u;
+}
+
+}
+
+Sobol::Sobol(int dims, uint64_t seed, uint64_t replicate)
+    : dims_(dims), directions(static_cast<size_t>(dims) * 32), shift(dims)
+{
+    if (dims < 1 || dims > kMaxDims)
+        throw std::invalid_argument("Sobol dimension out of range");
+
+    // Bit 31 is the first binary digit
+    uint32_t v[32];
+    const Philox4x32 rng(seed ^ 0x50B01C0DE5EEDull);
+    for (int d = 0; d < dims; d++) {
+        if (d == 0) {
+            for (int j = 0; j < 32; j++) v[j] = 1u << (31 - j);
+        } else {
+            const Primitive& p = kPrimitives[d - 1];
+            for (int j = 0; j < p.s; j++) v[j] = p.m[j] << (31 - j);
+            for (int j = p.s; j < 32; j++) {
+                v[j] = v[j - p.s] ^ (v[j - p.s] >> p.s);
+                for (int k = 1; k < p.s; k++)
+                    if ((p.a >> (p.s - 1 - k)) & 1u) v[j] ^= v[j - k];
+            }
+        }
+
+        // Random lower-triangular L with unit diagonal: output digit k
+        // mixes input digits 0..k. 32 rows plus the shift, 9 blocks.
+        uint32_t bits[36];
+        for (uint32_t b = 0; b < 9; b++) {
+            Philox4x32::Block r = rng({ static_cast<uint32_t>(replicate),
+                                        static_cast<uint32_t>(replicate >> 32),
+                                        static_cast<uint32_t>(d), b });
+            for (int w = 0; w < 4; w++) bits[4 * b + w] = r[w];
+        }
+        uint32_t rows[32];
+        for (int k = 0; k < 32; k++) {
+            uint32_t diagonal = 1u << (31 - k);
+            uint32_t above = ~((diagonal << 1) - 1u);  // digits before k
+            rows[k] = (bits[k] & above) | diagonal;
+        }
+        for (int j = 0; j < 32; j++) {
+            uint32_t out = 0;
+            for (int k = 0; k < 32; k++) out |= parity(v[j] & rows[k]) << (31 - k);
+            directions[static_cast<size_t>(d) * 32 + j] = out;
+        }
+        shift[d] = bits[32];
+    }
+}
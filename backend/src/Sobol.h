@@ -0,0 +1,33 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Sobol' points in up to kMaxDims dimensions (Joe and Kuo direction
+// numbers), randomized by a linear matrix scramble and a digital shift
+// (Matousek) drawn from Philox. Each (seed, replicate) is an independent
+// randomization that keeps the net structure, so the spread of estimates
+// over replicates is an honest error estimate. Point i is computed
+// directly from the bits of i, in any order and on any thread.
+class Sobol {
+public:
+    static constexpr int kMaxDims = 32;
+
+    Sobol(int dims, uint64_t seed, uint64_t replicate);
+
+    int dims() const { return dims_; }
+
+    // Coordinate d of point i, in (0, 1)
+    double operator()(uint32_t i, int d) const {
+        const uint32_t* v = directions.data() + static_cast<size_t>(d) * 32;
+        uint32_t x = shift[d];
+        for (int j = 0; i != 0; i >>= 1, j++)
+            x ^= v[j] & (0u - (i & 1u));
+        return (static_cast<double>(x) + 0.5) * 0x1.0p-32;
+    }
+
+private:
+    int dims_;
+    std::vector<uint32_t> directions;  // dims x 32, scrambled
+    std::vector<uint32_t> shift;
+};
@@ -1,60 +1,112 @@
 #include "Statistics.h"
-#include <fstream>
-#include <sstream>
+#include "ThreadPool.h"
+#include "data/CSVLoader.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
 #include <iostream>
+#include <memory>
 
-std::vector<std::vector<double>>
-Statistics::readCSV(const std::string& filePath) {
-    std::ifstream file(filePath);
-    std::vector<std::vector<double>> prices;
+namespace {
 
-    if (!file.is_open()) {
-        std::cerr << "Error opening CSV file\n";
-        return {};
-    }
+constexpr size_t kPanel = 4;         // assets per packed panel
+constexpr size_t kTile = 16;         // panels per tile side (64 assets)
+constexpr size_t kTimeChunk = 256;   // observations per cache block
+constexpr size_t kBlockedMinAssets = 128;
 
-    std::string line;
+// Upper triangle of out += sum over rows [t0, t1) of d d^T, d = x - means.
+void accumulateRows(MatrixView returns, const std::vector<double>& means,
+                    size_t t0, size_t t1, Matrix& out) {
+    size_t N = returns.cols();
+    std::vector<double> d(N);
+    for (size_t t = t0; t < t1; t++) {
+        for (size_t i = 0; i < N; i++)
+            d[i] = returns(t, i) - means[i];
 
-    // skip header
-    if (!std::getline(file, line)) {
-        return {};
+        for (size_t i = 0; i < N; i++) {
+            double di = d[i];
+            double* row = out.rowPtr(i);
+            for (size_t j = i; j < N; j++)
+                row[j] += di * d[j];
+        }
     }
+}
 
-    while (std::getline(file, line)) {
-        std::stringstream ss(line);
-        std::string token;
-        std::vector<double> row;
+// c[4][ldc] += a^T b over len observations of two packed panels: each
+// step broadcasts one a value per row against the 4-wide b vector.
+inline void panelKernel(const double* a, const double* b, size_t len,
+                        double* c, size_t ldc) {
+    double acc0[kPanel] = {}, acc1[kPanel] = {}, acc2[kPanel] = {}, acc3[kPanel] = {};
+    for (size_t t = 0; t < len; t++) {
+        const double* xa = a + t * kPanel;
+        const double* xb = b + t * kPanel;
+        for (size_t j = 0; j < kPanel; j++) {
+            acc0[j] += xa[0] * xb[j];
+            acc1[j] += xa[1] * xb[j];
+            acc2[j] += xa[2] * xb[j];
+            acc3[j] += xa[3] * xb[j];
+        }
+    }
+    for (size_t j = 0; j < kPanel; j++) {
+        c[j] += acc0[j];
+        c[ldc + j] += acc1[j];
+        c[2 * ldc + j] += acc2[j];
+        c[3 * ldc + j] += acc3[j];
+    }
+}
 
-        bool skipFirst = true;
-        while (std::getline(ss, token, ',')) {
-            if (skipFirst) {
-                skipFirst = false;
-                continue;
+// Co-moment block for tile (ti, tj) over observations [t0, t1), walking
+// the time axis in cache-sized chunks so both tiles' panels stay in L2.
+void accumulateTile(const double* x, size_t T, size_t P,
+                    size_t ti, size_t tj, size_t t0, size_t t1,
+                    Matrix& out) {
+    size_t pi0 = ti * kTile, pi1 = std::min(P, pi0 + kTile);
+    size_t pj0 = tj * kTile, pj1 = std::min(P, pj0 + kTile);
+    size_t ld = out.cols();
+
+    for (size_t c0 = t0; c0 < t1; c0 += kTimeChunk) {
+        size_t len = std::min(kTimeChunk, t1 - c0);
+        for (size_t pi = pi0; pi < pi1; pi++) {
+            const double* a = x + (pi * T + c0) * kPanel;
+            for (size_t pj = std::max(pi, pj0); pj < pj1; pj++) {
+                const double* b = x + (pj * T + c0) * kPanel;
+                panelKernel(a, b, len, out.rowPtr(pi * kPanel) + pj * kPanel, ld);
             }
-            row.push_back(std::stod(token));
         }
+    }
+}
 
-        if (!row.empty())
-            prices.push_back(row);
+}
+
+Matrix
+Statistics::readCSV(const std::string& filePath) {
+    PriceTable table = CSVLoader::load(filePath);
+
+    if (!table.ok()) {
+        for (const auto& e : table.errors)
+            std::cerr << filePath << ":" << e.line << ":" << e.column
+                      << ": " << e.message << "\n";
+        return {};
     }
 
+    Matrix prices(table.rows, table.cols);
+    std::copy(table.values.begin(), table.values.end(), prices.data());
     return prices;
 }
 
-std::vector<std::vector<double>>
-Statistics::computeReturns(const std::vector<std::vector<double>>& prices) {
-    if (prices.size() < 2) return {};
+Matrix
+Statistics::computeReturns(MatrixView prices) {
+    if (prices.rows() < 2) return {};
 
-    int T = prices.size();
-    int N = prices[0].size();
+    size_t T = prices.rows();
+    size_t N = prices.cols();
 
-    std::vector<std::vector<double>> returns(T - 1,
-        std::vector<double>(N));
+    Matrix returns(T - 1, N);
 
-    for (int t = 1; t < T; t++) {
-        for (int i = 0; i < N; i++) {
-            returns[t - 1][i] =
-                (prices[t][i] - prices[t - 1][i]) / prices[t - 1][i];
+    for (size_t t = 1; t < T; t++) {
+        double* out = returns.rowPtr(t - 1);
+        for (size_t i = 0; i < N; i++) {
+            out[i] = (prices(t, i) - prices(t - 1, i)) / prices(t - 1, i);
         }
     }
 
@@ -62,48 +114,195 @@ Statistics::computeReturns(const std::vector<std::vector<double>>& prices) {
 }
 
 std::vector<double>
-Statistics::computeReturnsMean(
-    const std::vector<std::vector<double>>& returns) {
+Statistics::computeReturnsMean(MatrixView returns) {
 
-    if (returns.empty() || returns[0].empty()) return {};
+    if (returns.empty()) return {};
 
-    int T = returns.size();
-    int N = returns[0].size();
+    size_t T = returns.rows();
+    size_t N = returns.cols();
 
     std::vector<double> means(N, 0.0);
 
-    for (int i = 0; i < N; i++) {
-        for (int t = 0; t < T; t++)
-            means[i] += returns[t][i];
-        means[i] /= T;
-    }
+    for (size_t t = 0; t < T; t++)
+        for (size_t i = 0; i < N; i++)
+            means[i] += returns(t, i);
+
+    for (double& m : means) m /= T;
 
     return means;
 }
 
-std::vector<std::vector<double>>
+Matrix
 Statistics::computeCovariance(
-    const std::vector<std::vector<double>>& returns,
+    MatrixView returns,
     const std::vector<double>& means) {
 
-    if (returns.size() < 2 || returns[0].empty()) return {};
+    if (returns.rows() < 2 || returns.cols() == 0) return {};
+
+    size_t T = returns.rows();
+    size_t N = returns.cols();
+
+    ThreadPool& pool = ThreadPool::shared();
+    size_t threads = pool.concurrency();
 
-    int T = returns.size();
-    int N = returns[0].size();
+    std::vector<Matrix> partial;
 
-    std::vector<std::vector<double>> cov(N,
-        std::vector<double>(N, 0.0));
+    if (N < kBlockedMinAssets) {
+        // Few assets: memory bound, stream the rows directly and split
+        // the time axis across threads.
+        size_t segments = std::max<size_t>(1,
+            std::min(threads, T / (4 * kTimeChunk)));
+        partial.assign(segments, Matrix(N, N));
 
-    for (int i = 0; i < N; i++) {
-        for (int j = 0; j < N; j++) {
-            for (int t = 0; t < T; t++) {
-                cov[i][j] +=
-                    (returns[t][i] - means[i]) *
-                    (returns[t][j] - means[j]);
+        pool.parallelFor(segments, [&](size_t seg) {
+            accumulateRows(returns, means,
+                           T * seg / segments, T * (seg + 1) / segments,
+                           partial[seg]);
+        });
+    } else {
+        size_t P = (N + kPanel - 1) / kPanel;
+        size_t Np = P * kPanel;
+
+        // ---- De-mean once, packed as 4-asset panels: x[p][t][0..3] ----
+        // Walk rows in time blocks so each input row is read once; padding
+        // lanes are written as zeros, so the buffer needs no initialisation.
+        AlignedAllocator<double> alloc;
+        std::unique_ptr<double, std::function<void(double*)>> packed(
+            alloc.allocate(Np * T),
+            [&alloc, n = Np * T](double* p) { alloc.deallocate(p, n); });
+        double* x = packed.get();
+
+        size_t packBlocks = (T + kTimeChunk - 1) / kTimeChunk;
+        pool.parallelFor(packBlocks, [&](size_t blk) {
+            size_t t1 = std::min(T, (blk + 1) * kTimeChunk);
+            for (size_t t = blk * kTimeChunk; t < t1; t++) {
+                for (size_t j = 0; j < Np; j++) {
+                    double v = j < N ? returns(t, j) - means[j] : 0.0;
+                    x[((j / kPanel) * T + t) * kPanel + j % kPanel] = v;
+                }
             }
-            cov[i][j] /= (T - 1);
+        });
+
+        // ---- Upper-triangle tiles of kTile x kTile panels ----
+        size_t tilesPerSide = (P + kTile - 1) / kTile;
+        std::vector<std::pair<size_t, size_t>> tiles;
+        for (size_t ti = 0; ti < tilesPerSide; ti++)
+            for (size_t tj = ti; tj < tilesPerSide; tj++)
+                tiles.push_back({ ti, tj });
+
+        // Fewer tiles than threads on a long history: also split time
+        size_t segments = 1;
+        if (tiles.size() < threads && T >= 4 * kTimeChunk * threads)
+            segments = threads;
+        partial.assign(segments, Matrix(Np, Np));
+
+        pool.parallelFor(tiles.size() * segments, [&](size_t item) {
+            size_t seg = item / tiles.size();
+            auto [ti, tj] = tiles[item % tiles.size()];
+            accumulateTile(x, T, P, ti, tj,
+                           T * seg / segments, T * (seg + 1) / segments,
+                           partial[seg]);
+        });
+    }
+
+    // ---- Pairwise merge of the per-segment co-moments ----
+    // Every segment is centred on the same means, so partials simply add.
+    size_t segments = partial.size();
+    for (size_t stride = 1; stride < segments; stride *= 2) {
+        pool.parallelFor((segments + 2 * stride - 1) / (2 * stride), [&](size_t k) {
+            size_t a = 2 * stride * k;
+            size_t b = a + stride;
+            if (b >= segments) return;
+            double* dst = partial[a].data();
+            const double* src = partial[b].data();
+            for (size_t i = 0; i < partial[a].size(); i++) dst[i] += src[i];
+        });
+    }
+
+    const Matrix& sum = partial[0];
+    Matrix cov(N, N);
+    double denom = static_cast<double>(T - 1);
+    for (size_t i = 0; i < N; i++) {
+        for (size_t j = i; j < N; j++) {
+            double v = sum(i, j) / denom;
+            cov(i, j) = v;
+            cov(j, i) = v;
         }
     }
 
     return cov;
 }
+
+void
+Statistics::appendObservation(
+    const double* x,
+    size_t count,
+    std::vector<double>& means,
+    Matrix& cov) {
+
+    size_t N = means.size();
+    if (cov.rows() != N || cov.cols() != N) cov = Matrix(N, N);
+
+    if (count == 0) {
+        means.assign(x, x + N);
+        return;
+    }
+
+    double n = static_cast<double>(count);
+    std::vector<double> delta(N);
+    for (size_t i = 0; i < N; i++) {
+        delta[i] = x[i] - means[i];
+        means[i] += delta[i] / (n + 1.0);
+    }
+
+    // M2' = M2 + n/(n+1) * d d^T, with cov = M2 / (count - 1)
+    double keep = (n - 1.0) / n;
+    double add = 1.0 / (n + 1.0);
+
+    for (size_t i = 0; i < N; i++) {
+        double di = delta[i] * add;
+        for (size_t j = i; j < N; j++) {
+            double v = keep * cov(i, j) + di * delta[j];
+            cov(i, j) = v;
+            cov(j, i) = v;
+        }
+    }
+}
+
+double
+Statistics::normalQuantile(double p) {
+    if (!(p > 0.0 && p < 1.0)) {
+        if (p == 0.0) return -HUGE_VAL;
+        if (p == 1.0) return HUGE_VAL;
+        return std::nan("");
+    }
+
+    static const double a[6] = { -3.969683028665376e+01, 2.209460984245205e+02,
+                                 -2.759285104469687e+02, 1.383577518672690e+02,
+                                 -3.066479806614716e+01, 2.506628277459239e+00 };
+    static const double b[5] = { -5.447609879822406e+01, 1.615858368580409e+02,
+                                 -1.556989798598866e+02, 6.680131188771972e+01,
+                                 -1.328068155288572e+01 };
+    static const double c[6] = { -7.784894002430293e-03, -3.223964580411365e-01,
+                                 -2.400758277161838e+00, -2.549732539343734e+00,
+                                 4.374664141464968e+00, 2.938163982698783e+00 };
+    static const double d[4] = { 7.784695709041462e-03, 3.224671290700398e-01,
+                                 2.445134137142996e+00, 3.754408661907416e+00 };
+
+    double x;
+    if (p < 0.02425 || p > 0.97575) {
+        double q = std::sqrt(-2.0 * std::log(p < 0.5 ? p : 1.0 - p));
+        x = (((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5]) /
+            ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1.0);
+        if (p > 0.5) x = -x;
+    } else {
+        double q = p - 0.5, r = q * q;
+        x = (((((a[0] * r + a[1]) * r + a[2]) * r + a[3]) * r + a[4]) * r + a[5]) * q /
+            (((((b[0] * r + b[1]) * r + b[2]) * r + b[3]) * r + b[4]) * r + 1.0);
+    }
+
+    // Halley refinement against the exact CDF
+    double e = 0.5 * std::erfc(-x / std::sqrt(2.0)) - p;
+    double u = e * std::sqrt(2.0 * M_PI) * std::exp(0.5 * x * x);
+    return x - u / (1.0 + 0.5 * x * u);
+}
@@ -4,20 +4,36 @@
 #include <vector>
 #include <string>
 
+#include "Matrix.h"
+
 class Statistics {
 public:
-    static std::vector<std::vector<double>>
+    static Matrix
     readCSV(const std::string& filePath);
 
-    static std::vector<std::vector<double>>
-    computeReturns(const std::vector<std::vector<double>>& prices);
+    static Matrix
+    computeReturns(MatrixView prices);
 
     static std::vector<double>
-    computeReturnsMean(const std::vector<std::vector<double>>& returns);
+    computeReturnsMean(MatrixView returns);
 
-    static std::vector<std::vector<double>>
-    computeCovariance(const std::vector<std::vector<double>>& returns,
+    static Matrix
+    computeCovariance(MatrixView returns,
                       const std::vector<double>& means);
+
+    // Welford update of the sample mean and covariance for one more
+    // observation x. count is the number of observations already folded
+    // into means/cov. O(N^2), no pass over the history.
+    static void
+    appendObservation(const double* x,
+                      size_t count,
+                      std::vector<double>& means,
+                      Matrix& cov);
+
+    // Standard normal quantile: Acklam's rational approximation plus
+    // one Halley step on erfc, accurate to ~1e-15. -inf / +inf at 0 / 1.
+    static double
+    normalQuantile(double p);
 };
 
 #endif
@@ -0,0 +1,157 @@
+#include "StressEngine.h"
+
+#include <cmath>
+#include <stdexcept>
+
+#include "Statistics.h"
+#include "ThreadPool.h"
+
+StressEngine::StressEngine(const std::vector<double>& weights,
+                           const std::vector<double>& mu,
+                           MatrixView cov)
+    : cov_(cov), weights_(weights), mu_(mu)
+{
+    const size_t N = weights.size();
+    if (mu.size() != N || cov.rows() != N || cov.cols() != N)
+        throw std::invalid_argument("weights, mean and covariance sizes differ");
+
+    covW_.resize(N);
+    vol_.resize(N);
+    for (size_t i = 0; i < N; i++) {
+        double s = 0.0;
+        if (cov.rowsContiguous()) {
+            s = dotProduct(cov.rowPtr(i), weights.data(), N);
+        } else {
+            for (size_t j = 0; j < N; j++) s += cov(i, j) * weights[j];
+        }
+        covW_[i] = s;
+        vol_[i] = std::sqrt(std::max(cov(i, i), 0.0));
+        baseReturn_ += weights[i] * mu[i];
+        variance_ += weights[i] * s;
+        double a = weights[i] * vol_[i];
+        volSum_ += a;
+        volSumSq_ += a * a;
+    }
+}
+
+double StressEngine::baseRisk() const {
+    return std::sqrt(std::max(variance_, 0.0));
+}
+
+double StressEngine::stressedReturn(const ReturnShock& shock) const {
+    // The listed shocks apply on top of the market one
+    double keep = 1.0 - shock.market;
+    double ret = keep * baseReturn_;
+    for (const auto& [i, s] : shock.assets) {
+        if (i >= weights_.size())
+            throw std::invalid_argument("return shock asset out of range");
+        ret -= keep * weights_[i] * mu_[i] * s;
+    }
+    return ret;
+}
+
+double StressEngine::stressedVariance(const VolShock& vol, const CorrelationShock& corr) const {
+    if (!(corr.blend >= 0.0 && corr.blend <= 1.0) ||
+        !(corr.correlation >= 0.0 && corr.correlation <= 1.0))
+        throw std::invalid_argument("correlation blend and target must be in [0, 1]");
+
+    // x = m w with m = all except on the listed assets: x = all w + d, d
+    // sparse, so x' Sigma x = all^2 w'Sigma w + 2 all d'Sigma w + d' Sigma_KK d
+    const double m = vol.all;
+    if (!(m >= 0.0))
+        throw std::invalid_argument("volatility shocks need assets in range and multipliers >= 0");
+    double quad = m * m * variance_;
+    double sum = m * volSum_, sumSq = m * m * volSumSq_;
+    const auto& listed = vol.assets;
+    for (size_t p = 0; p < listed.size(); p++) {
+        const auto& [i, mi] = listed[p];
+        if (i >= weights_.size() || !(mi >= 0.0))
+            throw std::invalid_argument("volatility shocks need assets in range and multipliers >= 0");
+        double di = (mi - m) * weights_[i];
+        quad += 2.0 * m * di * covW_[i] + di * di * cov_(i, i);
+        for (size_t q = 0; q < p; q++) {
+            size_t j = listed[q].first;
+            if (j == i)
+                throw std::invalid_argument("volatility shock lists an asset twice");
+            quad += 2.0 * di * (listed[q].second - m) * weights_[j] * cov_(i, j);
+        }
+        double a = weights_[i] * vol_[i];
+        sum += (mi - m) * a;
+        sumSq += (mi * mi - m * m) * a * a;
+    }
+
+    // w' Sigma_rho w = rho (sum a_i)^2 + (1 - rho) sum a_i^2, a_i = x_i sigma_i
+    double rho = corr.correlation;
+    double target = rho * sum * sum + (1.0 - rho) * sumSq;
+    return std::max((1.0 - corr.blend) * quad + corr.blend * target, 0.0);
+}
+
+StressGridResult StressEngine::grid(const StressGrid& grid, double confidence,
+                                    ThreadPool& pool) const {
+    if (!(confidence > 0.0 && confidence < 1.0))
+        throw std::invalid_argument("confidence must be in (0, 1)");
+    const size_t R = grid.returns.size(), V = grid.vols.size(), C = grid.correlations.size();
+
+    std::vector<double> ret(R), risk(V * C);
+    for (size_t r = 0; r < R; r++) ret[r] = stressedReturn(grid.returns[r]);
+
+    pool.parallelFor(V, [&](size_t v) {
+        for (size_t c = 0; c < C; c++)
+            risk[v * C + c] = std::sqrt(stressedVariance(grid.vols[v], grid.correlations[c]));
+    });
+
+    const double z = Statistics::normalQuantile(confidence);
+    StressGridResult out;
+    out.stressedReturn.resize(R * V * C);
+    out.stressedRisk.resize(R * V * C);
+    out.parametricVaR.resize(R * V * C);
+    for (size_t r = 0; r < R; r++) {
+        double* rr = out.stressedReturn.data() + r * V * C;
+        double* rk = out.stressedRisk.data() + r * V * C;
+        double* rv = out.parametricVaR.data() + r * V * C;
+        for (size_t s = 0; s < V * C; s++) {
+            rr[s] = ret[r];
+            rk[s] = risk[s];
+            rv[s] = z * risk[s] - ret[r];
+        }
+    }
+    return out;
+}
+
+ReplayResult StressEngine::replay(const std::vector<double>& portfolioReturns,
+                                  const std::vector<std::pair<size_t, size_t>>& windows) {
+    const size_t T = portfolioReturns.size();
+    for (const auto& [start, length] : windows)
+        if (length < 1 || start > T || length > T - start)
+            throw std::invalid_argument("replay window outside the return history");
+
+    // Prefix sums of r - shift, its square, and log(1 + r); the shift by
+    // the overall mean keeps the variance sums free of cancellation
+    double shift = 0.0;
+    for (double r : portfolioReturns) shift += r;
+    shift = T > 0 ? shift / T : 0.0;
+    std::vector<double> s1(T + 1, 0.0), s2(T + 1, 0.0), logs(T + 1, 0.0);
+    for (size_t t = 0; t < T; t++) {
+        double d = portfolioReturns[t] - shift;
+        s1[t + 1] = s1[t] + d;
+        s2[t + 1] = s2[t] + d * d;
+        logs[t + 1] = logs[t] + std::log1p(portfolioReturns[t]);
+    }
+
+    ReplayResult out;
+    out.meanReturn.resize(windows.size());
+    out.risk.resize(windows.size());
+    out.cumulativeReturn.resize(windows.size());
+    for (size_t k = 0; k < windows.size(); k++) {
+        auto [start, length] = windows[k];
+        size_t end = start + length;
+        double n = static_cast<double>(length);
+        double sum = s1[end] - s1[start];
+        double mean = sum / n;
+        double ss = s2[end] - s2[start] - sum * mean;
+        out.meanReturn[k] = shift + mean;
+        out.risk[k] = length > 1 ? std::sqrt(std::max(ss, 0.0) / (n - 1.0)) : 0.0;
+        out.cumulativeReturn[k] = std::expm1(logs[end] - logs[start]);
+    }
+    return out;
+}
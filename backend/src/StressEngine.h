@@ -0,0 +1,95 @@
+#ifndef STRESS_ENGINE_H
+#define STRESS_ENGINE_H
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "Matrix.h"
+
+class ThreadPool;
+
+// Expected returns scaled down: every mean by 1 - market, then the listed
+// assets' by 1 - shock
+struct ReturnShock {
+    double market = 0.0;
+    std::vector<std::pair<size_t, double>> assets;  // (asset, shock)
+};
+
+// Volatilities scaled: every asset by `all`, the listed ones by their own
+// multiplier instead. Correlations are unchanged.
+struct VolShock {
+    double all = 1.0;
+    std::vector<std::pair<size_t, double>> assets;  // (asset, multiplier)
+};
+
+// Sigma -> (1 - blend) Sigma + blend Sigma_rho, with Sigma_rho the same
+// volatilities under one constant correlation rho in [0, 1]
+struct CorrelationShock {
+    double blend = 0.0;
+    double correlation = 1.0;
+};
+
+// Every combination of the three lists is a scenario
+struct StressGrid {
+    std::vector<ReturnShock> returns{ ReturnShock{} };
+    std::vector<VolShock> vols{ VolShock{} };
+    std::vector<CorrelationShock> correlations{ CorrelationShock{} };
+};
+
+// Scenario (r, v, c) at index (r * vols + v) * correlations + c
+struct StressGridResult {
+    std::vector<double> stressedReturn;
+    std::vector<double> stressedRisk;
+    std::vector<double> parametricVaR;  // -(return - z risk), a positive loss
+};
+
+// Returns and realized volatility of historical windows replayed on the
+// current weights
+struct ReplayResult {
+    std::vector<double> meanReturn;
+    std::vector<double> risk;
+    std::vector<double> cumulativeReturn;
+};
+
+// Scenario engine for one portfolio. The constructor does the only
+// O(N^2) work: Sigma w, w' Sigma w, the volatilities and the sums of
+// w_i sigma_i that the constant-correlation form needs. After that a
+// return shock on k assets costs O(k), a volatility shock on k assets
+// is a rank-k update of the quadratic form through Sigma w and the k x k
+// block of Sigma, O(k^2), and a correlation blend is O(1). `cov` must
+// outlive the engine.
+class StressEngine {
+public:
+    StressEngine(const std::vector<double>& weights,
+                 const std::vector<double>& mu,
+                 MatrixView cov);
+
+    double baseReturn() const { return baseReturn_; }
+    double baseRisk() const;
+
+    double stressedReturn(const ReturnShock& shock) const;
+    double stressedVariance(const VolShock& vol, const CorrelationShock& corr) const;
+
+    // Risk terms once per (vol, correlation) pair on the pool, then every
+    // combination with the return shocks. VaR at `confidence`.
+    StressGridResult grid(const StressGrid& grid, double confidence, ThreadPool& pool) const;
+
+    // Windows [start, start + length) of the portfolio's return series,
+    // O(1) each from prefix sums
+    static ReplayResult replay(const std::vector<double>& portfolioReturns,
+                               const std::vector<std::pair<size_t, size_t>>& windows);
+
+private:
+    MatrixView cov_;
+    std::vector<double> weights_;
+    std::vector<double> mu_;
+    std::vector<double> covW_;   // Sigma w
+    std::vector<double> vol_;    // sqrt(Sigma_ii)
+    double baseReturn_ = 0.0;
+    double variance_ = 0.0;      // w' Sigma w
+    double volSum_ = 0.0;        // sum w_i sigma_i
+    double volSumSq_ = 0.0;      // sum (w_i sigma_i)^2
+};
+
+#endif
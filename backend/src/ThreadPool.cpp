@@ -0,0 +1,111 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+
+ThreadPool::ThreadPool(size_t threads) {
+    workers.reserve(threads);
+    for (size_t i = 0; i < threads; i++)
+        workers.emplace_back([this] { workerLoop(); });
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        stopping = true;
+    }
+    cv.notify_all();
+    for (auto& t : workers) t.join();
+}
+
+ThreadPool& ThreadPool::shared() {
+    static ThreadPool pool(std::max(1u, std::thread::hardware_concurrency()) - 1);
+    return pool;
+}
+
+void ThreadPool::enqueue(std::function<void()> job) {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        jobs.push(std::move(job));
+    }
+    cv.notify_one();
+}
+
+void ThreadPool::workerLoop() {
+    for (;;) {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            cv.wait(lock, [this] { return stopping || !jobs.empty(); });
+            if (stopping && jobs.empty()) return;
+            job = std::move(jobs.front());
+            jobs.pop();
+        }
+        job();
+    }
+}
+
+namespace {
+
+struct ParallelJob {
+    std::atomic<size_t> next{0};
+    size_t count = 0;
+    const std::function<void(size_t)>* body = nullptr;
+
+    std::mutex m;
+    std::condition_variable done;
+    size_t active = 0;
+    bool closed = false;
+    std::exception_ptr error;
+
+    void drain() {
+        for (size_t i = next++; i < count; i = next++) {
+            try {
+                (*body)(i);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(m);
+                if (!error) error = std::current_exception();
+                next = count;
+            }
+        }
+    }
+};
+
+}
+
+void ThreadPool::parallelFor(size_t count, const std::function<void(size_t)>& body) {
+    if (count == 0) return;
+    if (count == 1 || workers.empty()) {
+        for (size_t i = 0; i < count; i++) body(i);
+        return;
+    }
+
+    auto job = std::make_shared<ParallelJob>();
+    job->count = count;
+    job->body = &body;
+
+    size_t helpers = std::min(workers.size(), count - 1);
+    for (size_t h = 0; h < helpers; h++) {
+        enqueue([job] {
+            {
+                std::lock_guard<std::mutex> lock(job->m);
+                if (job->closed) return;
+                ++job->active;
+            }
+            job->drain();
+            {
+                std::lock_guard<std::mutex> lock(job->m);
+                --job->active;
+            }
+            job->done.notify_all();
+        });
+    }
+
+    job->drain();
+
+    std::unique_lock<std::mutex> lock(job->m);
+    job->closed = true;
+    job->done.wait(lock, [&] { return job->active == 0; });
+
+    if (job->error) std::rethrow_exception(job->error);
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+// Fixed-size worker pool shared by the parallel kernels.
+//
+// parallelFor lets the calling thread take part in the work and only
+// waits for helpers that actually started, so it is safe to call from
+// inside another pool task. Because the caller works too, the shared
+// pool has one worker fewer than there are hardware threads.
+class ThreadPool {
+public:
+    explicit ThreadPool(size_t threads);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    static ThreadPool& shared();
+
+    size_t size() const { return workers.size(); }
+
+    // Threads busy during parallelFor: the workers plus the caller
+    size_t concurrency() const { return workers.size() + 1; }
+
+    // Runs inline when the pool has no workers
+    template <class F>
+    auto submit(F&& f) -> std::future<decltype(f())> {
+        using R = decltype(f());
+        auto task = std::make_shared<std::packaged_task<R()>>(std::forward<F>(f));
+        std::future<R> fut = task->get_future();
+        if (workers.empty())
+            (*task)();
+        else
+            enqueue([task] { (*task)(); });
+        return fut;
+    }
+
+    // Runs body(i) for every i in [0, count). Rethrows the first exception.
+    void parallelFor(size_t count, const std::function<void(size_t)>& body);
+
+private:
+    void enqueue(std::function<void()> job);
+    void workerLoop();
+
+    std::vector<std::thread> workers;
+    std::queue<std::function<void()>> jobs;
+    std::mutex mtx;
+    std::condition_variable cv;
+    bool stopping = false;
+};
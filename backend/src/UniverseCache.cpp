@@ -0,0 +1,266 @@
+#include "UniverseCache.h"
+#include "Statistics.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+Matrix Universe::subsetReturns() const {
+    MatrixView rows = returns();
+    Matrix sub(rows.rows(), columns_.size());
+    for (size_t t = 0; t < rows.rows(); t++)
+        for (size_t a = 0; a < columns_.size(); a++)
+            sub(t, a) = rows(t, columns_[a]);
+    return sub;
+}
+
+std::vector<double> Universe::expandWeights(const std::vector<double>& w) const {
+    if (full_) return w;
+    std::vector<double> out(data_->returns().cols(), 0.0);
+    for (size_t i = 0; i < columns_.size() && i < w.size(); i++)
+        out[columns_[i]] = w[i];
+    return out;
+}
+
+std::shared_ptr<const CholeskyFactor> Universe::cholesky() const {
+    if (full_) return data_->cholesky();
+
+    std::shared_ptr<const CholeskyFactor> out;
+    {
+        std::lock_guard<std::mutex> lock(factorMtx);
+        if (cholesky_) return cholesky_;
+        out = cholesky_ = std::make_shared<CholeskyFactor>(CholeskyFactor::factor(cov_));
+    }
+    charge();
+    return out;
+}
+
+std::shared_ptr<const FrontierState> Universe::frontier() const {
+    std::shared_ptr<const CholeskyFactor> chol = cholesky();
+
+    std::shared_ptr<const FrontierState> out;
+    {
+        std::lock_guard<std::mutex> lock(factorMtx);
+        if (frontier_) return frontier_;
+        out = frontier_ = std::make_shared<FrontierState>(mean(), *chol);
+    }
+    charge();
+    return out;
+}
+
+std::shared_ptr<const FactorModel> Universe::factorModel(size_t factors) const {
+    std::shared_ptr<const FactorModel> model;
+    {
+        std::lock_guard<std::mutex> lock(factorMtx);
+        auto it = factors_.find(factors);
+        if (it != factors_.end()) return it->second;
+
+        if (full_) {
+            model = std::make_shared<FactorModel>(
+                FactorModel::fromReturns(returns(), mean(), factors));
+        } else {
+            model = std::make_shared<FactorModel>(
+                FactorModel::fromReturns(subsetReturns(), mean(), factors));
+        }
+        factors_[factors] = model;
+    }
+    charge();
+    return model;
+}
+
+size_t Universe::bytes() const {
+    size_t b = sizeof(Universe);
+    b += columns_.size() * sizeof(size_t);
+    for (const auto& s : symbols_) b += sizeof(std::string) + s.size();
+    b += mean_.size() * sizeof(double);
+    b += cov_.size() * sizeof(double);
+
+    std::lock_guard<std::mutex> lock(factorMtx);
+    if (cholesky_) b += sizeof(CholeskyFactor) + cholesky_->upper().size() * sizeof(double);
+    if (frontier_)
+        b += sizeof(FrontierState) +
+             (frontier_->invOnes().size() + frontier_->invMu().size()) * sizeof(double);
+    for (const auto& f : factors_) b += sizeof(FactorModel) + f.second->bytes();
+    return b;
+}
+
+void Universe::charge() const {
+    if (UniverseCache* cache = owner_.load()) cache->recharge(*this);
+}
+
+UniverseCache& UniverseCache::instance() {
+    static UniverseCache cache;
+    return cache;
+}
+
+UniverseCache::UniverseCache(size_t budgetBytes) : budget(budgetBytes) {}
+
+UniverseCache::~UniverseCache() {
+    clear();
+}
+
+std::shared_ptr<Universe>
+UniverseCache::build(const SnapshotPtr& data,
+                     const std::vector<std::string>& symbols,
+                     const std::string& start,
+                     const std::string& end) const {
+    auto u = std::make_shared<Universe>();
+    u->data_ = data;
+
+    const auto& all = data->symbols();
+    const auto& dates = data->dates();
+
+    // ---- Columns, in snapshot order ----
+    if (symbols.empty()) {
+        u->columns_.resize(all.size());
+        for (size_t i = 0; i < all.size(); i++) u->columns_[i] = i;
+    } else {
+        for (const auto& s : symbols) {
+            auto it = std::find(all.begin(), all.end(), s);
+            if (it == all.end())
+                throw std::invalid_argument("unknown symbol " + s);
+            u->columns_.push_back(static_cast<size_t>(it - all.begin()));
+        }
+        std::sort(u->columns_.begin(), u->columns_.end());
+        u->columns_.erase(std::unique(u->columns_.begin(), u->columns_.end()),
+                          u->columns_.end());
+    }
+    for (size_t c : u->columns_) u->symbols_.push_back(all[c]);
+
+    // ---- Price rows [first, last] -> return rows [first, last) ----
+    size_t first = start.empty() ? 0
+        : std::lower_bound(dates.begin(), dates.end(), start) - dates.begin();
+    size_t last = end.empty() ? dates.size()
+        : std::upper_bound(dates.begin(), dates.end(), end) - dates.begin();
+    if (last <= first + 1)
+        throw std::invalid_argument("date range has fewer than two prices");
+
+    u->firstReturn_ = first;
+    u->returnRows_ = last - first - 1;
+
+    bool allColumns = u->columns_.size() == all.size();
+    bool fullRange = first == 0 && last == dates.size();
+    size_t k = u->columns_.size();
+
+    if (fullRange && allColumns) {
+        u->full_ = true;
+    } else if (fullRange) {
+        // O(k^2) gather out of the superset statistics
+        const auto& mean = data->mean();
+        const Matrix& cov = data->cov();
+        u->mean_.resize(k);
+        u->cov_ = Matrix(k, k);
+        for (size_t a = 0; a < k; a++) {
+            u->mean_[a] = mean[u->columns_[a]];
+            const double* row = cov.rowPtr(u->columns_[a]);
+            for (size_t b = 0; b < k; b++)
+                u->cov_(a, b) = row[u->columns_[b]];
+        }
+    } else {
+        MatrixView rows = u->returns();
+        Matrix sub(rows.rows(), k);
+        for (size_t t = 0; t < rows.rows(); t++)
+            for (size_t a = 0; a < k; a++)
+                sub(t, a) = rows(t, u->columns_[a]);
+
+        u->mean_ = Statistics::computeReturnsMean(sub);
+        u->cov_ = Statistics::computeCovariance(sub, u->mean_);
+    }
+
+    return u;
+}
+
+UniversePtr UniverseCache::get(const SnapshotPtr& data,
+                               const std::vector<std::string>& symbols,
+                               const std::string& start,
+                               const std::string& end) {
+    std::vector<std::string> sorted = symbols;
+    std::sort(sorted.begin(), sorted.end());
+    sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+
+    std::string key = std::to_string(data->version()) + "|" + start + "|" + end;
+    for (const auto& s : sorted) key += "|" + s;
+
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+
+        if (data->version() > currentVersion) {
+            // Newer data: everything cached so far is stale
+            counters.evictions += lru.size();
+            for (const auto& e : lru) dropLocked(e);
+            lru.clear();
+            index.clear();
+            currentVersion = data->version();
+        }
+
+        auto it = index.find(key);
+        if (it != index.end()) {
+            counters.hits++;
+            lru.splice(lru.begin(), lru, it->second);
+            return it->second->universe;
+        }
+        counters.misses++;
+    }
+
+    std::shared_ptr<Universe> u = build(data, sorted, start, end);
+    u->key_ = key;
+
+    std::lock_guard<std::mutex> lock(mtx);
+    if (data->version() < currentVersion) return u;  // stale, don't cache
+
+    auto it = index.find(key);
+    if (it != index.end()) return it->second->universe;  // raced with another miss
+
+    lru.push_front({ key, u, u->bytes() });
+    index[key] = lru.begin();
+    counters.residentBytes += lru.front().bytes;
+    u->owner_.store(this);
+    evictLocked();
+    return u;
+}
+
+void UniverseCache::dropLocked(const Entry& e) {
+    e.universe->owner_.store(nullptr);
+    counters.residentBytes -= e.bytes;
+}
+
+void UniverseCache::recharge(const Universe& u) {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (u.owner_.load() != this) return;  // evicted meanwhile
+
+    Entry& e = *index.at(u.key_);
+    size_t now = u.bytes();
+    counters.residentBytes += now - e.bytes;
+    e.bytes = now;
+    evictLocked();
+}
+
+void UniverseCache::evictLocked() {
+    // Keep at least the most recent entry even if it alone is over budget
+    while (counters.residentBytes > budget && lru.size() > 1) {
+        dropLocked(lru.back());
+        index.erase(lru.back().key);
+        lru.pop_back();
+        counters.evictions++;
+    }
+}
+
+void UniverseCache::setBudget(size_t bytes) {
+    std::lock_guard<std::mutex> lock(mtx);
+    budget = bytes;
+    evictLocked();
+}
+
+void UniverseCache::clear() {
+    std::lock_guard<std::mutex> lock(mtx);
+    for (const auto& e : lru) dropLocked(e);
+    lru.clear();
+    index.clear();
+}
+
+UniverseCacheStats UniverseCache::stats() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    UniverseCacheStats s = counters;
+    s.entries = lru.size();
+    s.budgetBytes = budget;
+    return s;
+}
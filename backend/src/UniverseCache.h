@@ -0,0 +1,145 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "DataCache.h"
+#include "FactorModel.h"
+#include "FrontierState.h"
+
+class UniverseCache;
+
+// Mean and covariance for a subset of assets over a date range.
+//
+// Built from one MarketSnapshot. Over the full date range the statistics
+// are gathered out of the snapshot's covariance in O(k^2); other ranges
+// are recomputed once over the matching returns rows. The full universe
+// over the full range aliases the snapshot and copies nothing.
+class Universe {
+public:
+    const std::vector<std::string>& symbols() const { return symbols_; }
+    const std::vector<double>& mean() const { return full_ ? data_->mean() : mean_; }
+    const Matrix& cov() const { return full_ ? data_->cov() : cov_; }
+
+    // Returns rows of the range, all snapshot columns; pair with
+    // expandWeights() to evaluate a subset portfolio on it.
+    MatrixView returns() const {
+        return data_->returns().rowRange(firstReturn_, returnRows_);
+    }
+
+    // Range rows gathered down to the universe's own columns. A copy; when
+    // returns().cols() == symbols().size() use returns() instead.
+    Matrix subsetReturns() const;
+
+    // Subset weights -> weights over every snapshot column (zeros elsewhere)
+    std::vector<double> expandWeights(const std::vector<double>& w) const;
+
+    // Cholesky factor of cov(); the snapshot's own for the full universe
+    std::shared_ptr<const CholeskyFactor> cholesky() const;
+
+    // Sigma^{-1} 1, Sigma^{-1} mu and the frontier scalars, built once
+    std::shared_ptr<const FrontierState> frontier() const;
+
+    // K-factor model over the universe's returns, built on first use and
+    // kept for the lifetime of the entry
+    std::shared_ptr<const FactorModel> factorModel(size_t factors) const;
+
+    uint64_t version() const { return data_->version(); }
+
+    // Including the lazily built factor, frontier and factor models
+    size_t bytes() const;
+
+private:
+    friend class UniverseCache;
+
+    // After a lazy member is built: charges the growth to the cache
+    // holding this universe, if any
+    void charge() const;
+
+    mutable std::atomic<UniverseCache*> owner_{nullptr};  // while resident
+    std::string key_;
+
+    SnapshotPtr data_;
+    bool full_ = false;
+
+    std::vector<std::string> symbols_;
+    std::vector<size_t> columns_;
+    size_t firstReturn_ = 0;
+    size_t returnRows_ = 0;
+
+    std::vector<double> mean_;
+    Matrix cov_;
+
+    mutable std::mutex factorMtx;
+    mutable std::map<size_t, std::shared_ptr<const FactorModel>> factors_;
+    mutable std::shared_ptr<const CholeskyFactor> cholesky_;
+    mutable std::shared_ptr<const FrontierState> frontier_;
+};
+
+using UniversePtr = std::shared_ptr<const Universe>;
+
+struct UniverseCacheStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+    size_t residentBytes = 0;
+    size_t entries = 0;
+    size_t budgetBytes = 0;
+};
+
+// LRU cache of Universes keyed by (data version, symbol set, date range)
+// under a byte budget. Entries from older data versions are dropped as
+// soon as a newer version is requested. A resident universe charges its
+// Cholesky factor, frontier state and factor models to the budget as
+// they are built.
+class UniverseCache {
+public:
+    static UniverseCache& instance();
+
+    explicit UniverseCache(size_t budgetBytes = size_t(256) << 20);
+
+    // symbols empty = every asset; start/end are inclusive ISO dates on
+    // the price rows, empty = open ended. Throws std::invalid_argument for
+    // unknown symbols or an empty range.
+    UniversePtr get(const SnapshotPtr& data,
+                    const std::vector<std::string>& symbols,
+                    const std::string& start = "",
+                    const std::string& end = "");
+
+    void setBudget(size_t bytes);
+    void clear();
+    UniverseCacheStats stats() const;
+
+    ~UniverseCache();
+
+private:
+    friend class Universe;
+
+    struct Entry {
+        std::string key;
+        UniversePtr universe;
+        size_t bytes;     // charged to residentBytes
+    };
+
+    std::shared_ptr<Universe> build(const SnapshotPtr& data,
+                                    const std::vector<std::string>& symbols,
+                                    const std::string& start,
+                                    const std::string& end) const;
+    void evictLocked();
+    void dropLocked(const Entry& e);
+    void recharge(const Universe& u);
+
+    mutable std::mutex mtx;
+    std::list<Entry> lru;  // most recent first
+    std::unordered_map<std::string, std::list<Entry>::iterator> index;
+    uint64_t currentVersion = 0;
+
+    size_t budget;
+    UniverseCacheStats counters;
+};
@@ -0,0 +1,197 @@
+#include "CSVLoader.h"
+#include "MappedFile.h"
+#include "../ThreadPool.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <limits>
+#include <mutex>
+
+namespace {
+
+constexpr size_t kMinChunkBytes = 1 << 20;
+constexpr size_t kMaxErrors = 1000;
+
+struct Line {
+    const char* begin;
+    const char* end;
+};
+
+// Advances p past the next line and returns it without the trailing "\r\n".
+Line nextLine(const char*& p, const char* end) {
+    const char* b = p;
+    const char* nl = static_cast<const char*>(std::memchr(p, '\n', end - p));
+    const char* e = nl ? nl : end;
+    p = nl ? nl + 1 : end;
+    if (e > b && e[-1] == '\r') --e;
+    return { b, e };
+}
+
+bool isBlank(const Line& l) {
+    for (const char* c = l.begin; c < l.end; ++c)
+        if (*c != ' ' && *c != '\t') return false;
+    return true;
+}
+
+void trim(const char*& b, const char*& e) {
+    while (b < e && (*b == ' ' || *b == '\t' || *b == '"')) ++b;
+    while (e > b && (e[-1] == ' ' || e[-1] == '\t' || e[-1] == '"')) --e;
+}
+
+std::vector<std::string> splitHeader(const Line& l) {
+    std::vector<std::string> fields;
+    const char* b = l.begin;
+    while (true) {
+        const char* c = std::find(b, l.end, ',');
+        const char* fb = b;
+        const char* fe = c;
+        trim(fb, fe);
+        fields.emplace_back(fb, fe);
+        if (c == l.end) break;
+        b = c + 1;
+    }
+    return fields;
+}
+
+size_t countRows(const char* b, const char* e) {
+    size_t n = 0;
+    while (b < e) {
+        if (!isBlank(nextLine(b, e))) n++;
+    }
+    return n;
+}
+
+}
+
+PriceTable CSVLoader::load(const std::string& filePath, size_t threads) {
+    MappedFile file(filePath);
+    if (!file.isOpen()) {
+        PriceTable table;
+        table.errors.push_back({ 0, 0, "cannot open " + filePath });
+        return table;
+    }
+    return parse(file.data(), file.size(), threads);
+}
+
+PriceTable CSVLoader::parse(const char* data, size_t size, size_t threads) {
+    PriceTable table;
+    const char* p = data;
+    const char* end = data + size;
+
+    // ---- Header ----
+    Line header{ p, p };
+    while (p < end) {
+        header = nextLine(p, end);
+        if (!isBlank(header)) break;
+    }
+    if (header.begin == header.end) return table;
+
+    size_t headerLine = static_cast<size_t>(std::count(data, header.begin, '\n')) + 1;
+
+    auto fields = splitHeader(header);
+    table.symbols.assign(fields.begin() + 1, fields.end());
+    table.cols = table.symbols.size();
+
+    // ---- Chunk the body on newline boundaries ----
+    ThreadPool& pool = ThreadPool::shared();
+    if (threads == 0) threads = pool.concurrency();
+
+    size_t body = static_cast<size_t>(end - p);
+    size_t chunks = std::max<size_t>(1, std::min(threads, body / kMinChunkBytes));
+
+    std::vector<const char*> bounds(chunks + 1);
+    bounds[0] = p;
+    bounds[chunks] = end;
+    for (size_t c = 1; c < chunks; c++) {
+        const char* guess = std::max(bounds[c - 1], p + body * c / chunks);
+        const char* nl = static_cast<const char*>(std::memchr(guess, '\n', end - guess));
+        bounds[c] = nl ? nl + 1 : end;
+    }
+
+    // ---- Pass 1: rows and newlines per chunk ----
+    std::vector<size_t> rowsIn(chunks), linesIn(chunks);
+    pool.parallelFor(chunks, [&](size_t c) {
+        rowsIn[c] = countRows(bounds[c], bounds[c + 1]);
+        linesIn[c] = static_cast<size_t>(std::count(bounds[c], bounds[c + 1], '\n'));
+    });
+
+    std::vector<size_t> rowStart(chunks + 1, 0), lineStart(chunks, headerLine + 1);
+    for (size_t c = 0; c < chunks; c++) {
+        rowStart[c + 1] = rowStart[c] + rowsIn[c];
+        if (c > 0) lineStart[c] = lineStart[c - 1] + linesIn[c - 1];
+    }
+
+    table.rows = rowStart[chunks];
+    table.values.assign(table.rows * table.cols,
+                        std::numeric_limits<double>::quiet_NaN());
+    table.dates.resize(table.rows);
+
+    // ---- Pass 2: parse into the shared buffer ----
+    std::mutex errMtx;
+    auto report = [&](size_t line, size_t col, std::string msg) {
+        std::lock_guard<std::mutex> lock(errMtx);
+        if (table.errors.size() < kMaxErrors)
+            table.errors.push_back({ line, col, std::move(msg) });
+    };
+
+    pool.parallelFor(chunks, [&](size_t c) {
+        const char* q = bounds[c];
+        const char* e = bounds[c + 1];
+        size_t r = rowStart[c];
+        size_t lineNo = lineStart[c];
+
+        while (q < e) {
+            Line l = nextLine(q, e);
+            size_t thisLine = lineNo++;
+            if (isBlank(l)) continue;
+
+            double* out = table.values.data() + r * table.cols;
+
+            const char* b = l.begin;
+            const char* comma = std::find(b, l.end, ',');
+            const char* db = b;
+            const char* de = comma;
+            trim(db, de);
+            table.dates[r].assign(db, de);
+
+            size_t col = 0;
+            b = comma;
+            while (b < l.end) {
+                ++b;
+                comma = std::find(b, l.end, ',');
+                if (col < table.cols) {
+                    const char* fb = b;
+                    const char* fe = comma;
+                    trim(fb, fe);
+
+                    double v;
+                    auto res = std::from_chars(fb, fe, v);
+                    if (fb == fe) {
+                        report(thisLine, col + 2, "empty cell");
+                    } else if (res.ec != std::errc() || res.ptr != fe) {
+                        report(thisLine, col + 2,
+                               "invalid number '" + std::string(fb, fe) + "'");
+                    } else {
+                        out[col] = v;
+                    }
+                }
+                col++;
+                b = comma;
+            }
+
+            if (col != table.cols)
+                report(thisLine, std::min(col, table.cols) + 2,
+                       "expected " + std::to_string(table.cols) +
+                       " values, found " + std::to_string(col));
+            r++;
+        }
+    });
+
+    std::sort(table.errors.begin(), table.errors.end(),
+              [](const CSVParseError& a, const CSVParseError& b) {
+                  return a.line != b.line ? a.line < b.line : a.column < b.column;
+              });
+
+    return table;
+}
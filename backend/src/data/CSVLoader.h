@@ -0,0 +1,38 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <vector>
+
+struct CSVParseError {
+    size_t line;    // 1-based line number in the file (header is line 1)
+    size_t column;  // 1-based column number (Date is column 1)
+    std::string message;
+};
+
+// Prices as parsed from a "Date,SYM1,SYM2,..." file.
+// values is row-major: rows x cols, one row per date.
+struct PriceTable {
+    std::vector<std::string> symbols;
+    std::vector<std::string> dates;
+    std::vector<double> values;
+    size_t rows = 0;
+    size_t cols = 0;
+
+    std::vector<CSVParseError> errors;
+
+    double at(size_t r, size_t c) const { return values[r * cols + c]; }
+    bool ok() const { return errors.empty(); }
+};
+
+// Memory-mapped, multi-threaded price CSV loader.
+//
+// The body of the file is split into chunks on newline boundaries; each
+// chunk is counted and then parsed with std::from_chars straight into one
+// preallocated buffer. Malformed cells are stored as NaN and reported in
+// PriceTable::errors rather than thrown.
+class CSVLoader {
+public:
+    static PriceTable load(const std::string& filePath, size_t threads = 0);
+
+    static PriceTable parse(const char* data, size_t size, size_t threads = 0);
+};
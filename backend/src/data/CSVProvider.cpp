@@ -1,8 +1,39 @@
 #include "CSVProvider.h"
-#include "../Statistics.h"
+#include "CSVLoader.h"
 
-std::vector<std::vector<double>>
-CSVProvider::getPrices(const std::vector<std::string>& /*symbols*/) {
-    // For now, symbols ignored (CSV has fixed assets)
-    return Statistics::readCSV("../backend/data/prices.csv");
+#include <algorithm>
+#include <stdexcept>
+
+CSVProvider::CSVProvider(std::string path) : path(std::move(path)) {}
+
+PriceFrame
+CSVProvider::load(const std::vector<std::string>& symbols) {
+    PriceTable table = CSVLoader::load(path);
+    if (!table.ok()) {
+        const auto& e = table.errors.front();
+        throw std::runtime_error(path + ":" + std::to_string(e.line) + ":" +
+                                 std::to_string(e.column) + ": " + e.message);
+    }
+
+    std::vector<size_t> columns;
+    if (symbols.empty()) {
+        for (size_t c = 0; c < table.cols; c++) columns.push_back(c);
+    } else {
+        for (const auto& s : symbols) {
+            auto it = std::find(table.symbols.begin(), table.symbols.end(), s);
+            if (it == table.symbols.end())
+                throw std::invalid_argument("unknown symbol " + s);
+            columns.push_back(static_cast<size_t>(it - table.symbols.begin()));
+        }
+    }
+
+    PriceFrame frame;
+    frame.prices = Matrix(table.rows, columns.size());
+    for (size_t r = 0; r < table.rows; r++)
+        for (size_t c = 0; c < columns.size(); c++)
+            frame.prices(r, c) = table.at(r, columns[c]);
+
+    for (size_t c : columns) frame.symbols.push_back(table.symbols[c]);
+    frame.dates = std::move(table.dates);
+    return frame;
 }
@@ -1,8 +1,15 @@
 #pragma once
 #include "DataProvider.h"
 
+// One "Date,SYM1,SYM2,..." file holding every symbol
 class CSVProvider : public DataProvider {
 public:
-    std::vector<std::vector<double>>
-    getPrices(const std::vector<std::string>& symbols) override;
+    explicit CSVProvider(std::string path = "../backend/data/prices.csv");
+
+    // Throws std::runtime_error on a malformed file.
+    PriceFrame
+    load(const std::vector<std::string>& symbols) override;
+
+private:
+    std::string path;
 };
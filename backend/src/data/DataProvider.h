@@ -2,10 +2,34 @@
 #include <vector>
 #include <string>
 
+#include "../Matrix.h"
+
+// What to do with a date on which some symbols have no bar
+enum class MissingBarPolicy {
+    ForwardFill,  // repeat the symbol's last price; leading gaps are dropped
+    Drop,         // keep only dates every symbol has
+    Mask          // keep every date, NaN where the bar is missing
+};
+
+// Date-aligned prices: one row per date, one column per symbol
+struct PriceFrame {
+    std::vector<std::string> symbols;
+    std::vector<std::string> dates;
+    Matrix prices;
+};
+
 class DataProvider {
 public:
-    virtual std::vector<std::vector<double>>
-    getPrices(const std::vector<std::string>& symbols) = 0;
+    // Aligned prices for the requested symbols, in request order; every
+    // symbol the provider knows when symbols is empty. Throws
+    // std::invalid_argument on an unknown symbol.
+    virtual PriceFrame
+    load(const std::vector<std::string>& symbols) = 0;
+
+    Matrix
+    getPrices(const std::vector<std::string>& symbols) {
+        return load(symbols).prices;
+    }
 
     virtual ~DataProvider() = default;
 };
@@ -0,0 +1,87 @@
+#include "MappedFile.h"
+
+#include <fstream>
+#include <utility>
+
+#if defined(_WIN32)
+#define PORTFOLIO_NO_MMAP
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile(const std::string& path) {
+#ifndef PORTFOLIO_NO_MMAP
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return;
+
+    struct stat st {};
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        return;
+    }
+
+    size_ = static_cast<size_t>(st.st_size);
+    open_ = true;
+
+    if (size_ > 0) {
+        void* p = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p != MAP_FAILED) {
+            ::madvise(p, size_, MADV_SEQUENTIAL);
+            data_ = static_cast<const char*>(p);
+            mapped_ = true;
+        } else {
+            open_ = false;
+            size_ = 0;
+        }
+    }
+    ::close(fd);
+#else
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) return;
+
+    size_ = static_cast<size_t>(file.tellg());
+    open_ = true;
+    if (size_ == 0) return;
+
+    owned_ = new char[size_];
+    file.seekg(0);
+    file.read(owned_, static_cast<std::streamsize>(size_));
+    data_ = owned_;
+#endif
+}
+
+MappedFile::~MappedFile() {
+    release();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept {
+    *this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        release();
+        data_ = std::exchange(other.data_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+        open_ = std::exchange(other.open_, false);
+        mapped_ = std::exchange(other.mapped_, false);
+        owned_ = std::exchange(other.owned_, nullptr);
+    }
+    return *this;
+}
+
+void MappedFile::release() {
+#ifndef PORTFOLIO_NO_MMAP
+    if (mapped_ && data_)
+        ::munmap(const_cast<char*>(data_), size_);
+#endif
+    delete[] owned_;
+    data_ = nullptr;
+    owned_ = nullptr;
+    size_ = 0;
+    open_ = false;
+    mapped_ = false;
+}
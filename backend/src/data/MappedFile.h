@@ -0,0 +1,30 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+// Read-only memory mapping of a whole file. Falls back to reading the
+// file into an owned buffer on platforms without mmap support.
+class MappedFile {
+public:
+    MappedFile() = default;
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    bool isOpen() const { return open_; }
+    const char* data() const { return data_; }
+    size_t size() const { return size_; }
+
+private:
+    void release();
+
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+    bool open_ = false;
+    bool mapped_ = false;
+    char* owned_ = nullptr;
+};
@@ -1,11 +1,28 @@
-// CSVProvider.cpp
-#include "DataProvider.h"
-#include "../Statistics.h"
-
-class CSVProvider : public DataProvider {
-public:
-    std::vector<std::vector<double>>
-    getPrices(const std::vector<std::string>& symbols) override {
-        return Statistics::readCSV("../backend/data/prices.csv");
-    }
-};
+#include "MarketDataService.h"
+#include "CSVProvider.h"
+#include "SymbolFileProvider.h"
+
+#include <filesystem>
+
+MarketDataService::MarketDataService()
+    : provider(std::make_unique<CSVProvider>()) {}
+
+MarketDataService::MarketDataService(std::unique_ptr<DataProvider> provider)
+    : provider(std::move(provider)) {}
+
+MarketDataService
+MarketDataService::forSource(const std::string& path, MissingBarPolicy policy) {
+    if (std::filesystem::is_directory(path))
+        return MarketDataService(std::make_unique<SymbolFileProvider>(path, policy));
+    return MarketDataService(std::make_unique<CSVProvider>(path));
+}
+
+Matrix
+MarketDataService::loadPrices(const std::vector<std::string>& symbols) {
+    return provider->getPrices(symbols);
+}
+
+PriceFrame
+MarketDataService::loadFrame(const std::vector<std::string>& symbols) {
+    return provider->load(symbols);
+}
@@ -1,6 +1,5 @@
 #pragma once
 #include "DataProvider.h"
-#include "CSVProvider.h"
 #include <memory>
 
 class MarketDataService {
@@ -8,13 +7,19 @@ private:
     std::unique_ptr<DataProvider> provider;
 
 public:
-    MarketDataService() {
-        // Default provider (can be swapped later)
-        provider = std::make_unique<CSVProvider>();
-    }
+    // Default provider: the bundled prices.csv
+    MarketDataService();
 
-    std::vector<std::vector<double>>
-    loadPrices(const std::vector<std::string>& symbols) {
-        return provider->getPrices(symbols);
-    }
+    explicit MarketDataService(std::unique_ptr<DataProvider> provider);
+
+    // A directory of per-symbol files or a single wide CSV
+    static MarketDataService
+    forSource(const std::string& path,
+              MissingBarPolicy policy = MissingBarPolicy::ForwardFill);
+
+    Matrix
+    loadPrices(const std::vector<std::string>& symbols);
+
+    PriceFrame
+    loadFrame(const std::vector<std::string>& symbols);
 };
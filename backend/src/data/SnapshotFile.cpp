@@ -0,0 +1,253 @@
+#include "SnapshotFile.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <type_traits>
+
+namespace {
+
+constexpr char kMagic[8] = { 'P', 'F', 'O', 'S', 'N', 'A', 'P', '\0' };
+constexpr uint64_t kAlign = 64;
+
+struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t headerBytes;
+
+    uint64_t rows;
+    uint64_t cols;
+    uint64_t returnRows;
+
+    uint64_t sourceSize;
+    int64_t sourceMtime;
+    uint64_t sourceHash;
+
+    uint64_t offset[6];
+    uint64_t bytes[6];
+
+    uint64_t payloadChecksum;
+    uint64_t headerChecksum;  // over every byte before this field
+};
+
+static_assert(std::is_trivially_copyable<Header>::value, "Header is written raw");
+
+uint64_t alignUp(uint64_t x) {
+    return (x + kAlign - 1) / kAlign * kAlign;
+}
+
+std::string joinLines(const std::vector<std::string>* v) {
+    std::string s;
+    if (!v) return s;
+    for (const auto& x : *v) {
+        s += x;
+        s += '\n';
+    }
+    return s;
+}
+
+}
+
+uint64_t SnapshotFile::hash64(const void* data, size_t bytes, uint64_t h) {
+    // FNV-1a over 64-bit words, then the tail bytes
+    constexpr uint64_t prime = 0x100000001b3ULL;
+    const auto* p = static_cast<const unsigned char*>(data);
+
+    size_t words = bytes / 8;
+    for (size_t i = 0; i < words; i++) {
+        uint64_t w;
+        std::memcpy(&w, p + i * 8, 8);
+        h = (h ^ w) * prime;
+    }
+    for (size_t i = words * 8; i < bytes; i++)
+        h = (h ^ p[i]) * prime;
+    return h;
+}
+
+SnapshotSource SnapshotSource::of(const std::string& path, bool withHash) {
+    namespace fs = std::filesystem;
+    SnapshotSource s;
+    std::error_code ec;
+
+    if (fs::is_directory(path, ec)) {
+        // Per-symbol directory: total size, newest mtime, hash chained
+        // over the files in name order (names included, so renames count)
+        std::vector<fs::path> files;
+        for (const auto& entry : fs::directory_iterator(path, ec))
+            if (entry.is_regular_file() && entry.path().extension() == ".csv")
+                files.push_back(entry.path());
+        std::sort(files.begin(), files.end());
+
+        s.hash = withHash ? 0xcbf29ce484222325ULL : 0;
+        for (const auto& f : files) {
+            SnapshotSource one = of(f.string(), withHash);
+            s.size += one.size;
+            s.mtime = std::max(s.mtime, one.mtime);
+            if (withHash) {
+                std::string name = f.filename().string();
+                s.hash = SnapshotFile::hash64(name.data(), name.size(), s.hash);
+                s.hash = SnapshotFile::hash64(&one.hash, sizeof one.hash, s.hash);
+            }
+        }
+        return s;
+    }
+
+    auto size = fs::file_size(path, ec);
+    if (ec) return s;
+    auto mtime = fs::last_write_time(path, ec);
+    if (ec) return s;
+
+    s.size = size;
+    s.mtime = static_cast<int64_t>(mtime.time_since_epoch().count());
+
+    if (withHash) {
+        MappedFile f(path);
+        s.hash = SnapshotFile::hash64(f.data(), f.size());
+    }
+    return s;
+}
+
+bool SnapshotFile::write(const std::string& path,
+                         const SnapshotContents& c,
+                         const SnapshotSource& source) {
+    std::string symbols = joinLines(c.symbols);
+    std::string dates = joinLines(c.dates);
+
+    const void* data[SectionCount] = {
+        symbols.data(), dates.data(), c.prices, c.returns, c.mean, c.cov
+    };
+
+    Header h{};
+    std::memcpy(h.magic, kMagic, sizeof kMagic);
+    h.version = kVersion;
+    h.headerBytes = sizeof(Header);
+    h.rows = c.rows;
+    h.cols = c.cols;
+    h.returnRows = c.returnRows;
+    h.sourceSize = source.size;
+    h.sourceMtime = source.mtime;
+    h.sourceHash = source.hash;
+
+    h.bytes[Symbols] = symbols.size();
+    h.bytes[Dates] = dates.size();
+    h.bytes[Prices] = c.prices ? c.rows * c.cols * sizeof(double) : 0;
+    h.bytes[Returns] = c.returns ? c.returnRows * c.cols * sizeof(double) : 0;
+    h.bytes[Mean] = c.mean ? c.cols * sizeof(double) : 0;
+    h.bytes[Cov] = c.cov ? c.cols * c.cols * sizeof(double) : 0;
+
+    uint64_t pos = alignUp(sizeof(Header));
+    for (int s = 0; s < SectionCount; s++) {
+        h.offset[s] = pos;
+        pos = alignUp(pos + h.bytes[s]);
+    }
+
+    h.payloadChecksum = 0xcbf29ce484222325ULL;
+    for (int s = 0; s < SectionCount; s++)
+        h.payloadChecksum = hash64(data[s], h.bytes[s], h.payloadChecksum);
+
+    h.headerChecksum = hash64(&h, offsetof(Header, headerChecksum));
+
+    std::string tmp = path + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) return false;
+
+        const char zeros[kAlign] = {};
+        out.write(reinterpret_cast<const char*>(&h), sizeof h);
+        uint64_t written = sizeof h;
+
+        for (int s = 0; s < SectionCount; s++) {
+            out.write(zeros, static_cast<std::streamsize>(h.offset[s] - written));
+            out.write(static_cast<const char*>(data[s]),
+                      static_cast<std::streamsize>(h.bytes[s]));
+            written = h.offset[s] + h.bytes[s];
+        }
+        out.write(zeros, static_cast<std::streamsize>(alignUp(written) - written));
+
+        if (!out) {
+            out.close();
+            std::remove(tmp.c_str());
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tmp, path, ec);
+    if (ec) {
+        std::remove(tmp.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool SnapshotFile::open(const std::string& path,
+                        const std::string& sourcePath,
+                        bool verifyPayload) {
+    file = MappedFile(path);
+    if (!file.isOpen() || file.size() < sizeof(Header)) return false;
+
+    Header h;
+    std::memcpy(&h, file.data(), sizeof h);
+
+    if (std::memcmp(h.magic, kMagic, sizeof kMagic) != 0) return false;
+    if (h.version != kVersion || h.headerBytes != sizeof(Header)) return false;
+    if (h.headerChecksum != hash64(&h, offsetof(Header, headerChecksum)))
+        return false;
+
+    // ---- Section bounds and shapes ----
+    const uint64_t expected[SectionCount] = {
+        h.bytes[Symbols],
+        h.bytes[Dates],
+        h.rows * h.cols * sizeof(double),
+        h.returnRows * h.cols * sizeof(double),
+        h.bytes[Mean] ? h.cols * sizeof(double) : 0,
+        h.bytes[Cov] ? h.cols * h.cols * sizeof(double) : 0
+    };
+    for (int s = 0; s < SectionCount; s++) {
+        if (h.bytes[s] != expected[s]) return false;
+        if (h.offset[s] % kAlign != 0) return false;
+        if (h.offset[s] + h.bytes[s] > file.size()) return false;
+    }
+
+    // ---- Source freshness ----
+    SnapshotSource now = SnapshotSource::of(sourcePath, false);
+    if (now.size != h.sourceSize) return false;
+    if (now.mtime != h.sourceMtime &&
+        SnapshotSource::of(sourcePath, true).hash != h.sourceHash)
+        return false;
+
+    if (verifyPayload) {
+        uint64_t sum = 0xcbf29ce484222325ULL;
+        for (int s = 0; s < SectionCount; s++)
+            sum = hash64(file.data() + h.offset[s], h.bytes[s], sum);
+        if (sum != h.payloadChecksum) return false;
+    }
+
+    rows_ = h.rows;
+    cols_ = h.cols;
+    returnRows_ = h.returnRows;
+    std::memcpy(offset_, h.offset, sizeof offset_);
+    std::memcpy(bytes_, h.bytes, sizeof bytes_);
+    return true;
+}
+
+const double* SnapshotFile::section(Section s) const {
+    if (bytes_[s] == 0) return nullptr;
+    return reinterpret_cast<const double*>(file.data() + offset_[s]);
+}
+
+std::vector<std::string> SnapshotFile::strings(Section s) const {
+    std::vector<std::string> out;
+    const char* p = file.data() + offset_[s];
+    const char* end = p + bytes_[s];
+    while (p < end) {
+        const char* nl = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        if (!nl) break;
+        out.emplace_back(p, nl);
+        p = nl + 1;
+    }
+    return out;
+}
@@ -0,0 +1,85 @@
+#pragma once
+#include "MappedFile.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Identity of the CSV a snapshot was built from.
+struct SnapshotSource {
+    uint64_t size = 0;
+    int64_t mtime = 0;
+    uint64_t hash = 0;
+
+    // hash is only computed when withHash is set (it reads the whole file).
+    // A directory of per-symbol CSVs is stamped as a whole.
+    static SnapshotSource of(const std::string& path, bool withHash);
+};
+
+// Borrowed arrays written into a snapshot. Matrices are row-major.
+struct SnapshotContents {
+    const std::vector<std::string>* symbols = nullptr;
+    const std::vector<std::string>* dates = nullptr;
+
+    size_t rows = 0;        // price rows
+    size_t cols = 0;        // assets
+    size_t returnRows = 0;  // usually rows - 1
+
+    const double* prices = nullptr;   // rows x cols
+    const double* returns = nullptr;  // returnRows x cols
+    const double* mean = nullptr;     // cols, or null
+    const double* cov = nullptr;      // cols x cols, or null
+};
+
+// Versioned, checksummed binary image of the DataCache arrays.
+//
+// Layout: a fixed header (dimensions, source size/mtime/hash, section
+// offsets, checksums) followed by 64-byte aligned sections for symbols,
+// dates, prices, returns, mean and covariance, in native byte order.
+// open() maps the file and only validates the header unless asked to
+// verify the payload, so a warm start costs about one page-in.
+class SnapshotFile {
+public:
+    static constexpr uint32_t kVersion = 1;
+
+    // Writes atomically (temp file + rename). Returns false on I/O error.
+    static bool write(const std::string& path,
+                      const SnapshotContents& contents,
+                      const SnapshotSource& source);
+
+    // Maps path and checks it against the CSV at sourcePath. A changed
+    // mtime alone does not invalidate the snapshot if the content hash
+    // still matches.
+    bool open(const std::string& path,
+              const std::string& sourcePath,
+              bool verifyPayload = false);
+
+    size_t rows() const { return rows_; }
+    size_t cols() const { return cols_; }
+    size_t returnRows() const { return returnRows_; }
+
+    const double* prices() const { return section(Prices); }
+    const double* returns() const { return section(Returns); }
+    const double* mean() const { return section(Mean); }
+    const double* cov() const { return section(Cov); }
+
+    std::vector<std::string> symbols() const { return strings(Symbols); }
+    std::vector<std::string> dates() const { return strings(Dates); }
+
+    static uint64_t hash64(const void* data, size_t bytes,
+                           uint64_t seed = 0xcbf29ce484222325ULL);
+
+private:
+    enum Section { Symbols, Dates, Prices, Returns, Mean, Cov, SectionCount };
+
+    const double* section(Section s) const;
+    std::vector<std::string> strings(Section s) const;
+
+    MappedFile file;
+    size_t rows_ = 0;
+    size_t cols_ = 0;
+    size_t returnRows_ = 0;
+    uint64_t offset_[SectionCount] = {};
+    uint64_t bytes_[SectionCount] = {};
+};
@@ -0,0 +1,179 @@
+#include "SymbolFileProvider.h"
+#include "CSVLoader.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <filesystem>
+#include <future>
+#include <limits>
+#include <numeric>
+#include <queue>
+#include <stdexcept>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+bool sameName(const std::string& a, const std::string& b) {
+    return a.size() == b.size() &&
+           std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) {
+               return std::tolower(static_cast<unsigned char>(x)) ==
+                      std::tolower(static_cast<unsigned char>(y));
+           });
+}
+
+}
+
+PriceFrame mergeOnDate(const std::vector<DatedSeries>& series,
+                       MissingBarPolicy policy) {
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    size_t K = series.size();
+
+    PriceFrame frame;
+    for (const auto& s : series) frame.symbols.push_back(s.symbol);
+    frame.prices = Matrix(0, K);
+
+    // Min-heap of (next date, series) cursors
+    using Cursor = std::pair<const std::string*, size_t>;
+    auto later = [](const Cursor& a, const Cursor& b) {
+        int c = a.first->compare(*b.first);
+        return c != 0 ? c > 0 : a.second > b.second;
+    };
+    std::priority_queue<Cursor, std::vector<Cursor>, decltype(later)> heap(later);
+
+    std::vector<size_t> pos(K, 0);
+    for (size_t k = 0; k < K; k++)
+        if (!series[k].dates.empty()) heap.push({ &series[k].dates[0], k });
+
+    std::vector<double> row(K), last(K, nan);
+
+    while (!heap.empty()) {
+        std::string date = *heap.top().first;
+        std::fill(row.begin(), row.end(), nan);
+        size_t present = 0;
+
+        while (!heap.empty() && *heap.top().first == date) {
+            size_t k = heap.top().second;
+            heap.pop();
+
+            const auto& s = series[k];
+            // Duplicate dates within a series: the last bar wins
+            while (pos[k] + 1 < s.dates.size() && s.dates[pos[k] + 1] == date)
+                pos[k]++;
+            row[k] = s.values[pos[k]];
+            present++;
+
+            if (++pos[k] < s.dates.size()) heap.push({ &s.dates[pos[k]], k });
+        }
+
+        if (policy == MissingBarPolicy::Drop && present < K) continue;
+
+        if (policy == MissingBarPolicy::ForwardFill) {
+            bool complete = true;
+            for (size_t k = 0; k < K; k++) {
+                if (std::isnan(row[k])) row[k] = last[k];
+                else last[k] = row[k];
+                complete = complete && !std::isnan(row[k]);
+            }
+            if (!complete) continue;
+        }
+
+        frame.prices.appendRow(row.data());
+        frame.dates.push_back(std::move(date));
+    }
+
+    return frame;
+}
+
+SymbolFileProvider::SymbolFileProvider(std::string directory,
+                                       MissingBarPolicy policy,
+                                       size_t ioThreads,
+                                       std::string priceColumn)
+    : directory(std::move(directory)),
+      policy(policy),
+      priceColumn(std::move(priceColumn)),
+      pool(ioThreads) {}
+
+std::vector<std::string> SymbolFileProvider::availableSymbols() const {
+    std::vector<std::string> out;
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(directory, ec)) {
+        if (entry.is_regular_file() && entry.path().extension() == ".csv")
+            out.push_back(entry.path().stem().string());
+    }
+    std::sort(out.begin(), out.end());
+    return out;
+}
+
+DatedSeries SymbolFileProvider::loadSeries(const std::string& path,
+                                           const std::string& symbol,
+                                           const std::string& priceColumn) {
+    PriceTable table = CSVLoader::load(path, 1);
+    if (!table.ok()) {
+        const auto& e = table.errors.front();
+        throw std::runtime_error(path + ":" + std::to_string(e.line) + ":" +
+                                 std::to_string(e.column) + ": " + e.message);
+    }
+
+    size_t column = table.cols;
+    for (size_t c = 0; c < table.cols; c++)
+        if (sameName(table.symbols[c], priceColumn)) column = c;
+    if (column == table.cols) {
+        if (table.cols != 1)
+            throw std::runtime_error(path + ": no \"" + priceColumn + "\" column");
+        column = 0;
+    }
+
+    std::vector<size_t> order(table.rows);
+    std::iota(order.begin(), order.end(), 0);
+    if (!std::is_sorted(table.dates.begin(), table.dates.end()))
+        std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+            return table.dates[a] < table.dates[b];
+        });
+
+    DatedSeries s;
+    s.symbol = symbol;
+    s.dates.reserve(table.rows);
+    s.values.reserve(table.rows);
+    for (size_t r : order) {
+        s.dates.push_back(std::move(table.dates[r]));
+        s.values.push_back(table.at(r, column));
+    }
+    return s;
+}
+
+PriceFrame
+SymbolFileProvider::load(const std::vector<std::string>& symbols) {
+    std::vector<std::string> wanted = symbols.empty() ? availableSymbols() : symbols;
+
+    std::vector<std::string> paths;
+    for (const auto& s : wanted) {
+        fs::path p = fs::path(directory) / (s + ".csv");
+        if (!fs::is_regular_file(p))
+            throw std::invalid_argument("unknown symbol " + s);
+        paths.push_back(p.string());
+    }
+
+    std::vector<std::future<DatedSeries>> pending;
+    for (size_t k = 0; k < wanted.size(); k++) {
+        pending.push_back(pool.submit([&, k] {
+            return loadSeries(paths[k], wanted[k], priceColumn);
+        }));
+    }
+
+    // Collect every future before rethrowing so no task outlives the
+    // locals it captured.
+    std::vector<DatedSeries> series(wanted.size());
+    std::exception_ptr failure;
+    for (size_t k = 0; k < pending.size(); k++) {
+        try {
+            series[k] = pending[k].get();
+        } catch (...) {
+            if (!failure) failure = std::current_exception();
+        }
+    }
+    if (failure) std::rethrow_exception(failure);
+
+    return mergeOnDate(series, policy);
+}
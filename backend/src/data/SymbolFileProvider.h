@@ -0,0 +1,50 @@
+#pragma once
+#include <string>
+#include <vector>
+
+#include "DataProvider.h"
+#include "../ThreadPool.h"
+
+// One symbol's bars, dates ascending
+struct DatedSeries {
+    std::string symbol;
+    std::vector<std::string> dates;
+    std::vector<double> values;
+};
+
+// k-way merge-join of the series on date. Each output row is one date of
+// the union, resolved according to policy.
+PriceFrame mergeOnDate(const std::vector<DatedSeries>& series,
+                       MissingBarPolicy policy);
+
+// Reads one "<SYMBOL>.csv" per symbol from a directory.
+//
+// Files are read and parsed concurrently on the provider's own bounded
+// pool (I/O bound work does not belong on the shared compute pool) and
+// then merged on date. A file's price column is the one named
+// priceColumn, or its only value column.
+class SymbolFileProvider : public DataProvider {
+public:
+    explicit SymbolFileProvider(std::string directory,
+                                MissingBarPolicy policy = MissingBarPolicy::ForwardFill,
+                                size_t ioThreads = 4,
+                                std::string priceColumn = "Close");
+
+    // Throws std::invalid_argument when a symbol has no file and
+    // std::runtime_error on a malformed one.
+    PriceFrame
+    load(const std::vector<std::string>& symbols) override;
+
+    // Symbols with a file in the directory, sorted
+    std::vector<std::string> availableSymbols() const;
+
+    static DatedSeries loadSeries(const std::string& path,
+                                  const std::string& symbol,
+                                  const std::string& priceColumn);
+
+private:
+    std::string directory;
+    MissingBarPolicy policy;
+    std::string priceColumn;
+    ThreadPool pool;
+};
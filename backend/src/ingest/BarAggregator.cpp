@@ -0,0 +1,101 @@
+#include "BarAggregator.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+namespace {
+
+int64_t floorDiv(int64_t a, int64_t b) {
+    int64_t q = a / b;
+    return (a % b != 0 && (a < 0) != (b < 0)) ? q - 1 : q;
+}
+
+}
+
+BarAggregator::BarAggregator(std::vector<double> closes,
+                             std::string lastLabel,
+                             int64_t barMs,
+                             Sink sink)
+    : closes(std::move(closes)),
+      lastLabel_(std::move(lastLabel)),
+      barMs(barMs > 0 ? barMs : 86400000),
+      sink(std::move(sink)) {}
+
+void BarAggregator::add(const Tick& t) {
+    int64_t b = floorDiv(t.timestampMs, barMs);
+
+    if (!open) {
+        open = true;
+        bucket = b;
+    } else if (b > bucket) {
+        emit();
+        bucket = b;
+    } else if (b < bucket) {
+        late_++;
+    }
+
+    if (t.symbol < closes.size()) closes[t.symbol] = t.price;
+    openTicks_++;
+}
+
+void BarAggregator::flush() {
+    if (open && openTicks_ > 0) emit();
+    open = false;
+}
+
+void BarAggregator::emit() {
+    std::string l = label(bucket * barMs, barMs);
+    openTicks_ = 0;
+
+    if (!lastLabel_.empty() && l <= lastLabel_) {
+        stale_++;
+        return;
+    }
+    sink(closes, l);
+    lastLabel_ = std::move(l);
+    bars_++;
+}
+
+std::string BarAggregator::label(int64_t startMs, int64_t barMs) {
+    // Civil date from days since 1970-01-01 (Howard Hinnant's algorithm)
+    int64_t secs = floorDiv(startMs, 1000);
+    int64_t days = floorDiv(secs, 86400);
+    int64_t sod = secs - days * 86400;
+
+    int64_t z = days + 719468;
+    int64_t era = floorDiv(z, 146097);
+    int64_t doe = z - era * 146097;
+    int64_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    int64_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    int64_t mp = (5 * doy + 2) / 153;
+    int64_t d = doy - (153 * mp + 2) / 5 + 1;
+    int64_t m = mp < 10 ? mp + 3 : mp - 9;
+    int64_t y = yoe + era * 400 + (m <= 2);
+
+    char buf[64];
+    if (barMs % 86400000 == 0)
+        std::snprintf(buf, sizeof buf, "%04lld-%02lld-%02lld",
+                      (long long)y, (long long)m, (long long)d);
+    else
+        std::snprintf(buf, sizeof buf, "%04lld-%02lld-%02lldT%02lld:%02lld:%02lld",
+                      (long long)y, (long long)m, (long long)d,
+                      (long long)(sod / 3600), (long long)(sod / 60 % 60),
+                      (long long)(sod % 60));
+    return buf;
+}
+
+int64_t BarAggregator::labelStartMs(const std::string& label) {
+    int y = 0, m = 0, d = 0;
+    if (std::sscanf(label.c_str(), "%d-%d-%d", &y, &m, &d) != 3 ||
+        m < 1 || m > 12 || d < 1 || d > 31)
+        return -1;
+
+    // Days since 1970-01-01 from a civil date (inverse of label())
+    int64_t yy = y - (m <= 2);
+    int64_t era = floorDiv(yy, 400);
+    int64_t yoe = yy - era * 400;
+    int64_t doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+    int64_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    int64_t days = era * 146097 + doe - 719468;
+    return days * 86400000;
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "Tick.h"
+
+// Rolls ticks into fixed-width time bars.
+//
+// Each bar's close is the last price seen per symbol, carried forward
+// from the previous bar for symbols that did not trade. A bar is emitted
+// when the first tick of a later bar arrives; ticks older than the open
+// bar are folded into it and counted as late; flush() emits the open bar
+// when the feed ends. Bars not after lastLabel (already in the history)
+// are dropped as stale.
+class BarAggregator {
+public:
+    using Sink = std::function<void(const std::vector<double>& closes,
+                                    const std::string& label)>;
+
+    BarAggregator(std::vector<double> closes,
+                  std::string lastLabel,
+                  int64_t barMs,
+                  Sink sink);
+
+    void add(const Tick& t);
+
+    // Emits the open bar, if any ticks are in it
+    void flush();
+
+    uint64_t bars() const { return bars_; }
+    uint64_t late() const { return late_; }
+    uint64_t staleBars() const { return stale_; }
+    uint64_t openBarTicks() const { return openTicks_; }
+    const std::string& lastLabel() const { return lastLabel_; }
+
+    // "YYYY-MM-DD" for whole-day bars, "YYYY-MM-DDTHH:MM:SS" otherwise
+    static std::string label(int64_t startMs, int64_t barMs);
+
+    // Start of a "YYYY-MM-DD..." label in epoch ms, -1 if unparsable
+    static int64_t labelStartMs(const std::string& label);
+
+private:
+    void emit();
+
+    std::vector<double> closes;
+    std::string lastLabel_;
+    int64_t barMs;
+    Sink sink;
+
+    bool open = false;
+    int64_t bucket = 0;
+
+    uint64_t bars_ = 0;
+    uint64_t late_ = 0;
+    uint64_t stale_ = 0;
+    uint64_t openTicks_ = 0;
+};
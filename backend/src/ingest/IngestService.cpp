@@ -0,0 +1,364 @@
+#include "IngestService.h"
+#include "BarAggregator.h"
+#include "../DataCache.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// Counters with a single writer: a plain load/store avoids the locked
+// read-modify-write while readers still see a consistent value.
+inline void bump(std::atomic<uint64_t>& a, uint64_t n = 1) {
+    a.store(a.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+inline uint64_t get(const std::atomic<uint64_t>& a) {
+    return a.load(std::memory_order_relaxed);
+}
+
+constexpr size_t kBatch = 4096;
+
+}
+
+struct IngestService::Feed {
+    Feed(std::string source, IngestOptions options)
+        : source(std::move(source)), options(options), ring(options.queueCapacity) {}
+
+    std::string source;
+    IngestOptions options;
+    SpscRing<Tick> ring;
+
+    SymbolIndex symbols;
+    std::vector<double> closes;  // last snapshot prices
+    std::string lastDate;
+
+    std::atomic<bool> stopping{false};
+    std::atomic<bool> producerDone{false};
+    int64_t startedNs = 0;
+    std::atomic<int64_t> finishedNs{0};
+
+    // Written by the producer
+    std::atomic<uint64_t> received{0}, rejected{0}, stalls{0};
+
+    // Written by the consumer
+    std::atomic<uint64_t> consumed{0}, late{0}, bars{0}, staleBars{0}, openBarTicks{0};
+    std::atomic<uint64_t> latencySumNs{0}, latencyMaxNs{0};
+    std::array<std::atomic<uint64_t>, 64> latencyLog2{};  // bucket b: < 2^b ns
+
+    std::mutex textMtx;
+    std::string lastBar;
+    std::string lastError;
+
+    void fail(const std::string& e) {
+        std::lock_guard<std::mutex> lock(textMtx);
+        lastError = e;
+    }
+
+    // Pushes every tick, waiting on a full ring unless stopping
+    void pushAll(const std::vector<Tick>& ticks) {
+        size_t done = 0;
+        while (done < ticks.size()) {
+            done += ring.pushBatch(ticks.data() + done, ticks.size() - done);
+            if (done < ticks.size()) {
+                if (stopping.load(std::memory_order_relaxed)) return;
+                bump(stalls);
+                std::this_thread::yield();
+            }
+        }
+        bump(received, ticks.size());
+    }
+};
+
+IngestService& IngestService::instance() {
+    static IngestService service;
+    return service;
+}
+
+IngestService::~IngestService() {
+    stop();
+}
+
+std::shared_ptr<IngestService::Feed>
+IngestService::begin(const std::string& source, const IngestOptions& options) {
+    if (running_.load())
+        throw std::runtime_error("ingestion already running from " + feed->source);
+
+    // A feed that finished on its own still has threads to reap
+    if (producer.joinable()) producer.join();
+    if (consumer.joinable()) consumer.join();
+
+    SnapshotPtr snap = DataCache::instance().snapshot();
+    if (!snap || snap->prices().rows() == 0)
+        throw std::runtime_error("no market data loaded to append to");
+
+    auto f = std::make_shared<Feed>(source, options);
+    for (size_t i = 0; i < snap->symbols().size(); i++)
+        f->symbols[snap->symbols()[i]] = static_cast<uint32_t>(i);
+
+    MatrixView prices = snap->prices();
+    const size_t last = prices.rows() - 1;
+    for (size_t j = 0; j < prices.cols(); j++) f->closes.push_back(prices(last, j));
+    if (!snap->dates().empty()) f->lastDate = snap->dates().back();
+
+    f->startedNs = steadyNowNs();
+    return f;
+}
+
+void IngestService::startFile(const std::string& path, bool fromStart,
+                              IngestOptions options) {
+#ifdef _WIN32
+    (void)path; (void)fromStart; (void)options;
+    throw std::runtime_error("file ingestion needs a POSIX platform");
+#else
+    std::lock_guard<std::mutex> lock(controlMtx);
+    auto f = begin(path, options);
+
+    // Non-blocking so opening a FIFO does not wait for a writer
+    int fd = ::open(path.c_str(), O_RDONLY | O_NONBLOCK);
+    if (fd < 0)
+        throw std::runtime_error("cannot open " + path + ": " + std::strerror(errno));
+    if (!fromStart) ::lseek(fd, 0, SEEK_END);
+
+    {
+        std::lock_guard<std::mutex> fl(feedMtx);
+        feed = f;
+        lastConsumed = 0;
+        lastStatsNs = f->startedNs;
+    }
+    running_ = true;
+    producer = std::thread([this, f, fd] { produceFile(*f, fd); });
+    consumer = std::thread([this, f] { consume(*f); });
+#endif
+}
+
+void IngestService::startReplay(const ReplayOptions& replay, IngestOptions options) {
+    std::lock_guard<std::mutex> lock(controlMtx);
+    auto f = begin("replay", options);
+
+    {
+        std::lock_guard<std::mutex> fl(feedMtx);
+        feed = f;
+        lastConsumed = 0;
+        lastStatsNs = f->startedNs;
+    }
+    running_ = true;
+    producer = std::thread([this, f, replay] { produceReplay(*f, replay); });
+    consumer = std::thread([this, f] { consume(*f); });
+}
+
+void IngestService::stop() {
+    std::lock_guard<std::mutex> lock(controlMtx);
+    std::shared_ptr<Feed> f;
+    {
+        std::lock_guard<std::mutex> fl(feedMtx);
+        f = feed;
+    }
+    if (f) f->stopping = true;
+    if (producer.joinable()) producer.join();
+    if (consumer.joinable()) consumer.join();
+    running_ = false;
+}
+
+void IngestService::produceFile(Feed& f, int fd) {
+#ifndef _WIN32
+    std::vector<char> buf(size_t(1) << 16);
+    size_t have = 0;
+    std::vector<Tick> ticks;
+    ticks.reserve(kBatch);
+    uint64_t rejected = 0;
+
+    while (!f.stopping.load(std::memory_order_relaxed)) {
+        ssize_t n = ::read(fd, buf.data() + have, buf.size() - have);
+        if (n < 0 && errno != EAGAIN && errno != EINTR) {
+            f.fail(std::string("read failed: ") + std::strerror(errno));
+            break;
+        }
+        if (n <= 0) {
+            // EOF on a tailed file or a FIFO without writers: poll again
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            continue;
+        }
+        have += static_cast<size_t>(n);
+
+        size_t used = parseTicks(buf.data(), have, f.symbols, steadyNowNs(),
+                                 ticks, rejected);
+        if (used == 0 && have == buf.size()) {
+            rejected++;  // a single line longer than the buffer
+            used = have;
+        }
+        std::memmove(buf.data(), buf.data() + used, have - used);
+        have -= used;
+
+        bump(f.rejected, rejected);
+        rejected = 0;
+        f.pushAll(ticks);
+        ticks.clear();
+    }
+
+    ::close(fd);
+#else
+    (void)fd;
+#endif
+    f.producerDone = true;
+}
+
+void IngestService::produceReplay(Feed& f, ReplayOptions r) {
+    std::mt19937_64 gen(r.seed);
+    std::normal_distribution<double> normal(0.0, 1.0);
+
+    std::vector<double> px = f.closes;
+    uint32_t N = static_cast<uint32_t>(px.size());
+    int64_t barMs = f.options.barMs;
+    uint64_t perBar = std::max<uint64_t>(1, r.ticksPerBar);
+
+    // First synthetic bar follows the last one in the history
+    int64_t startMs = BarAggregator::labelStartMs(f.lastDate);
+    startMs = startMs < 0
+        ? std::chrono::duration_cast<std::chrono::milliseconds>(
+              std::chrono::system_clock::now().time_since_epoch()).count()
+        : startMs + barMs;
+
+    std::vector<Tick> ticks;
+    ticks.reserve(kBatch);
+    auto t0 = std::chrono::steady_clock::now();
+
+    for (uint64_t i = 0; i < r.ticks && !f.stopping.load(std::memory_order_relaxed);) {
+        int64_t now = steadyNowNs();
+        uint64_t end = std::min<uint64_t>(r.ticks, i + kBatch);
+        for (; i < end; i++) {
+            uint32_t s = static_cast<uint32_t>(i % N);
+            px[s] *= 1.0 + 0.0005 * normal(gen);
+            int64_t ts = startMs + static_cast<int64_t>(i / perBar) * barMs +
+                         static_cast<int64_t>(i % perBar) * barMs / static_cast<int64_t>(perBar);
+            ticks.push_back({ ts, now, s, px[s] });
+        }
+        f.pushAll(ticks);
+        ticks.clear();
+
+        if (r.ticksPerSecond > 0)
+            std::this_thread::sleep_until(
+                t0 + std::chrono::duration<double>(i / r.ticksPerSecond));
+    }
+
+    f.producerDone = true;
+}
+
+void IngestService::consume(Feed& f) {
+    BarAggregator bars(f.closes, f.lastDate, f.options.barMs,
+        [&f](const std::vector<double>& closes, const std::string& label) {
+            try {
+                DataCache::instance().appendPrices(closes, label);
+            } catch (const std::exception& e) {
+                f.fail(e.what());
+                return;
+            }
+            std::lock_guard<std::mutex> lock(f.textMtx);
+            f.lastBar = label;
+        });
+
+    std::vector<Tick> batch(kBatch);
+    int idle = 0;
+
+    for (;;) {
+        size_t n = f.ring.popBatch(batch.data(), batch.size());
+        if (n == 0) {
+            if (f.producerDone.load() && f.ring.size() == 0) break;
+            if (++idle < 64) std::this_thread::yield();
+            else std::this_thread::sleep_for(std::chrono::microseconds(50));
+            continue;
+        }
+        idle = 0;
+
+        int64_t now = steadyNowNs();
+        uint64_t sum = 0, worst = get(f.latencyMaxNs);
+        for (size_t i = 0; i < n; i++) {
+            uint64_t ns = static_cast<uint64_t>(std::max<int64_t>(0, now - batch[i].receivedNs));
+            sum += ns;
+            worst = std::max(worst, ns);
+            int b = 0;
+            while (b < 63 && (uint64_t(1) << b) <= ns) b++;
+            bump(f.latencyLog2[b]);
+            bars.add(batch[i]);
+        }
+
+        bump(f.latencySumNs, sum);
+        f.latencyMaxNs.store(worst, std::memory_order_relaxed);
+        bump(f.consumed, n);
+        f.late.store(bars.late(), std::memory_order_relaxed);
+        f.bars.store(bars.bars(), std::memory_order_relaxed);
+        f.staleBars.store(bars.staleBars(), std::memory_order_relaxed);
+        f.openBarTicks.store(bars.openBarTicks(), std::memory_order_relaxed);
+    }
+
+    // The producer is done, so the open bar is complete
+    bars.flush();
+    f.bars.store(bars.bars(), std::memory_order_relaxed);
+    f.staleBars.store(bars.staleBars(), std::memory_order_relaxed);
+    f.openBarTicks.store(bars.openBarTicks(), std::memory_order_relaxed);
+
+    f.finishedNs = steadyNowNs();
+    running_ = false;
+}
+
+IngestStats IngestService::stats() {
+    std::lock_guard<std::mutex> lock(feedMtx);
+    IngestStats s;
+    s.running = running_.load();
+    if (!feed) return s;
+
+    Feed& f = *feed;
+    s.source = f.source;
+    s.received = get(f.received);
+    s.consumed = get(f.consumed);
+    s.rejected = get(f.rejected);
+    s.stalls = get(f.stalls);
+    s.late = get(f.late);
+    s.bars = get(f.bars);
+    s.staleBars = get(f.staleBars);
+    s.openBarTicks = get(f.openBarTicks);
+    s.queueDepth = f.ring.size();
+    s.queueCapacity = f.ring.capacity();
+
+    int64_t now = steadyNowNs();
+    if (f.finishedNs.load()) now = std::min(now, f.finishedNs.load());
+    double sinceStart = (now - f.startedNs) * 1e-9;
+    double sinceLast = (now - lastStatsNs) * 1e-9;
+    if (sinceStart > 0) s.ticksPerSecond = s.consumed / sinceStart;
+    if (sinceLast > 0) s.recentTicksPerSecond = (s.consumed - lastConsumed) / sinceLast;
+    lastConsumed = s.consumed;
+    lastStatsNs = now;
+
+    // Percentiles are the upper edge of a power-of-two bucket
+    uint64_t counted = 0;
+    std::array<uint64_t, 64> hist;
+    for (size_t b = 0; b < hist.size(); b++) counted += hist[b] = get(f.latencyLog2[b]);
+    auto percentileUs = [&](double p) {
+        uint64_t target = static_cast<uint64_t>(std::ceil(p * counted)), seen = 0;
+        for (size_t b = 0; b < hist.size(); b++) {
+            seen += hist[b];
+            if (seen >= target && seen > 0) return std::ldexp(1.0, static_cast<int>(b)) / 1000.0;
+        }
+        return 0.0;
+    };
+    if (counted > 0) {
+        s.latencyMeanUs = get(f.latencySumNs) / 1000.0 / counted;
+        s.latencyP50Us = percentileUs(0.50);
+        s.latencyP99Us = percentileUs(0.99);
+    }
+    s.latencyMaxUs = get(f.latencyMaxNs) / 1000.0;
+
+    std::lock_guard<std::mutex> text(f.textMtx);
+    s.lastBar = f.lastBar;
+    s.lastError = f.lastError;
+    return s;
+}
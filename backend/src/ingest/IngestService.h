@@ -0,0 +1,105 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "RingBuffer.h"
+#include "Tick.h"
+
+struct IngestOptions {
+    int64_t barMs = 86400000;              // bar width, one day by default
+    size_t queueCapacity = size_t(1) << 16;
+};
+
+// Synthetic feed standing in for a live source
+struct ReplayOptions {
+    uint64_t ticks = 1000000;
+    uint64_t ticksPerBar = 100000;
+    double ticksPerSecond = 0.0;  // 0 = as fast as possible
+    uint64_t seed = 1;
+};
+
+struct IngestStats {
+    bool running = false;
+    std::string source;
+
+    uint64_t received = 0;    // ticks parsed and queued
+    uint64_t consumed = 0;    // ticks taken off the queue
+    uint64_t rejected = 0;    // malformed lines, unknown symbols
+    uint64_t stalls = 0;      // producer waits on a full queue
+    uint64_t late = 0;
+    uint64_t bars = 0;
+    uint64_t staleBars = 0;
+    uint64_t openBarTicks = 0;
+
+    size_t queueDepth = 0;
+    size_t queueCapacity = 0;
+
+    double ticksPerSecond = 0.0;        // since start
+    double recentTicksPerSecond = 0.0;  // since the previous stats() call
+
+    // Parse -> dequeue latency
+    double latencyMeanUs = 0.0;
+    double latencyP50Us = 0.0;
+    double latencyP99Us = 0.0;
+    double latencyMaxUs = 0.0;
+
+    std::string lastBar;
+    std::string lastError;
+};
+
+// Live price ingestion.
+//
+// A producer thread reads ticks from a tailed file or named pipe (or the
+// replayer) and pushes them through an SPSC ring to a consumer thread,
+// which rolls them into bars and appends each bar to DataCache. Only
+// these two threads touch the feed; HTTP handlers read stats() and the
+// RCU snapshots, so they never wait on ingestion.
+class IngestService {
+public:
+    static IngestService& instance();
+
+    // Ticks as "<epoch ms>,<SYMBOL>,<price>" lines. Regular files are
+    // tailed after EOF; a FIFO is read as writers come and go. Throws
+    // std::runtime_error when already running or the path can't be opened.
+    void startFile(const std::string& path, bool fromStart = true,
+                   IngestOptions options = {});
+
+    void startReplay(const ReplayOptions& replay, IngestOptions options = {});
+
+    // Stops the producer, drains the queue into a final bar and joins
+    // both threads
+    void stop();
+
+    bool running() const { return running_.load(); }
+
+    IngestStats stats();
+
+    ~IngestService();
+
+private:
+    IngestService() = default;
+
+    struct Feed;
+
+    std::shared_ptr<Feed> begin(const std::string& source, const IngestOptions& options);
+    void produceFile(Feed& feed, int fd);
+    void produceReplay(Feed& feed, ReplayOptions replay);
+    void consume(Feed& feed);
+
+    std::mutex controlMtx;  // start/stop
+    std::atomic<bool> running_{false};
+
+    std::mutex feedMtx;     // guards feed pointer for stats()
+    std::shared_ptr<Feed> feed;
+
+    std::thread producer;
+    std::thread consumer;
+
+    uint64_t lastConsumed = 0;
+    int64_t lastStatsNs = 0;
+};
@@ -0,0 +1,75 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+// Bounded lock-free single-producer / single-consumer queue.
+//
+// Head and tail live on their own cache lines, and each side keeps a
+// cached copy of the other's index so the shared line is only touched
+// when the cached view says the ring is full (producer) or empty
+// (consumer). Batch push/pop move many elements per index update.
+template <class T>
+class SpscRing {
+public:
+    // capacity is rounded up to a power of two
+    explicit SpscRing(size_t capacity) {
+        size_t c = 2;
+        while (c < capacity) c <<= 1;
+        slots.resize(c);
+        mask = c - 1;
+    }
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    size_t capacity() const { return slots.size(); }
+
+    // Approximate when called off the producer/consumer threads
+    size_t size() const {
+        return tail.load(std::memory_order_acquire) -
+               head.load(std::memory_order_acquire);
+    }
+
+    // ---- producer ----
+
+    bool push(const T& v) { return pushBatch(&v, 1) == 1; }
+
+    // Pushes up to n elements, returns how many fit
+    size_t pushBatch(const T* v, size_t n) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        size_t room = capacity() - (t - cachedHead);
+        if (room < n) {
+            cachedHead = head.load(std::memory_order_acquire);
+            room = capacity() - (t - cachedHead);
+        }
+        n = std::min(n, room);
+        for (size_t i = 0; i < n; i++) slots[(t + i) & mask] = v[i];
+        tail.store(t + n, std::memory_order_release);
+        return n;
+    }
+
+    // ---- consumer ----
+
+    size_t popBatch(T* out, size_t max) {
+        size_t h = head.load(std::memory_order_relaxed);
+        size_t avail = cachedTail - h;
+        if (avail < max) {
+            cachedTail = tail.load(std::memory_order_acquire);
+            avail = cachedTail - h;
+        }
+        size_t n = std::min(max, avail);
+        for (size_t i = 0; i < n; i++) out[i] = slots[(h + i) & mask];
+        head.store(h + n, std::memory_order_release);
+        return n;
+    }
+
+private:
+    alignas(64) std::atomic<size_t> head{0};  // written by the consumer
+    size_t cachedTail = 0;                    // consumer's view of tail
+    alignas(64) std::atomic<size_t> tail{0};  // written by the producer
+    size_t cachedHead = 0;                    // producer's view of head
+    alignas(64) std::vector<T> slots;
+    size_t mask = 0;
+};
@@ -0,0 +1,62 @@
+#include "Tick.h"
+
+#include <charconv>
+#include <chrono>
+#include <cstring>
+
+int64_t steadyNowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+size_t parseTicks(const char* data, size_t size,
+                  const SymbolIndex& symbols,
+                  int64_t receivedNs,
+                  std::vector<Tick>& out,
+                  uint64_t& rejected) {
+    const char* p = data;
+    const char* end = data + size;
+    std::string name;
+
+    while (p < end) {
+        const char* eol = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        if (!eol) break;
+        const char* line = p;
+        p = eol + 1;
+
+        const char* lineEnd = eol;
+        if (lineEnd > line && lineEnd[-1] == '\r') lineEnd--;
+        if (lineEnd == line) continue;
+
+        const char* c1 = static_cast<const char*>(std::memchr(line, ',', lineEnd - line));
+        const char* c2 = c1 ? static_cast<const char*>(
+                                  std::memchr(c1 + 1, ',', lineEnd - c1 - 1))
+                            : nullptr;
+        if (!c2) {
+            rejected++;
+            continue;
+        }
+
+        Tick t;
+        auto ts = std::from_chars(line, c1, t.timestampMs);
+        auto px = std::from_chars(c2 + 1, lineEnd, t.price);
+        if (ts.ec != std::errc() || ts.ptr != c1 ||
+            px.ec != std::errc() || px.ptr != lineEnd || !(t.price > 0)) {
+            rejected++;
+            continue;
+        }
+
+        name.assign(c1 + 1, c2);
+        auto it = symbols.find(name);
+        if (it == symbols.end()) {
+            rejected++;
+            continue;
+        }
+
+        t.symbol = it->second;
+        t.receivedNs = receivedNs;
+        out.push_back(t);
+    }
+
+    return static_cast<size_t>(p - data);
+}
@@ -0,0 +1,28 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// One trade or quote update for a snapshot column
+struct Tick {
+    int64_t timestampMs;  // source time, Unix epoch milliseconds
+    int64_t receivedNs;   // steady clock when it was parsed, for latency
+    uint32_t symbol;      // column in the market snapshot
+    double price;
+};
+
+using SymbolIndex = std::unordered_map<std::string, uint32_t>;
+
+int64_t steadyNowNs();
+
+// Parses "<epoch ms>,<SYMBOL>,<price>" lines into out. Stops at the last
+// complete line and returns the bytes consumed; the caller keeps the
+// rest for the next read. Malformed lines and unknown symbols are
+// skipped and counted in rejected.
+size_t parseTicks(const char* data, size_t size,
+                  const SymbolIndex& symbols,
+                  int64_t receivedNs,
+                  std::vector<Tick>& out,
+                  uint64_t& rejected);
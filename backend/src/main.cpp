@@ -1,6 +1,38 @@
 #include "Server.h"
+#include "DataCache.h"
+
+#include <cstring>
+#include <iostream>
+#include <string>
+
+// usage: PortfolioOptimizer [--missing-bars=ffill|drop] [prices.csv | per-symbol directory]
+//
+// --missing-bars decides how a per-symbol directory is merged on dates
+// where some symbols have no bar (default ffill).
+int main(int argc, char** argv) {
+    std::string source = DataCache::instance().source();
+    MissingBarPolicy missingBars = MissingBarPolicy::ForwardFill;
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        if (std::strncmp(arg, "--missing-bars=", 15) == 0) {
+            std::string policy = arg + 15;
+            if (policy == "ffill") missingBars = MissingBarPolicy::ForwardFill;
+            else if (policy == "drop") missingBars = MissingBarPolicy::Drop;
+            else {
+                std::cerr << "--missing-bars must be ffill or drop\n";
+                return 2;
+            }
+        } else if (arg[0] == '-') {
+            std::cerr << "unknown option " << arg << "\n";
+            return 2;
+        } else {
+            source = arg;
+        }
+    }
+
+    DataCache::instance().setSource(source, missingBars);
 
-int main() {
     Server server;
     server.start(8080);
     return 0;
@@ -26,8 +26,8 @@ export default function MonteCarloChart({ numSimulations = 1000 }) {
                     const processed = processPercentiles(result);
                     setChartData(processed);
 
-                    // 2. Store raw paths for the "spaghetti" background
-                    // Check if result.paths exists, otherwise fallback to empty
+                    // 2. Store the sampled paths for the "spaghetti" background
+                    // (only present because we ask for sample_paths)
                     setRawPaths(result.paths || []);
 
                     setLoading(false);
@@ -46,25 +46,19 @@ export default function MonteCarloChart({ numSimulations = 1000 }) {
         return () => { mounted = false; };
     }, [numSimulations]);
 
-    // Helper: Calculate p05, p50, p95 for the main trend lines
+    // Helper: p05, p50, p95 trend lines from the server's percentile bands
     const processPercentiles = (rawData) => {
-        if (!rawData || !rawData.paths || rawData.paths.length === 0) return [];
-
-        const timeSteps = rawData.time_steps || Array.from({ length: rawData.paths[0].length }, (_, i) => `M${i}`);
-        const paths = rawData.paths;
-
-        return timeSteps.map((label, tIndex) => {
-            // Get all values for this specific time step
-            const valuesAtT = paths.map(path => path[tIndex]);
-            valuesAtT.sort((a, b) => a - b);
-
-            return {
-                name: label,
-                p05: valuesAtT[Math.floor(valuesAtT.length * 0.05)], // Worst 5%
-                p50: valuesAtT[Math.floor(valuesAtT.length * 0.50)], // Median
-                p95: valuesAtT[Math.floor(valuesAtT.length * 0.95)], // Best 5%
-            };
-        });
+        const bands = rawData?.percentiles;
+        if (!bands || !bands.p50 || bands.p50.length === 0) return [];
+
+        const timeSteps = rawData.time_steps || bands.p50.map((_, i) => `M${i}`);
+
+        return timeSteps.map((label, tIndex) => ({
+            name: label,
+            p05: bands.p5[tIndex],   // Worst 5%
+            p50: bands.p50[tIndex],  // Median
+            p95: bands.p95[tIndex],  // Best 5%
+        }));
     };
 
     if (loading) {
@@ -46,8 +46,11 @@ export const portfolioApi = {
         });
     },
 
-    runMonteCarlo: async (simulations = 1000) => {
-        return postData('/montecarlo', { simulations });
+    runMonteCarlo: async (simulations = 1000, samplePaths = 100) => {
+        return postData('/montecarlo', {
+            num_simulations: simulations,
+            sample_paths: samplePaths
+        });
     },
 
     getBacktest: async (weights, range = '1Y') => {